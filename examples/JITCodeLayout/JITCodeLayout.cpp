@@ -0,0 +1,187 @@
+//===-- examples/JITCodeLayout/JITCodeLayout.cpp - JIT code layout bench --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// JIT Code Layout
+//
+// This program JIT compiles a large number of small functions and then calls
+// them in a scattered order, so that its running time is dominated by
+// instruction fetch and instruction TLB misses rather than by the work the
+// functions do.  It reports the wall time of the calls and, on Linux systems
+// with perf counters, the number of instruction TLB misses they caused.
+//
+// Compare the layout of the default JIT memory manager with huge-page backed
+// code slabs by running it with and without -jit-huge-pages.  With -hot=N only
+// N of the functions, scattered through the code, are called; adding -relayout
+// profiles one round of calls and then moves the functions that were called
+// next to each other with ExecutionEngine::relayoutHotFunctions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/LLVMContext.h"
+#include "llvm/Module.h"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/ExecutionEngine/JIT.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/IRBuilder.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/System/TimeValue.h"
+#include "llvm/Target/TargetSelect.h"
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+using namespace llvm;
+
+static cl::opt<unsigned>
+NumFunctions("functions", cl::desc("Number of functions to compile"),
+             cl::init(4000));
+
+static cl::opt<unsigned>
+NumIterations("iterations", cl::desc("Number of calls to each function"),
+              cl::init(200));
+
+static cl::opt<unsigned>
+NumHot("hot", cl::desc("Number of functions to call (default: all)"),
+       cl::init(0));
+
+static cl::opt<bool>
+Relayout("relayout", cl::desc("Move the called functions together after "
+                              "profiling the first round of calls"),
+         cl::init(false));
+
+/// createFunction - Create "i32 fN(i32)", a straight line of arithmetic that
+/// compiles to a few hundred bytes of code.
+static Function *createFunction(Module *M, unsigned N) {
+  LLVMContext &Context = M->getContext();
+  const IntegerType *Int32Ty = Type::getInt32Ty(Context);
+  std::string Name = "f" + utostr(N);
+  Function *F =
+    cast<Function>(M->getOrInsertFunction(Name, Int32Ty, Int32Ty, (Type *)0));
+
+  IRBuilder<> Builder(BasicBlock::Create(Context, "entry", F));
+  Value *X = F->arg_begin();
+  for (unsigned i = 0; i != 24; ++i) {
+    X = Builder.CreateMul(X, ConstantInt::get(Int32Ty, 2*(N+i)+1));
+    X = Builder.CreateAdd(X, ConstantInt::get(Int32Ty, N*31+i));
+    X = Builder.CreateXor(X, Builder.CreateLShr(X, 3+i%7));
+  }
+  Builder.CreateRet(X);
+  return F;
+}
+
+#if defined(__linux__) && defined(__NR_perf_event_open)
+/// openITLBCounter - Open a disabled counter of this thread's instruction TLB
+/// misses.  Returns -1 if perf counters are not available.
+static int openITLBCounter() {
+  struct perf_event_attr Attr;
+  memset(&Attr, 0, sizeof(Attr));
+  Attr.type = PERF_TYPE_HW_CACHE;
+  Attr.size = sizeof(Attr);
+  Attr.config = PERF_COUNT_HW_CACHE_ITLB |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  Attr.disabled = 1;
+  Attr.exclude_kernel = 1;
+  Attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &Attr, 0, -1, -1, 0);
+}
+
+static void startCounter(int FD) {
+  ioctl(FD, PERF_EVENT_IOC_RESET, 0);
+  ioctl(FD, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+static bool stopCounter(int FD, uint64_t &Count) {
+  ioctl(FD, PERF_EVENT_IOC_DISABLE, 0);
+  return read(FD, &Count, sizeof(Count)) == (ssize_t)sizeof(Count);
+}
+#else
+static int openITLBCounter() { return -1; }
+static void startCounter(int FD) {}
+static bool stopCounter(int FD, uint64_t &Count) { return false; }
+#endif
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "JIT code layout benchmark\n");
+  InitializeNativeTarget();
+
+  LLVMContext Context;
+  Module *M = new Module("layout", Context);
+  std::vector<Function*> Functions;
+  for (unsigned i = 0; i != NumFunctions; ++i)
+    Functions.push_back(createFunction(M, i));
+
+  std::string ErrorStr;
+  ExecutionEngine *EE = EngineBuilder(M).setEngineKind(EngineKind::JIT)
+                                        .setErrorStr(&ErrorStr).create();
+  if (!EE) {
+    errs() << argv[0] << ": cannot create the JIT: " << ErrorStr << "\n";
+    return 1;
+  }
+
+  if (Relayout)
+    EE->EnableCallProfiling();
+
+  typedef unsigned (*FnTy)(unsigned);
+  std::vector<FnTy> Pointers;
+  for (unsigned i = 0; i != NumFunctions; ++i)
+    Pointers.push_back((FnTy)(intptr_t)EE->getPointerToFunction(Functions[i]));
+
+  // Visit the functions with a large prime stride so that consecutive calls
+  // land on different pages.
+  unsigned NumCalled = NumHot && NumHot < NumFunctions ? NumHot : NumFunctions;
+  unsigned Result = 0;
+  if (Relayout) {
+    for (unsigned i = 0; i != NumCalled; ++i)
+      Result = Pointers[(uint64_t(i) * 7919) % NumFunctions](Result);
+    unsigned NumMoved = EE->relayoutHotFunctions(NumCalled);
+    outs() << "moved:        " << NumMoved << "\n";
+    for (unsigned i = 0; i != NumFunctions; ++i)
+      Pointers[i] = (FnTy)(intptr_t)EE->getPointerToFunction(Functions[i]);
+  }
+
+  int Counter = openITLBCounter();
+  if (Counter != -1)
+    startCounter(Counter);
+  sys::TimeValue Start = sys::TimeValue::now();
+
+  for (unsigned Iter = 0; Iter != NumIterations; ++Iter)
+    for (unsigned i = 0; i != NumCalled; ++i)
+      Result = Pointers[(uint64_t(i) * 7919) % NumFunctions](Result);
+
+  sys::TimeValue Elapsed = sys::TimeValue::now() - Start;
+  uint64_t Misses = 0;
+  bool HaveMisses = Counter != -1 && stopCounter(Counter, Misses);
+
+  outs() << "functions:    " << NumFunctions << "\n"
+         << "calls:        " << uint64_t(NumCalled) * NumIterations << "\n"
+         << "seconds:      "
+         << format("%.4f", Elapsed.seconds() + Elapsed.nanoseconds() / 1e9)
+         << "\n"
+         << "iTLB misses:  ";
+  if (HaveMisses)
+    outs() << Misses << "\n";
+  else
+    outs() << "unavailable\n";
+  outs() << "result:       " << Result << "\n";
+
+  delete EE;
+  llvm_shutdown();
+  return 0;
+}
@@ -0,0 +1,179 @@
+//===-- examples/JITStubContention/JITStubContention.cpp - Stub latency ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// JIT Stub Contention
+//
+// This program measures how long the first call through a lazy compilation
+// stub takes when the function behind the stub has already been compiled.
+// Each "callerN" calls "calleeN" through a lazy stub; both are compiled up
+// front, so the first call only has to look the stub up and jump to the
+// existing code.  With -busy, a second thread compiles large functions at the
+// same time, holding the JIT lock for most of the run, and the main thread's
+// stub calls show how long they wait for it.  It requires the pthreads
+// library.
+//
+//===----------------------------------------------------------------------===//
+
+#include <pthread.h>
+#include "llvm/LLVMContext.h"
+#include "llvm/Module.h"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/ExecutionEngine/JIT.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/IRBuilder.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/System/Threading.h"
+#include "llvm/System/TimeValue.h"
+#include "llvm/Target/TargetSelect.h"
+#include <algorithm>
+#include <unistd.h>
+#include <vector>
+using namespace llvm;
+
+static cl::opt<unsigned>
+NumStubs("stubs", cl::desc("Number of stubs to call"), cl::init(400));
+
+static cl::opt<unsigned>
+NumBig("big", cl::desc("Number of large functions the busy thread compiles"),
+       cl::init(40));
+
+static cl::opt<unsigned>
+Spacing("spacing", cl::desc("Microseconds between stub calls"),
+        cl::init(5000));
+
+static cl::opt<bool>
+Busy("busy", cl::desc("Compile large functions on another thread while "
+                      "calling through the stubs"),
+     cl::init(false));
+
+static double seconds(const sys::TimeValue &T) {
+  return T.seconds() + T.nanoseconds() / 1e9;
+}
+
+struct compileParams {
+  ExecutionEngine *EE;
+  std::vector<Function*> Functions;
+};
+
+static void *compileFunctions(void *param) {
+  compileParams *p = static_cast<compileParams*>(param);
+  for (unsigned i = 0, e = p->Functions.size(); i != e; ++i)
+    p->EE->getPointerToFunction(p->Functions[i]);
+  return 0;
+}
+
+/// createFunction - Create "i32 Name(i32)" returning its argument run through
+/// Size rounds of arithmetic.
+static Function *createFunction(Module *M, const std::string &Name,
+                                unsigned Size) {
+  LLVMContext &Context = M->getContext();
+  const IntegerType *Int32Ty = Type::getInt32Ty(Context);
+  Function *F =
+    cast<Function>(M->getOrInsertFunction(Name, Int32Ty, Int32Ty, (Type *)0));
+
+  IRBuilder<> Builder(BasicBlock::Create(Context, "entry", F));
+  Value *X = F->arg_begin();
+  for (unsigned i = 0; i != Size; ++i) {
+    X = Builder.CreateAdd(X, ConstantInt::get(Int32Ty, i));
+    X = Builder.CreateMul(X, X);
+  }
+  Builder.CreateRet(X);
+  return F;
+}
+
+/// createCaller - Create "i32 Name(i32)" that returns Callee's result.
+static Function *createCaller(Module *M, const std::string &Name,
+                              Function *Callee) {
+  LLVMContext &Context = M->getContext();
+  const IntegerType *Int32Ty = Type::getInt32Ty(Context);
+  Function *F =
+    cast<Function>(M->getOrInsertFunction(Name, Int32Ty, Int32Ty, (Type *)0));
+
+  IRBuilder<> Builder(BasicBlock::Create(Context, "entry", F));
+  Builder.CreateRet(Builder.CreateCall(Callee, F->arg_begin()));
+  return F;
+}
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "JIT stub contention benchmark\n");
+  InitializeNativeTarget();
+  if (!llvm_start_multithreaded()) {
+    errs() << "LLVM was not built with thread support\n";
+    return 1;
+  }
+
+  LLVMContext Context;
+  Module *M = new Module("stubs", Context);
+  std::vector<Function*> Callers, Callees;
+  for (unsigned i = 0; i != NumStubs; ++i) {
+    Callees.push_back(createFunction(M, "callee" + utostr(i), 1));
+    Callers.push_back(createCaller(M, "caller" + utostr(i), Callees.back()));
+  }
+  compileParams Params;
+  for (unsigned i = 0; i != NumBig; ++i)
+    Params.Functions.push_back(createFunction(M, "big" + utostr(i), 2000));
+
+  std::string ErrorStr;
+  ExecutionEngine *EE = EngineBuilder(M).setEngineKind(EngineKind::JIT)
+                                        .setErrorStr(&ErrorStr).create();
+  if (!EE) {
+    errs() << argv[0] << ": cannot create the JIT: " << ErrorStr << "\n";
+    return 1;
+  }
+  Params.EE = EE;
+  EE->DisableLazyCompilation(false);
+
+  // Compile each caller before its callee, so that the call goes through a
+  // lazy stub that has not been resolved yet.
+  typedef unsigned (*FnTy)(unsigned);
+  std::vector<FnTy> Pointers;
+  for (unsigned i = 0; i != NumStubs; ++i) {
+    Pointers.push_back((FnTy)(intptr_t)EE->getPointerToFunction(Callers[i]));
+    EE->getPointerToFunction(Callees[i]);
+  }
+
+  pthread_t Thread;
+  if (Busy && pthread_create(&Thread, NULL, compileFunctions, &Params) != 0) {
+    errs() << "Could not create thread\n";
+    return 1;
+  }
+
+  std::vector<double> Latencies;
+  unsigned Result = 0;
+  for (unsigned i = 0; i != NumStubs; ++i) {
+    sys::TimeValue Start = sys::TimeValue::now();
+    Result += Pointers[i](i);
+    Latencies.push_back(seconds(sys::TimeValue::now() - Start) * 1e6);
+    usleep(Spacing);
+  }
+
+  if (Busy && pthread_join(Thread, NULL) != 0) {
+    errs() << "Could not join thread\n";
+    return 1;
+  }
+
+  std::sort(Latencies.begin(), Latencies.end());
+  double Sum = 0;
+  for (unsigned i = 0; i != NumStubs; ++i)
+    Sum += Latencies[i];
+  outs() << "stubs:        " << NumStubs << "\n"
+         << "mean us:      " << format("%.1f", Sum / NumStubs) << "\n"
+         << "median us:    " << format("%.1f", Latencies[NumStubs / 2]) << "\n"
+         << "max us:       " << format("%.1f", Latencies.back()) << "\n"
+         << "result:       " << Result << "\n";
+
+  delete EE;
+  llvm_stop_multithreaded();
+  llvm_shutdown();
+  return 0;
+}
@@ -0,0 +1,121 @@
+//===-- examples/ParallelConstants/ParallelConstants.cpp - Uniquing bench -===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Parallel Constants
+//
+// This program measures how fast several threads can create ConstantInt,
+// ConstantFP and MDString values in one shared LLVMContext.  Every thread
+// walks the same range of values, so most requests hit an entry that another
+// thread already created; the program checks afterwards that all threads got
+// back the same uniqued objects.  It requires the pthreads library.
+//
+// Usage: ParallelConstants [values-per-thread [max-threads]]
+//
+//===----------------------------------------------------------------------===//
+
+#include <pthread.h>
+#include "llvm/LLVMContext.h"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Metadata.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/System/Threading.h"
+#include "llvm/System/TimeValue.h"
+#include <cstdlib>
+#include <vector>
+using namespace llvm;
+
+struct threadParams {
+  LLVMContext *Context;
+  unsigned NumValues;
+  unsigned Offset;
+  std::vector<const Value*> Created;
+};
+
+static void *createConstants(void *param) {
+  threadParams *p = static_cast<threadParams*>(param);
+  LLVMContext &Context = *p->Context;
+  const IntegerType *Int64Ty = Type::getInt64Ty(Context);
+  const IntegerType *Int33Ty = IntegerType::get(Context, 33);
+  SmallString<32> Name;
+
+  p->Created.resize(p->NumValues * 4);
+  for (unsigned n = 0; n != p->NumValues; ++n) {
+    // Start each thread at a different point so that the threads insert into
+    // different shards at the same time instead of following each other.
+    unsigned i = (n + p->Offset) % p->NumValues;
+    p->Created[i*4+0] = ConstantInt::get(Int64Ty, i);
+    p->Created[i*4+1] = ConstantInt::get(Int33Ty, i);
+    p->Created[i*4+2] = ConstantFP::get(Context, APFloat((double)i));
+
+    Name.clear();
+    raw_svector_ostream(Name) << "md" << i;
+    p->Created[i*4+3] = MDString::get(Context, Name.str());
+  }
+  return 0;
+}
+
+/// runThreads - Create NumValues of each kind of constant from NumThreads
+/// threads at once.  Returns the wall time in seconds, or a negative value if
+/// the threads did not all agree on the uniqued values.
+static double runThreads(unsigned NumThreads, unsigned NumValues) {
+  LLVMContext Context;
+  std::vector<threadParams> Params(NumThreads);
+  std::vector<pthread_t> Threads(NumThreads);
+
+  sys::TimeValue Start = sys::TimeValue::now();
+  for (unsigned i = 0; i != NumThreads; ++i) {
+    Params[i].Context = &Context;
+    Params[i].NumValues = NumValues;
+    Params[i].Offset = (NumValues / NumThreads) * i;
+    if (pthread_create(&Threads[i], NULL, createConstants, &Params[i]) != 0) {
+      errs() << "Could not create thread\n";
+      exit(1);
+    }
+  }
+  for (unsigned i = 0; i != NumThreads; ++i) {
+    if (pthread_join(Threads[i], NULL) != 0) {
+      errs() << "Could not join thread\n";
+      exit(1);
+    }
+  }
+  sys::TimeValue Elapsed = sys::TimeValue::now() - Start;
+
+  for (unsigned i = 1; i != NumThreads; ++i)
+    if (Params[i].Created != Params[0].Created)
+      return -1.0;
+  return Elapsed.seconds() + Elapsed.nanoseconds() / 1e9;
+}
+
+int main(int argc, char **argv) {
+  unsigned NumValues = argc > 1 ? atoi(argv[1]) : 200000;
+  unsigned MaxThreads = argc > 2 ? atoi(argv[2]) : 8;
+
+  if (!llvm_start_multithreaded()) {
+    errs() << "LLVM was not built with thread support\n";
+    return 1;
+  }
+
+  outs() << "threads      seconds   constants/sec\n";
+  for (unsigned NumThreads = 1; NumThreads <= MaxThreads; NumThreads *= 2) {
+    double Seconds = runThreads(NumThreads, NumValues);
+    if (Seconds < 0) {
+      errs() << "Threads disagreed on uniqued constants with " << NumThreads
+             << " threads!\n";
+      return 1;
+    }
+    double Rate = Seconds > 0 ? NumThreads * NumValues * 4 / Seconds : 0;
+    outs() << format("%7u  %11.4f  %14.0f\n", NumThreads, Seconds, Rate);
+  }
+
+  llvm_stop_multithreaded();
+  return 0;
+}
@@ -127,6 +127,10 @@ void PrintStatistics();
 /// \brief Print statistics to the given output stream.
 void PrintStatistics(raw_ostream &OS);
 
+/// \brief Print statistics to the given output stream as a JSON object on one
+/// line: {"statistics": [{"name": ..., "desc": ..., "value": ...}, ...]}.
+void PrintStatisticsJSON(raw_ostream &OS);
+
 } // End llvm namespace
 
 #endif
@@ -0,0 +1,240 @@
+//===--- BlockFrequencyImpl.h - Block Frequency Implementation --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Shared implementation of BlockFrequency for IR and Machine Instructions.
+//
+// The entry block gets the frequency START_FREQ.  Every other block gets the
+// sum, over its incoming forward edges, of the predecessor's frequency times
+// the edge probability.  Back edges are not followed; instead the frequency
+// of a loop header is multiplied by the expected trip count of its loop,
+// 1 / (1 - P), where P is the probability of returning to the header once it
+// has been entered.  P is found by the same propagation restricted to the
+// loop body, processing inner loops first so that their trip counts are
+// already known.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ANALYSIS_BLOCKFREQUENCYIMPL_H
+#define LLVM_ANALYSIS_BLOCKFREQUENCYIMPL_H
+
+#include "llvm/BasicBlock.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/GraphTraits.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/Support/BlockFrequency.h"
+#include "llvm/Support/BranchProbability.h"
+#include "llvm/Support/CFG.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class BlockFrequencyInfo;
+class MachineBlockFrequencyInfo;
+
+/// BlockFrequencyImpl implements block frequency algorithm for IR and
+/// Machine Instructions. Algorithm starts with value 1024 (START_FREQ)
+/// for the entry block and then propagates frequencies using branch weights
+/// from (Machine)BranchProbabilityInfo. LoopInfo is used to find the loops
+/// and their back edges, so irreducible control flow gets no loop scaling.
+template<class BlockT, class LoopT, class FunctionT, class BlockProbInfoT>
+class BlockFrequencyImpl {
+
+  DenseMap<const BlockT *, BlockFrequency> Freqs;
+
+  // Expected trip count of each loop, as the fraction LOOP_MASS / Divisor.
+  DenseMap<const LoopT *, uint32_t> LoopDivisors;
+
+  BlockProbInfoT *BPI;
+
+  LoopInfoBase<BlockT, LoopT> *LI;
+
+  FunctionT *Fn;
+
+  // Blocks of Fn in reverse post order.
+  std::vector<BlockT *> RPO;
+
+  typedef GraphTraits< Inverse<BlockT *> > GT;
+
+  static const uint64_t START_FREQ = 1024;
+
+  // Mass given to a loop header while its trip count is computed.
+  static const uint32_t LOOP_MASS = 1 << 20;
+
+  // Largest trip count a single loop may be scaled by.
+  static const uint32_t MAX_TRIP_COUNT = 4096;
+
+  std::string getBlockName(BasicBlock *BB) const {
+    return BB->getNameStr();
+  }
+
+  std::string getBlockName(MachineBasicBlock *MBB) const {
+    std::string str;
+    raw_string_ostream ss(str);
+    ss << "BB#" << MBB->getNumber();
+
+    if (const BasicBlock *BB = MBB->getBasicBlock())
+      ss << " derived from LLVM BB " << BB->getNameStr();
+
+    return ss.str();
+  }
+
+  /// isBackedge - Return true if Src->Dst is the back edge of a loop headed
+  /// by Dst.
+  bool isBackedge(BlockT *Src, BlockT *Dst) const {
+    LoopT *L = LI->getLoopFor(Dst);
+    return L && L->getHeader() == Dst && L->contains(Src);
+  }
+
+  /// scaleByTripCount - Multiply Freq by the trip count of the loop headed by
+  /// BB, if there is one.
+  void scaleByTripCount(BlockT *BB, BlockFrequency &Freq) const {
+    LoopT *L = LI->getLoopFor(BB);
+    if (!L || L->getHeader() != BB)
+      return;
+    typename DenseMap<const LoopT *, uint32_t>::const_iterator I =
+      LoopDivisors.find(L);
+    if (I != LoopDivisors.end())
+      Freq.scale(LOOP_MASS, I->second);
+  }
+
+  /// propagate - Compute the frequency of every block of RPO that belongs to
+  /// L (every block if L is null), giving Head the frequency HeadFreq.
+  /// Return the total frequency flowing back into Head.
+  uint64_t propagate(LoopT *L, BlockT *Head, BlockFrequency HeadFreq) {
+    BlockFrequency BackMass;
+    for (typename std::vector<BlockT *>::iterator I = RPO.begin(),
+         E = RPO.end(); I != E; ++I) {
+      BlockT *BB = *I;
+      if (L && !L->contains(BB))
+        continue;
+
+      BlockFrequency Freq;
+      if (BB == Head) {
+        Freq = HeadFreq;
+      } else {
+        // A predecessor may be listed once per edge; the probability already
+        // covers all of them.
+        SmallPtrSet<BlockT *, 8> Visited;
+        for (typename GT::ChildIteratorType PI = GT::child_begin(BB),
+             PE = GT::child_end(BB); PI != PE; ++PI) {
+          BlockT *Pred = *PI;
+          if (L && !L->contains(Pred))
+            continue;
+          if (isBackedge(Pred, BB) || !Visited.insert(Pred))
+            continue;
+          Freq += getBlockFreq(Pred) * BPI->getEdgeProbability(Pred, BB);
+        }
+        scaleByTripCount(BB, Freq);
+      }
+      Freqs[BB] = Freq;
+    }
+
+    // Collect the mass returning to Head once every block has a frequency.
+    if (L) {
+      SmallPtrSet<BlockT *, 8> Visited;
+      for (typename GT::ChildIteratorType PI = GT::child_begin(Head),
+           PE = GT::child_end(Head); PI != PE; ++PI) {
+        BlockT *Pred = *PI;
+        if (L->contains(Pred) && Visited.insert(Pred))
+          BackMass += getBlockFreq(Pred) * BPI->getEdgeProbability(Pred, Head);
+      }
+    }
+
+    return BackMass.getFrequency();
+  }
+
+  /// computeTripCount - Compute the trip counts of L and its subloops.
+  void computeTripCount(LoopT *L) {
+    for (typename LoopT::iterator I = L->begin(), E = L->end(); I != E; ++I)
+      computeTripCount(*I);
+
+    uint64_t BackMass = propagate(L, L->getHeader(), LOOP_MASS);
+
+    // Trip count = LOOP_MASS / (LOOP_MASS - BackMass), clamped so that loops
+    // that (almost) never exit do not swamp everything else.
+    uint64_t MinDivisor = LOOP_MASS / MAX_TRIP_COUNT;
+    uint64_t Divisor = BackMass < LOOP_MASS ? LOOP_MASS - BackMass : 0;
+    if (Divisor < MinDivisor)
+      Divisor = MinDivisor;
+    LoopDivisors[L] = (uint32_t)Divisor;
+  }
+
+  void doFunction(FunctionT *fn, BlockProbInfoT *bpi,
+                  LoopInfoBase<BlockT, LoopT> *li) {
+    Fn = fn;
+    BPI = bpi;
+    LI = li;
+
+    // Clear everything.
+    Freqs.clear();
+    LoopDivisors.clear();
+    RPO.clear();
+
+    BlockT *EntryBlock = fn->begin();
+    for (po_iterator<BlockT *> I = po_begin(EntryBlock),
+         E = po_end(EntryBlock); I != E; ++I)
+      RPO.push_back(*I);
+    std::reverse(RPO.begin(), RPO.end());
+
+    for (typename LoopInfoBase<BlockT, LoopT>::iterator I = LI->begin(),
+         E = LI->end(); I != E; ++I)
+      computeTripCount(*I);
+
+    propagate(0, EntryBlock, START_FREQ);
+  }
+
+  friend class BlockFrequencyInfo;
+  friend class MachineBlockFrequencyInfo;
+
+public:
+  /// getBlockFreq - Return block frequency. Return 0 if we don't have it.
+  BlockFrequency getBlockFreq(BlockT *BB) const {
+    typename DenseMap<const BlockT *, BlockFrequency>::const_iterator I =
+      Freqs.find(BB);
+    if (I != Freqs.end())
+      return I->second;
+    return 0;
+  }
+
+  /// getEntryFreq - Return the frequency of the entry block.
+  static uint64_t getEntryFreq() { return START_FREQ; }
+
+  void print(raw_ostream &OS) const {
+    OS << "\n\n---- Block Freqs ----\n";
+    for (typename FunctionT::iterator BI = Fn->begin(), BE = Fn->end();
+         BI != BE; ++BI) {
+      BlockT *BB = BI;
+      OS << " " << getBlockName(BB) << " = " << getBlockFreq(BB) << "\n";
+
+      for (typename GraphTraits<BlockT *>::ChildIteratorType
+           SI = GraphTraits<BlockT *>::child_begin(BB),
+           SE = GraphTraits<BlockT *>::child_end(BB); SI != SE; ++SI) {
+        BlockT *Succ = *SI;
+        OS << "  " << getBlockName(BB) << " -> " << getBlockName(Succ)
+           << " = " << getBlockFreq(BB) * BPI->getEdgeProbability(BB, Succ)
+           << "\n";
+      }
+    }
+  }
+
+  void dump() const {
+    print(dbgs());
+  }
+};
+
+}
+
+#endif
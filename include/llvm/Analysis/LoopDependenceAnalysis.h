@@ -36,18 +36,43 @@ class Value;
 class raw_ostream;
 
 class LoopDependenceAnalysis : public LoopPass {
+public:
+  /// Direction - The order of the iterations, in one loop of the nest, in
+  /// which two dependent accesses A and B touch the same location.  LT means
+  /// that A's iteration comes before B's.
+  enum Direction { LT = 1, EQ = 2, GT = 4, AnyDirection = LT | EQ | GT };
+
+  /// Level - What is known about a dependence in one loop of the nest.
+  struct Level {
+    /// Directions - The Directions the dependence may have, or'ed together.
+    unsigned Directions;
+
+    /// Distance - B's iteration minus A's iteration, if that is the same for
+    /// every instance of the dependence, and null otherwise.
+    const SCEV *Distance;
+
+    Level() : Directions(AnyDirection), Distance(0) {}
+  };
+
+private:
   AliasAnalysis *AA;
   ScalarEvolution *SE;
 
   /// L - The loop we are currently analysing.
   Loop *L;
 
-  /// TODO: doc
+  /// Nest - The loops containing L, outermost first, ending with L itself.
+  /// Levels are indices into this list.
+  SmallVector<const Loop*, 4> Nest;
+
+  /// DependenceResult - The outcome of a dependence test.  Unknown means the
+  /// test could not decide, so the accesses have to be assumed dependent.
   enum DependenceResult { Independent = 0, Dependent = 1, Unknown = 2 };
 
-  /// TODO: doc
+  /// Subscript - The result of testing one pair of GEP indices: what they
+  /// allow in each loop of the nest.
   struct Subscript {
-    /// TODO: Add distance, direction, breaking conditions, ...
+    SmallVector<Level, 4> Levels;
   };
 
   /// DependencePair - Represents a data dependence relation between to memory
@@ -58,6 +83,9 @@ class LoopDependenceAnalysis : public LoopPass {
     DependenceResult Result;
     SmallVector<Subscript, 4> Subscripts;
 
+    /// Levels - The intersection of the Levels of all Subscripts.
+    SmallVector<Level, 4> Levels;
+
     DependencePair(const FoldingSetNodeID &ID, Value *a, Value *b) :
         FastFoldingSetNode(ID), A(a), B(b), Result(Unknown), Subscripts() {}
   };
@@ -75,17 +103,30 @@ class LoopDependenceAnalysis : public LoopPass {
   /// loop nest starting at the innermost loop L.
   bool isLoopInvariant(const SCEV*) const;
 
-  /// isAffine - An SCEV is affine with respect to the loop nest starting at
-  /// the innermost loop L if it is of the form A+B*X where A, B are invariant
-  /// in the loop nest and X is a induction variable in the loop nest.
-  bool isAffine(const SCEV*) const;
-
-  /// TODO: doc
-  bool isZIVPair(const SCEV*, const SCEV*) const;
-  bool isSIVPair(const SCEV*, const SCEV*) const;
-  DependenceResult analyseZIV(const SCEV*, const SCEV*, Subscript*) const;
-  DependenceResult analyseSIV(const SCEV*, const SCEV*, Subscript*) const;
-  DependenceResult analyseMIV(const SCEV*, const SCEV*, Subscript*) const;
+  /// getLinearForm - Split an SCEV into a constant coefficient for each
+  /// level of the nest and a part that is invariant in the whole nest, so
+  /// that it is Const + sum(Coeffs[k] * i_k), where i_k counts the iterations
+  /// of the loop at level k.  Return false if that is not possible.
+  bool getLinearForm(const SCEV*, SmallVectorImpl<int64_t> &Coeffs,
+                     const SCEV *&Const) const;
+
+  /// getUpperBound - Return the largest iteration number of the loop at the
+  /// given level, or -1 if it is not a known constant.
+  int64_t getUpperBound(unsigned Level) const;
+
+  /// The dependence tests.  Each gets the coefficients of the two subscripts
+  /// and the difference Delta of their invariant parts (B's minus A's), so
+  /// that a dependence needs sum(CoeffsA[k]*i_k - CoeffsB[k]*j_k) = Delta.
+  /// ZIV subscripts use no loop, SIV subscripts one loop, and MIV subscripts
+  /// several.  The MIV tests are the GCD test and the Banerjee inequalities,
+  /// which also serve as the fallback for SIV subscripts that match none of
+  /// the exact SIV tests.
+  DependenceResult analyseZIV(const SCEV *Delta, Subscript*) const;
+  DependenceResult analyseSIV(unsigned Level, int64_t CoeffA, int64_t CoeffB,
+                              const SCEV *Delta, Subscript*) const;
+  DependenceResult analyseMIV(const SmallVectorImpl<int64_t> &CoeffsA,
+                              const SmallVectorImpl<int64_t> &CoeffsB,
+                              const SCEV *Delta, Subscript*) const;
   DependenceResult analyseSubscript(const SCEV*, const SCEV*, Subscript*) const;
   DependenceResult analysePair(DependencePair*) const;
 
@@ -102,6 +143,12 @@ public:
   /// between two instructions.
   bool depends(Value*, Value*);
 
+  /// getDependenceVector - Return false if the two instructions are known to
+  /// be independent.  Otherwise fill in what is known about their dependence
+  /// in each loop of the nest, outermost first, ending with the loop being
+  /// analysed.
+  bool getDependenceVector(Value*, Value*, SmallVectorImpl<Level> &Levels);
+
   bool runOnLoop(Loop*, LPPassManager&);
   virtual void releaseMemory();
   virtual void getAnalysisUsage(AnalysisUsage&) const;
@@ -173,6 +173,20 @@ public:
     Out[ByteNo  ] = (unsigned char)(NewWord >> 24);
   }
 
+  // BackpatchBits - Backpatch a NumBits wide field starting at bit BitNo in
+  // the output with the specified value.  Unlike BackpatchWord, the field need
+  // not be aligned, but it must already have been flushed to the buffer.
+  void BackpatchBits(uint64_t BitNo, uint32_t Val, unsigned NumBits) {
+    assert(BitNo + NumBits <= Out.size() * 8 && "Field not yet flushed!");
+    for (unsigned i = 0; i != NumBits; ++i, ++BitNo) {
+      unsigned char Mask = (unsigned char)(1 << (BitNo & 7));
+      if (Val & (1U << i))
+        Out[BitNo / 8] |= Mask;
+      else
+        Out[BitNo / 8] &= ~Mask;
+    }
+  }
+
   //===--------------------------------------------------------------------===//
   // Block Manipulation
   //===--------------------------------------------------------------------===//
@@ -35,7 +35,8 @@ namespace bitc {
     TYPE_SYMTAB_BLOCK_ID,
     VALUE_SYMTAB_BLOCK_ID,
     METADATA_BLOCK_ID,
-    METADATA_ATTACHMENT_ID
+    METADATA_ATTACHMENT_ID,
+    FUNCTION_INDEX_BLOCK_ID
   };
 
 
@@ -62,7 +63,11 @@ namespace bitc {
     /// MODULE_CODE_PURGEVALS: [numvals]
     MODULE_CODE_PURGEVALS   = 10,
 
-    MODULE_CODE_GCNAME      = 11   // GCNAME: [strchr x N]
+    MODULE_CODE_GCNAME      = 11,  // GCNAME: [strchr x N]
+
+    /// MODULE_CODE_FNINDEX: [indexoffset]
+    /// Word offset of the FUNCTION_INDEX block from the start of the bitcode.
+    MODULE_CODE_FNINDEX     = 12
   };
 
   /// PARAMATTR blocks have code for defining a parameter attribute set.
@@ -104,6 +109,12 @@ namespace bitc {
     TST_CODE_ENTRY = 1     // TST_ENTRY: [typeid, namechar x N]
   };
 
+  // The function index only has one code (FNINDEX_CODE_ENTRY).  There is one
+  // entry per function body, in the order the bodies appear in the module.
+  enum FunctionIndexCodes {
+    FNINDEX_CODE_ENTRY = 1  // FNINDEX_ENTRY: [bitoffset]
+  };
+
   // The value symbol table only has one code (VST_ENTRY_CODE).
   enum ValueSymtabCodes {
     VST_CODE_ENTRY   = 1,  // VST_ENTRY: [valid, namechar x N]
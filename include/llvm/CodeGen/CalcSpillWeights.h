@@ -18,19 +18,24 @@ namespace llvm {
 
   class LiveInterval;
   class LiveIntervals;
+  class MachineBlockFrequencyInfo;
   class MachineLoopInfo;
 
   /// VirtRegAuxInfo - Calculate auxiliary information for a virtual
   /// register such as its spill weight and allocation hint.
+  /// When block frequencies are available, each use and def is weighted by
+  /// the estimated frequency of its block instead of by its loop depth.
   class VirtRegAuxInfo {
     MachineFunction &mf_;
     LiveIntervals &lis_;
     const MachineLoopInfo &loops_;
+    const MachineBlockFrequencyInfo *mbfi_;
     DenseMap<unsigned, float> hint_;
   public:
     VirtRegAuxInfo(MachineFunction &mf, LiveIntervals &lis,
-                   const MachineLoopInfo &loops) :
-      mf_(mf), lis_(lis), loops_(loops) {}
+                   const MachineLoopInfo &loops,
+                   const MachineBlockFrequencyInfo *mbfi = 0) :
+      mf_(mf), lis_(lis), loops_(loops), mbfi_(mbfi) {}
 
     /// CalculateRegClass - recompute the register class for reg from its uses.
     /// Since the register class can affect the allocation hint, this function
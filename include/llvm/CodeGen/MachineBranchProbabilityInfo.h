@@ -0,0 +1,79 @@
+//==- MachineBranchProbabilityInfo.h - Machine Branch Probability Analysis -==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass is used to evaluate branch probabilties on machine basic blocks.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_MACHINEBRANCHPROBABILITYINFO_H
+#define LLVM_CODEGEN_MACHINEBRANCHPROBABILITYINFO_H
+
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/BranchProbability.h"
+
+namespace llvm {
+
+class MachineBasicBlock;
+class raw_ostream;
+
+/// MachineBranchProbabilityInfo - Branch probabilities for the edges of the
+/// machine CFG.  An edge that corresponds to an edge of the LLVM IR CFG takes
+/// its weight from BranchProbabilityInfo, so profile data and the IR-level
+/// heuristics carry over to codegen.  Blocks whose edges have no IR
+/// counterpart, e.g. blocks created by lowering a switch, fall back to a loop
+/// branch heuristic based on MachineLoopInfo.
+class MachineBranchProbabilityInfo : public MachineFunctionPass {
+
+  // Default weight value. Used when we don't have information about the edge.
+  static const uint32_t DEFAULT_WEIGHT = 16;
+
+  typedef std::pair<const MachineBasicBlock *, const MachineBasicBlock *> Edge;
+
+  DenseMap<Edge, uint32_t> Weights;
+
+  const MachineFunction *MF;
+
+  // Get sum of the block successors' weights.
+  uint32_t getSumForBlock(const MachineBasicBlock *MBB) const;
+
+public:
+  static char ID;
+
+  MachineBranchProbabilityInfo() : MachineFunctionPass(ID), MF(0) {}
+
+  void getAnalysisUsage(AnalysisUsage &AU) const;
+  bool runOnMachineFunction(MachineFunction &MF);
+  void print(raw_ostream &OS, const Module *M = 0) const;
+
+  // Returned value is between 1 and UINT32_MAX.
+  uint32_t getEdgeWeight(const MachineBasicBlock *Src,
+                         const MachineBasicBlock *Dst) const;
+
+  // A 'Hot' edge is an edge which probability is >= 80%.
+  bool isEdgeHot(const MachineBasicBlock *Src,
+                 const MachineBasicBlock *Dst) const;
+
+  // Return a hot successor for the block BB or null if there isn't one.
+  MachineBasicBlock *getHotSucc(MachineBasicBlock *MBB) const;
+
+  // Return a probability as a fraction between 0 (0% probability) and
+  // 1 (100% probability), however the value is never equal to 0, and can be 1
+  // only iff SRC block has only one successor.
+  BranchProbability getEdgeProbability(const MachineBasicBlock *Src,
+                                       const MachineBasicBlock *Dst) const;
+
+  raw_ostream &printEdgeProbability(raw_ostream &OS,
+                                    const MachineBasicBlock *Src,
+                                    const MachineBasicBlock *Dst) const;
+};
+
+}
+
+#endif
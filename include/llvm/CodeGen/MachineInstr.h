@@ -23,6 +23,7 @@
 #include "llvm/ADT/ilist_node.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/Support/ArrayRecycler.h"
 #include "llvm/Support/DebugLoc.h"
 #include <vector>
 
@@ -52,6 +53,8 @@ public:
   };
   
 private:
+  typedef ArrayRecycler<MachineOperand>::Capacity OperandCapacity;
+
   const TargetInstrDesc *TID;           // Instruction descriptor.
   unsigned short NumImplicitOps;        // Number of implicit operands (which
                                         // are determined at construction time).
@@ -63,7 +66,14 @@ private:
                                         // anything other than to convey comment
                                         // information to AsmPrinter.
 
-  std::vector<MachineOperand> Operands; // the operands
+  // Operands are allocated by the owning MachineFunction's ArrayRecycler, in
+  // arrays of CapOperands.getSize() elements.  MF is kept so that operands can
+  // be added before the instruction is inserted into a basic block.
+  MachineOperand *Operands;             // the operands
+  unsigned NumOperands;                 // number of operands on instruction
+  OperandCapacity CapOperands;          // capacity of the Operands array
+  MachineFunction *MF;                  // function that owns the operands
+
   mmo_iterator MemRefs;                 // information on memory references
   mmo_iterator MemRefsEnd;
   MachineBasicBlock *Parent;            // Pointer to the owning basic block.
@@ -88,31 +98,11 @@ private:
   /// TID NULL and no operands.
   MachineInstr();
 
-  // The next two constructors have DebugLoc and non-DebugLoc versions;
-  // over time, the non-DebugLoc versions should be phased out and eventually
-  // removed.
-
-  /// MachineInstr ctor - This constructor creates a MachineInstr and adds the
-  /// implicit operands.  It reserves space for the number of operands specified
-  /// by the TargetInstrDesc.  The version with a DebugLoc should be preferred.
-  explicit MachineInstr(const TargetInstrDesc &TID, bool NoImp = false);
-
-  /// MachineInstr ctor - Work exactly the same as the ctor above, except that
-  /// the MachineInstr is created and added to the end of the specified basic
-  /// block.  The version with a DebugLoc should be preferred.
-  MachineInstr(MachineBasicBlock *MBB, const TargetInstrDesc &TID);
-
   /// MachineInstr ctor - This constructor create a MachineInstr and add the
   /// implicit operands.  It reserves space for number of operands specified by
-  /// TargetInstrDesc.  An explicit DebugLoc is supplied.
-  explicit MachineInstr(const TargetInstrDesc &TID, const DebugLoc dl, 
-                        bool NoImp = false);
-
-  /// MachineInstr ctor - Work exactly the same as the ctor above, except that
-  /// the MachineInstr is created and added to the end of the specified basic
-  /// block.
-  MachineInstr(MachineBasicBlock *MBB, const DebugLoc dl, 
-               const TargetInstrDesc &TID);
+  /// TargetInstrDesc, allocated from the given MachineFunction.
+  MachineInstr(MachineFunction &, const TargetInstrDesc &TID,
+               const DebugLoc dl, bool NoImp = false);
 
   ~MachineInstr();
 
@@ -153,7 +143,7 @@ public:
 
   /// Access to explicit operands of the instruction.
   ///
-  unsigned getNumOperands() const { return (unsigned)Operands.size(); }
+  unsigned getNumOperands() const { return NumOperands; }
 
   const MachineOperand& getOperand(unsigned i) const {
     assert(i < getNumOperands() && "getOperand() out of range!");
@@ -464,6 +454,11 @@ private:
   /// return null.
   MachineRegisterInfo *getRegInfo();
 
+  /// moveOperands - Move NumOps operands from Src to Dst, taking register
+  /// operands off their use lists while they move.  The ranges may overlap.
+  void moveOperands(MachineOperand *Dst, MachineOperand *Src, unsigned NumOps,
+                    MachineRegisterInfo *RegInfo);
+
   /// addImplicitDefUseOperands - Add all implicit def and use operands to
   /// this instruction.
   void addImplicitDefUseOperands();
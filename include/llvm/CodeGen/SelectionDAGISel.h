@@ -19,6 +19,7 @@
 #include "llvm/Pass.h"
 #include "llvm/CodeGen/SelectionDAG.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/ADT/DenseMap.h"
 
 namespace llvm {
   class FastISel;
@@ -304,6 +305,17 @@ private:
   /// OpcodeOffset - This is a cache used to dispatch efficiently into isel
   /// state machines that start with a OPC_SwitchOpcode node.
   std::vector<unsigned> OpcodeOffset;
+
+  /// SwitchCaseOffsets - A cache used to dispatch efficiently on the
+  /// OPC_SwitchOpcode and OPC_SwitchType nodes nested in isel state machines.
+  /// It is keyed by the table index of the first case of each switch, and
+  /// maps each opcode or simple value type to the table index of its case, or
+  /// to 0 if the switch has no case for it.
+  DenseMap<unsigned, std::vector<unsigned> > SwitchCaseOffsets;
+
+  const std::vector<unsigned> &getSwitchCaseOffsets(
+                                            const unsigned char *MatcherTable,
+                                            unsigned CaseIndex, bool IsType);
   
   void UpdateChainsAndFlags(SDNode *NodeToMatch, SDValue InputChain,
                             const SmallVectorImpl<SDNode*> &ChainNodesMatched,
@@ -373,6 +373,13 @@ namespace llvm {
     IndexListEntry *indexListHead;
     unsigned functionSize;
 
+    /// instrCount - The number of instructions currently indexed.
+    /// functionSize only picks it up when an insertion runs out of room or a
+    /// block is added, the points where the whole function used to be
+    /// renumbered and recounted, so that spill weight normalization sees the
+    /// same sizes as before.
+    unsigned instrCount;
+
     typedef DenseMap<const MachineInstr*, SlotIndex> Mi2IndexMap;
     Mi2IndexMap mi2iMap;
 
@@ -389,6 +396,12 @@ namespace llvm {
     // IndexListEntry allocator.
     BumpPtrAllocator ileAllocator;
 
+    /// EntrySpacing - The distance between the indexes of an entry and the
+    /// next in a fresh numbering, per slot the entry needs.  It leaves room
+    /// for an instruction to be inserted between any two entries without
+    /// renumbering.
+    static const unsigned EntrySpacing = 2 * SlotIndex::NUM;
+
     IndexListEntry* createEntry(MachineInstr *mi, unsigned index) {
       IndexListEntry *entry =
         static_cast<IndexListEntry*>(
@@ -482,6 +495,12 @@ namespace llvm {
     /// Renumber the index list, providing space for new instructions.
     void renumberIndexes();
 
+    /// Renumber the entries following curEntry, which has just been inserted
+    /// where there was no room for it, until the numbering catches up with
+    /// the existing indexes.  Only the neighbourhood of the insertion point is
+    /// touched.
+    void renumberIndexes(IndexListEntry *curEntry);
+
     /// Returns the zero index for this analysis.
     SlotIndex getZeroIndex() {
       assert(front()->getIndex() == 0 && "First index is not 0?");
@@ -639,8 +658,7 @@ namespace llvm {
 
     /// Insert the given machine instruction into the mapping. Returns the
     /// assigned index.
-    SlotIndex insertMachineInstrInMaps(MachineInstr *mi,
-                                        bool *deferredRenumber = 0) {
+    SlotIndex insertMachineInstrInMaps(MachineInstr *mi) {
       assert(mi2iMap.find(mi) == mi2iMap.end() && "Instr already indexed.");
 
       MachineBasicBlock *mbb = mi->getParent();
@@ -653,7 +671,6 @@ namespace llvm {
              "Instruction's parent MBB has not been added to SlotIndexes.");
 
       MachineBasicBlock::iterator miItr(mi);
-      bool needRenumber = false;
       IndexListEntry *newEntry;
       // Get previous index, considering that not all instructions are indexed.
       IndexListEntry *prevEntry;
@@ -675,19 +692,16 @@ namespace llvm {
       IndexListEntry *nextEntry = prevEntry->getNext();
 
       // Get a number for the new instr, or 0 if there's no room currently.
-      // In the latter case we'll force a renumber later.
+      // In the latter case the entries that follow are renumbered below.
       unsigned dist = nextEntry->getIndex() - prevEntry->getIndex();
       unsigned newNumber = dist > SlotIndex::NUM ?
         prevEntry->getIndex() + ((dist >> 1) & ~3U) : 0;
 
-      if (newNumber == 0) {
-        needRenumber = true;
-      }
-
       // Insert a new list entry for mi.
       newEntry = createEntry(mi, newNumber);
       insert(nextEntry, newEntry);
-  
+      ++instrCount;
+
       SlotIndex newIndex(newEntry, SlotIndex::LOAD);
       mi2iMap.insert(std::make_pair(mi, newIndex));
 
@@ -698,33 +712,14 @@ namespace llvm {
       }
 
       // Renumber if we need to.
-      if (needRenumber) {
-        if (deferredRenumber == 0)
-          renumberIndexes();
-        else
-          *deferredRenumber = true;
+      if (newNumber == 0) {
+        functionSize = instrCount;
+        renumberIndexes(newEntry);
       }
 
       return newIndex;
     }
 
-    /// Add all instructions in the vector to the index list. This method will
-    /// defer renumbering until all instrs have been added, and should be 
-    /// preferred when adding multiple instrs.
-    void insertMachineInstrsInMaps(SmallVectorImpl<MachineInstr*> &mis) {
-      bool renumber = false;
-
-      for (SmallVectorImpl<MachineInstr*>::iterator
-           miItr = mis.begin(), miEnd = mis.end();
-           miItr != miEnd; ++miItr) {
-        insertMachineInstrInMaps(*miItr, &renumber);
-      }
-
-      if (renumber)
-        renumberIndexes();
-    }
-
-
     /// Remove the given machine instruction from the mapping.
     void removeMachineInstrFromMaps(MachineInstr *mi) {
       // remove index -> MachineInstr and
@@ -736,6 +731,7 @@ namespace llvm {
         // FIXME: Eventually we want to actually delete these indexes.
         miEntry->setInstr(0);
         mi2iMap.erase(mi2iItr);
+        --instrCount;
       }
     }
 
@@ -758,7 +754,6 @@ namespace llvm {
     void insertMBBInMaps(MachineBasicBlock *mbb) {
       MachineFunction::iterator nextMBB =
         llvm::next(MachineFunction::iterator(mbb));
-      IndexListEntry *startEntry = createEntry(0, 0);
       IndexListEntry *nextEntry = 0;
 
       if (nextMBB == mbb->getParent()->end()) {
@@ -767,7 +762,23 @@ namespace llvm {
         nextEntry = &getMBBStartIdx(nextMBB).entry();
       }
 
+      // Number the new block start like an instruction, renumbering locally
+      // if there is no room for it.  A block added at the end of the function
+      // simply follows the last index.
+      IndexListEntry *prevEntry = nextEntry->getPrev();
+      unsigned newNumber;
+      if (nextEntry == getTail()) {
+        newNumber = prevEntry->getIndex() + EntrySpacing;
+      } else {
+        unsigned dist = nextEntry->getIndex() - prevEntry->getIndex();
+        newNumber = dist > SlotIndex::NUM ?
+          prevEntry->getIndex() + ((dist >> 1) & ~3U) : 0;
+      }
+      IndexListEntry *startEntry = createEntry(0, newNumber);
       insert(nextEntry, startEntry);
+      functionSize = instrCount;
+      if (newNumber == 0)
+        renumberIndexes(startEntry);
 
       SlotIndex startIdx(startEntry, SlotIndex::LOAD);
       SlotIndex endIdx(nextEntry, SlotIndex::LOAD);
@@ -784,7 +795,6 @@ namespace llvm {
         mbb2IdxMap[priorMBB].second = startIdx;
       }
 
-      renumberIndexes();
       std::sort(idx2MBBMap.begin(), idx2MBBMap.end(), Idx2MBBCompare());
 
     }
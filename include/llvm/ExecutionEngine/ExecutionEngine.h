@@ -18,11 +18,13 @@
 #include <vector>
 #include <map>
 #include <string>
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/ValueMap.h"
 #include "llvm/Support/ValueHandle.h"
 #include "llvm/System/Mutex.h"
+#include "llvm/System/RWMutex.h"
 #include "llvm/Target/TargetMachine.h"
 
 namespace llvm {
@@ -67,6 +69,16 @@ private:
   /// is called at some point.
   std::map<void *, AssertingVH<const GlobalValue> > GlobalAddressReverseMap;
 
+  /// AvailableAddressMap - A copy of the non-null entries of GlobalAddressMap,
+  /// keyed by plain pointers.  Looking a global up in GlobalAddressMap creates
+  /// a value handle on it, so that map may only be touched with the
+  /// ExecutionEngine lock held.  This copy is only changed with both that lock
+  /// and AvailableAddressLock held for writing, and can be read while holding
+  /// just the reader lock.  That lets threads find code that has already been
+  /// emitted without queueing behind a thread that is compiling.
+  DenseMap<const GlobalValue*, void*> AvailableAddressMap;
+  sys::RWMutex AvailableAddressLock;
+
 public:
   ExecutionEngineState(ExecutionEngine &EE);
 
@@ -82,6 +94,18 @@ public:
 
   // Returns the address ToUnmap was mapped to.
   void *RemoveMapping(const MutexGuard &, const GlobalValue *ToUnmap);
+
+  /// setAvailableAddress - Record in AvailableAddressMap that GV now lives at
+  /// Addr.  A null Addr removes the entry.
+  void setAvailableAddress(const MutexGuard &, const GlobalValue *GV,
+                           void *Addr);
+
+  /// clearAvailableAddresses - Remove every entry from AvailableAddressMap.
+  void clearAvailableAddresses(const MutexGuard &);
+
+  /// getAvailableAddress - Return the address GV is mapped to, or null if it
+  /// has none.  This does not need the ExecutionEngine lock.
+  void *getAvailableAddress(const GlobalValue *GV);
 };
 
 
@@ -91,6 +115,7 @@ class ExecutionEngine {
   bool CompilingLazily;
   bool GVCompilationDisabled;
   bool SymbolSearchingDisabled;
+  bool CallProfilingEnabled;
 
   friend class EngineBuilder;  // To allow access to JITCtor and InterpCtor.
 
@@ -245,7 +270,8 @@ public:
   
   /// getPointerToGlobalIfAvailable - This returns the address of the specified
   /// global value if it is has already been codegen'd, otherwise it returns
-  /// null.
+  /// null.  This does not take the ExecutionEngine lock, so it does not wait
+  /// for other threads that are generating code.
   ///
   void *getPointerToGlobalIfAvailable(const GlobalValue *GV);
 
@@ -299,6 +325,24 @@ public:
   ///
   virtual void *recompileAndRelinkFunction(Function *F) = 0;
 
+  /// relayoutHotFunctions - Recompile the MaxFunctions functions that have
+  /// been called and looped the most since call profiling was enabled next to
+  /// each other in memory, and relink their old code and stubs to the new
+  /// copies, which do not count calls any more.  Returns the number of
+  /// functions moved.  No thread may be running the code being moved.
+  virtual unsigned relayoutHotFunctions(unsigned MaxFunctions) {
+    return 0;
+  }
+
+  /// setCodeCacheDirectory - Save the machine code of the functions compiled
+  /// from now on in Dir, and load code saved there by an earlier run instead
+  /// of compiling a function again.  An empty Dir turns the cache off.
+  /// Returns false if this engine cannot cache code.  The JIT starts out with
+  /// the directory given by -jit-code-cache-dir.
+  virtual bool setCodeCacheDirectory(StringRef Dir) {
+    return false;
+  }
+
   /// freeMachineCodeForFunction - Release memory in the ExecutionEngine
   /// corresponding to the machine code emitted to execute this function, useful
   /// for garbage-collecting generated code.
@@ -364,6 +408,19 @@ public:
     return SymbolSearchingDisabled;
   }
 
+  /// EnableCallProfiling - If called, the JIT will add a counter of the calls
+  /// and loop iterations to each function it compiles from then on, for use
+  /// by relayoutHotFunctions.  The counters are added to the functions' IR
+  /// and stay there until relayoutHotFunctions recompiles the function.
+  /// They are not updated atomically, so calls made from several threads at
+  /// once may not all be counted.
+  void EnableCallProfiling(bool Enabled = true) {
+    CallProfilingEnabled = Enabled;
+  }
+  bool isCallProfilingEnabled() const {
+    return CallProfilingEnabled;
+  }
+
   /// InstallLazyFunctionCreator - If an unknown function is needed, the
   /// specified function pointer is invoked to create it.  If it returns null,
   /// the JIT will abort.
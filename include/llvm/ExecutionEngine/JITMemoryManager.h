@@ -86,6 +86,14 @@ public:
   virtual uint8_t *startFunctionBody(const Function *F,
                                      uintptr_t &ActualSize) = 0;
 
+  /// setAllocateHotCode - The JIT calls this with true before it emits
+  /// functions that it has found to run often, and with false afterwards.
+  /// While it is set, startFunctionBody should place function bodies next to
+  /// each other in a region of memory kept apart from the rest of the code,
+  /// so that the hot code occupies as few cache lines and pages as possible.
+  /// Memory managers that do not keep such a region can ignore it.
+  virtual void setAllocateHotCode(bool Hot) {}
+
   /// allocateStub - This method is called by the JIT to allocate space for a
   /// function stub (used to handle limited branch displacements) while it is
   /// JIT compiling a function.  For example, if foo calls bar, and if bar
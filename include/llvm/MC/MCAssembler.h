@@ -674,8 +674,17 @@ private:
                                uint64_t FragmentOffset) const;
 
   /// LayoutOnce - Perform one layout iteration and return true if any offsets
-  /// were adjusted.
-  bool LayoutOnce(const MCObjectWriter &Writer, MCAsmLayout &Layout);
+  /// were adjusted.  Pending holds, for each section by ordinal, the
+  /// instruction fragments that may still need relaxation.
+  bool LayoutOnce(const MCObjectWriter &Writer, MCAsmLayout &Layout,
+                  std::vector<std::vector<MCInstFragment*> > &Pending);
+
+  /// LayoutSectionOnce - Relax the fragments in Pending, the instruction
+  /// fragments of one section that may still need it, and return true if any
+  /// were relaxed.  Fragments that can no longer need relaxation are removed
+  /// from Pending.
+  bool LayoutSectionOnce(const MCObjectWriter &Writer, MCAsmLayout &Layout,
+                         std::vector<MCInstFragment*> &Pending);
 
   /// FinishLayout - Finalize a layout, including fragment lowering.
   void FinishLayout(MCAsmLayout &Layout);
@@ -0,0 +1,127 @@
+//==- llvm/Support/ArrayRecycler.h - Recycling of Arrays ---------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the ArrayRecycler class template, which can recycle small
+// arrays allocated from one of the allocators in Allocator.h.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_ARRAYRECYCLER_H
+#define LLVM_SUPPORT_ARRAYRECYCLER_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/AlignOf.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/System/DataTypes.h"
+#include <cassert>
+
+namespace llvm {
+
+/// ArrayRecycler - Recycle arrays of T whose sizes are powers of two.  Where
+/// Recycler keeps one free list of objects of a single size, ArrayRecycler
+/// keeps a free list for each array capacity, so that an array that grows
+/// can give its old storage back to be reused by a smaller one.
+///
+/// Arrays are allocated and deallocated by Capacity, which the client must
+/// remember along with the array.  The contents of the arrays are not
+/// constructed or destroyed.
+///
+template<class T, size_t Align = AlignOf<T>::Alignment>
+class ArrayRecycler {
+  /// FreeList - The header imposed on a free array to link it to the next
+  /// free array of the same capacity.
+  struct FreeList {
+    FreeList *Next;
+  };
+
+  /// Bucket - The head of the free list for each capacity, indexed by its
+  /// log2.
+  SmallVector<FreeList*, 8> Bucket;
+
+  T *pop(unsigned Idx) {
+    if (Idx >= Bucket.size())
+      return 0;
+    FreeList *Entry = Bucket[Idx];
+    if (!Entry)
+      return 0;
+    Bucket[Idx] = Entry->Next;
+    return reinterpret_cast<T*>(Entry);
+  }
+
+  void push(unsigned Idx, T *Ptr) {
+    assert(Ptr && "Cannot recycle a null array!");
+    FreeList *Entry = reinterpret_cast<FreeList*>(Ptr);
+    if (Idx >= Bucket.size())
+      Bucket.resize(size_t(Idx) + 1);
+    Entry->Next = Bucket[Idx];
+    Bucket[Idx] = Entry;
+  }
+
+public:
+  /// Capacity - The capacity of an array allocated by the recycler, which is
+  /// always a power of two and so fits in a byte.
+  class Capacity {
+    uint8_t Index;
+    explicit Capacity(uint8_t idx) : Index(idx) {}
+
+  public:
+    Capacity() : Index(0) {}
+
+    /// get - Return the smallest capacity that holds N elements.
+    static Capacity get(size_t N) {
+      return Capacity(N > 1 ? Log2_64_Ceil(N) : 0);
+    }
+
+    /// getBucket - Return the index of the free list for this capacity.
+    unsigned getBucket() const { return Index; }
+
+    /// getSize - Return the number of elements this capacity holds.
+    size_t getSize() const { return size_t(1u) << Index; }
+
+    /// getNext - Return the next larger capacity.
+    Capacity getNext() const { return Capacity(Index + 1); }
+  };
+
+  ~ArrayRecycler() {
+    // The free lists hold memory that belongs to the allocator, so the
+    // client must call clear() first.
+    assert(Bucket.empty() && "Non-empty ArrayRecycler deleted!");
+  }
+
+  /// clear - Release all the free arrays to the allocator.  The recycler
+  /// must be cleared before it is deleted.
+  template<class AllocatorType>
+  void clear(AllocatorType &Allocator) {
+    for (unsigned i = 0, e = Bucket.size(); i != e; ++i)
+      while (T *Ptr = pop(i))
+        Allocator.Deallocate(Ptr);
+    Bucket.clear();
+  }
+
+  /// Allocate - Return an uninitialized array of Cap.getSize() elements,
+  /// reusing a free one if there is one.
+  template<class AllocatorType>
+  T *Allocate(Capacity Cap, AllocatorType &Allocator) {
+    // The free list header is stored in the array itself.
+    assert(sizeof(T) >= sizeof(FreeList) && "Elements are too small!");
+    if (T *Ptr = pop(Cap.getBucket()))
+      return Ptr;
+    return static_cast<T*>(Allocator.Allocate(sizeof(T)*Cap.getSize(), Align));
+  }
+
+  /// Deallocate - Put an array allocated with capacity Cap back on its free
+  /// list.  Its elements must already have been destroyed.
+  void Deallocate(Capacity Cap, T *Ptr) {
+    push(Cap.getBucket(), Ptr);
+  }
+};
+
+} // end llvm namespace
+
+#endif
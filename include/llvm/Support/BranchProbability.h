@@ -0,0 +1,77 @@
+//===- BranchProbability.h - Branch Probability Wrapper ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Definition of BranchProbability shared by IR and Machine Instructions.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_BRANCHPROBABILITY_H
+#define LLVM_SUPPORT_BRANCHPROBABILITY_H
+
+#include "llvm/System/DataTypes.h"
+#include <cassert>
+
+namespace llvm {
+
+class raw_ostream;
+
+/// BranchProbability - A probability represented as a fraction N/D, where
+/// 0 <= N <= D and D != 0.  Edge weights are turned into probabilities by
+/// dividing by the sum of the weights leaving the block.
+class BranchProbability {
+  // Numerator
+  uint32_t N;
+
+  // Denominator
+  uint32_t D;
+
+public:
+  BranchProbability(uint32_t n, uint32_t d) : N(n), D(d) {
+    assert(d > 0 && "Denomiator cannot be 0!");
+    assert(n <= d && "Probability cannot be bigger than 1!");
+  }
+
+  uint32_t getNumerator() const { return N; }
+  uint32_t getDenominator() const { return D; }
+
+  /// getCompl - Return 1 - this probability.
+  BranchProbability getCompl() const {
+    return BranchProbability(D - N, D);
+  }
+
+  /// compare - Return -1, 0 or 1 as this probability is less than, equal to
+  /// or greater than RHS.
+  int compare(const BranchProbability &RHS) const {
+    uint64_t L = (uint64_t)N * RHS.D, R = (uint64_t)RHS.N * D;
+    return L < R ? -1 : (L > R ? 1 : 0);
+  }
+
+  bool operator<(const BranchProbability &RHS) const {
+    return compare(RHS) < 0;
+  }
+  bool operator>(const BranchProbability &RHS) const {
+    return compare(RHS) > 0;
+  }
+  bool operator<=(const BranchProbability &RHS) const {
+    return compare(RHS) <= 0;
+  }
+  bool operator>=(const BranchProbability &RHS) const {
+    return compare(RHS) >= 0;
+  }
+
+  void print(raw_ostream &OS) const;
+
+  void dump() const;
+};
+
+raw_ostream &operator<<(raw_ostream &OS, const BranchProbability &Prob);
+
+}
+
+#endif
@@ -57,7 +57,19 @@ namespace llvm {
                                      SMDiagnostic &Err,
                                      LLVMContext &Context) {
     std::string ErrMsg;
-    MemoryBuffer *F = MemoryBuffer::getFileOrSTDIN(Filename.c_str(), &ErrMsg);
+    // The bitcode reader does not need a null terminator, so large bitcode
+    // files can be mapped in rather than copied.  The assembly parser does
+    // need one, so textual files are read again.  stdin is always copied
+    // with a terminator.
+    MemoryBuffer *F =
+      MemoryBuffer::getFileOrSTDIN(Filename.c_str(), &ErrMsg, -1, 0,
+                                   /*RequiresNullTerminator=*/false);
+    if (F && Filename != "-" &&
+        !isBitcode((const unsigned char *)F->getBufferStart(),
+                   (const unsigned char *)F->getBufferEnd())) {
+      delete F;
+      F = MemoryBuffer::getFile(Filename.c_str(), &ErrMsg);
+    }
     if (F == 0) {
       Err = SMDiagnostic(Filename, 
                          "Could not open input file: " + ErrMsg);
@@ -30,7 +30,9 @@ namespace llvm {
 /// The '\0' guarantee is needed to support an optimization -- it's intended to
 /// be more efficient for clients which are reading all the data to stop
 /// reading when they encounter a '\0' than to continually check the file
-/// position to see if it has reached the end of the file.
+/// position to see if it has reached the end of the file.  Clients that always
+/// check the buffer size, such as the bitcode reader, can waive it when
+/// opening a file, which lets any large file be mapped in without copying.
 class MemoryBuffer {
   const char *BufferStart; // Start of the buffer.
   const char *BufferEnd;   // End of the buffer.
@@ -39,7 +41,8 @@ class MemoryBuffer {
   MemoryBuffer &operator=(const MemoryBuffer &); // DO NOT IMPLEMENT
 protected:
   MemoryBuffer() {}
-  void init(const char *BufStart, const char *BufEnd);
+  void init(const char *BufStart, const char *BufEnd,
+            bool RequiresNullTerminator);
 public:
   virtual ~MemoryBuffer();
 
@@ -60,15 +63,19 @@ public:
   /// getFile - Open the specified file as a MemoryBuffer, returning a new
   /// MemoryBuffer if successful, otherwise returning null.  If FileSize is
   /// specified, this means that the client knows that the file exists and that
-  /// it has the specified size.
+  /// it has the specified size.  If RequiresNullTerminator is false, the
+  /// buffer may not be followed by a '\0', and large files are always mapped
+  /// in rather than read.
   static MemoryBuffer *getFile(StringRef Filename,
                                std::string *ErrStr = 0,
                                int64_t FileSize = -1,
-                               struct stat *FileInfo = 0);
+                               struct stat *FileInfo = 0,
+                               bool RequiresNullTerminator = true);
   static MemoryBuffer *getFile(const char *Filename,
                                std::string *ErrStr = 0,
                                int64_t FileSize = -1,
-                               struct stat *FileInfo = 0);
+                               struct stat *FileInfo = 0,
+                               bool RequiresNullTerminator = true);
 
   /// getMemBuffer - Open the specified memory range as a MemoryBuffer.  Note
   /// that EndPtr[0] must be a null byte and be accessible!
@@ -105,11 +112,13 @@ public:
   static MemoryBuffer *getFileOrSTDIN(StringRef Filename,
                                       std::string *ErrStr = 0,
                                       int64_t FileSize = -1,
-                                      struct stat *FileInfo = 0);
+                                      struct stat *FileInfo = 0,
+                                      bool RequiresNullTerminator = true);
   static MemoryBuffer *getFileOrSTDIN(const char *Filename,
                                       std::string *ErrStr = 0,
                                       int64_t FileSize = -1,
-                                      struct stat *FileInfo = 0);
+                                      struct stat *FileInfo = 0,
+                                      bool RequiresNullTerminator = true);
 };
 
 } // end namespace llvm
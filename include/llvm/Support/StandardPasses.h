@@ -47,6 +47,8 @@ namespace llvm {
   /// \arg HaveExceptions - Whether the module may have code using exceptions.
   /// \arg InliningPass - The inlining pass to use, if any, or null. This will
   /// always be added, even at -O0.a
+  /// \arg Vectorize - Pack straight-line scalar code into vector operations
+  /// after loop unrolling.
   static inline void createStandardModulePasses(PassManagerBase *PM,
                                                 unsigned OptimizationLevel,
                                                 bool OptimizeSize,
@@ -54,7 +56,8 @@ namespace llvm {
                                                 bool UnrollLoops,
                                                 bool SimplifyLibCalls,
                                                 bool HaveExceptions,
-                                                Pass *InliningPass);
+                                                Pass *InliningPass,
+                                                bool Vectorize = false);
 
   /// createStandardLTOPasses - Add the standard list of module passes suitable
   /// for link time optimization.
@@ -90,7 +93,8 @@ namespace llvm {
                                                 bool UnrollLoops,
                                                 bool SimplifyLibCalls,
                                                 bool HaveExceptions,
-                                                Pass *InliningPass) {
+                                                Pass *InliningPass,
+                                                bool Vectorize) {
     if (OptimizationLevel == 0) {
       if (InliningPass)
         PM->add(InliningPass);
@@ -138,6 +142,10 @@ namespace llvm {
     if (UnrollLoops)
       PM->add(createLoopUnrollPass());          // Unroll small loops
     PM->add(createInstructionCombiningPass());  // Clean up after the unroller
+    if (Vectorize) {
+      PM->add(createSLPVectorizePass());        // Pack unrolled scalar code
+      PM->add(createInstructionCombiningPass());
+    }
     if (OptimizationLevel > 1)
       PM->add(createGVNPass());                 // Remove redundancies
     PM->add(createMemCpyOptPass());             // Remove memcpy / form memset
@@ -85,6 +85,7 @@ class Timer {
   TimeRecord Time;
   std::string Name;      // The name of this time variable.
   bool Started;          // Has this time variable ever been started?
+  unsigned Running;      // Number of startTimer calls not yet stopped.
   TimerGroup *TG;        // The TimerGroup this Timer is in.
   
   Timer **Prev, *Next;   // Doubly linked list of timers in the group.
@@ -65,6 +65,20 @@ namespace sys {
     /// in *ErrMsg.
     /// @brief Release Read/Write/Execute memory.
     static bool ReleaseRWX(MemoryBlock &block, std::string *ErrMsg = 0);
+
+    /// This method is like AllocateRWX, but rounds the allocation up to a
+    /// whole number of huge pages, aligns it to the huge page size and asks
+    /// the system to back it with huge pages, which reduces instruction TLB
+    /// misses when large amounts of generated code are run.  Where huge pages
+    /// are not supported it behaves like AllocateRWX.  The block is released
+    /// with ReleaseRWX.
+    /// @brief Allocate huge-page backed Read/Write/Execute memory.
+    static MemoryBlock AllocateHugeRWX(size_t NumBytes,
+                                       std::string *ErrMsg = 0);
+
+    /// getHugePageSize - Return the size of the pages AllocateHugeRWX aligns
+    /// to, or zero if huge pages are not supported on this system.
+    static size_t getHugePageSize();
     
     
     /// InvalidateInstructionCache - Before the JIT can run a block of code
@@ -18,11 +18,16 @@
 #define LLVM_TRANSFORMS_IPO_INLINERPASS_H
 
 #include "llvm/CallGraphSCCPass.h"
+#include "llvm/ADT/DenseMap.h"
 
 namespace llvm {
   class CallSite;
+  class Instruction;
   class TargetData;
   class InlineCost;
+  class BasicBlock;
+  template<class FType, class BType> class ProfileInfoT;
+  typedef ProfileInfoT<Function, BasicBlock> ProfileInfo;
   template<class PtrType, unsigned SmallSize>
   class SmallPtrSet;
 
@@ -54,10 +59,16 @@ struct Inliner : public CallGraphSCCPass {
   /// Calculate the inline threshold for given Caller. This threshold is lower
   /// if the caller is marked with OptimizeForSize and -inline-threshold is not
   /// given on the comand line. It is higher if the callee is marked with the
-  /// inlinehint attribute.
+  /// inlinehint attribute.  With -inline-profile it is also higher at call
+  /// sites the profile shows to be hot, while the module-wide growth budget
+  /// lasts, and zero at call sites it shows to be cold.
   ///
   unsigned getInlineThreshold(CallSite CS) const;
 
+  /// getCallSiteCount - Return the number of times the profile says CS was
+  /// executed, or a negative value if there is no profile for it.
+  double getCallSiteCount(CallSite CS) const;
+
   /// getInlineCost - This method must be implemented by the subclass to
   /// determine the cost of inlining the specified call site.  If the cost
   /// returned is greater than the current inline threshold, the call site is
@@ -87,6 +98,33 @@ private:
   // InlineThreshold - Cache the value here for easy access.
   unsigned InlineThreshold;
 
+  // PI - The edge profile guiding -inline-profile, or null.
+  ProfileInfo *PI;
+
+  // CallSiteCounts - Execution counts of the call sites being visited, taken
+  // before inlining splits their blocks.  Calls exposed by inlining inherit
+  // the count of the call site they were inlined through.
+  DenseMap<const Instruction*, double> CallSiteCounts;
+
+  // MaxCallSiteCount - The count of the hottest call site in the module.
+  double MaxCallSiteCount;
+
+  // ModuleSize - The number of instructions in the module when the profile
+  // was first scanned, and HotGrowth - how many inlining at hot call sites has
+  // added since.
+  unsigned ModuleSize, HotGrowth;
+
+  // ProfileScanned - True once MaxCallSiteCount and ModuleSize are known.
+  bool ProfileScanned;
+
+  /// scanProfile - Compute MaxCallSiteCount and ModuleSize.
+  void scanProfile(CallGraph &CG);
+
+  /// isHotCallSite/isColdCallSite - Classify CS by its profile count relative
+  /// to the hottest call site in the module.
+  bool isHotCallSite(CallSite CS) const;
+  bool isColdCallSite(CallSite CS) const;
+
   /// shouldInline - Return true if the inliner should attempt to
   /// inline at the given CallSite.
   bool shouldInline(CallSite CS);
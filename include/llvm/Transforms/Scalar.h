@@ -123,6 +123,23 @@ Pass *createLoopUnswitchPass(bool OptimizeForSize = false);
 //
 Pass *createLoopUnrollPass();
 
+//===----------------------------------------------------------------------===//
+//
+// LoopVectorize - This pass widens simple innermost loops into vector code
+// with a scalar epilogue.  It takes an optional parameter used to consult the
+// target machine about which vector types and operations are legal.
+//
+Pass *createLoopVectorizePass(const TargetLowering *TLI = 0);
+
+//===----------------------------------------------------------------------===//
+//
+// SLPVectorize - This pass packs isomorphic scalar operations that compute
+// stores to consecutive memory within a basic block into vector operations.
+// It takes an optional parameter used to consult the target machine about
+// which vector types and operations are legal.
+//
+Pass *createSLPVectorizePass(const TargetLowering *TLI = 0);
+
 //===----------------------------------------------------------------------===//
 //
 // LoopRotate - This pass is a simple loop rotating pass.
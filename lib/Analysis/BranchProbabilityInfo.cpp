@@ -0,0 +1,513 @@
+//===-- BranchProbabilityInfo.cpp - Branch Probability Analysis -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Loops should be simplified before this analysis.
+//
+// Every edge gets a weight; the probability of an edge is its weight divided
+// by the sum of the weights leaving its source.  When ProfileInfo has counts
+// for every edge leaving a block, the counts are used directly.  Otherwise
+// the first of the following heuristics that applies decides the weights:
+//
+//  * Unreachable: edges into blocks that inevitably end in 'unreachable' are
+//    almost never taken.
+//  * Loop branch: back edges and edges staying inside the loop are likely,
+//    edges leaving it are not.
+//  * Pointer: a pointer is rarely null, and two pointers are rarely equal.
+//  * Zero: an integer is rarely zero and rarely negative.
+//
+// Blocks no heuristic applies to give each successor the same weight.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Constants.h"
+#include "llvm/Instructions.h"
+#include "llvm/Analysis/BranchProbabilityInfo.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ProfileInfo.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CFG.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+INITIALIZE_PASS_BEGIN(BranchProbabilityInfo, "branch-prob",
+                      "Branch Probability Analysis", false, true)
+INITIALIZE_PASS_DEPENDENCY(LoopInfo)
+INITIALIZE_AG_DEPENDENCY(ProfileInfo)
+INITIALIZE_PASS_END(BranchProbabilityInfo, "branch-prob",
+                    "Branch Probability Analysis", false, true)
+
+char BranchProbabilityInfo::ID = 0;
+
+namespace {
+// Please note that BranchProbabilityAnalysis is not a FunctionPass.
+// It is created by BranchProbabilityInfo (which is a FunctionPass), which
+// provides a clear interface. Thanks to that, all heuristics and other
+// private methods are hidden in the .cpp file.
+class BranchProbabilityAnalysis {
+
+  typedef std::pair<const BasicBlock *, const BasicBlock *> Edge;
+
+  DenseMap<Edge, uint32_t> *Weights;
+
+  LoopInfo *LI;
+
+  ProfileInfo *PI;
+
+  // Blocks from which every path ends in an 'unreachable' instruction.
+  SmallPtrSet<const BasicBlock *, 16> PostDominatedByUnreachable;
+
+  // Weights of the successors of the block being analysed, indexed like
+  // succ_begin(BB).  Duplicate successors are merged when the weights are
+  // stored.
+  SmallVector<uint32_t, 8> SuccWeights;
+
+  // Weights are for internal use only. They are used by heuristics to help to
+  // estimate edges' probability. Example:
+  //
+  // Using "Loop Branch Heuristics" we predict weights of edges for the
+  // block BB2.
+  //         ...
+  //          |
+  //          V
+  //         BB1<-+
+  //          |   |
+  //          |   | (Weight = 124)
+  //          V   |
+  //         BB2--+
+  //          |
+  //          | (Weight = 4)
+  //          V
+  //         BB3
+  //
+  // Probability of the edge BB2->BB1 = 124 / (124 + 4) = 0.96875
+  // Probability of the edge BB2->BB3 = 4 / (124 + 4) = 0.03125
+
+  static const uint32_t LBH_TAKEN_WEIGHT = 124;
+  static const uint32_t LBH_NONTAKEN_WEIGHT = 4;
+
+  static const uint32_t UR_TAKEN_WEIGHT = 1;
+  static const uint32_t UR_NONTAKEN_WEIGHT = 1023;
+
+  static const uint32_t PH_TAKEN_WEIGHT = 20;
+  static const uint32_t PH_NONTAKEN_WEIGHT = 12;
+
+  static const uint32_t ZH_TAKEN_WEIGHT = 20;
+  static const uint32_t ZH_NONTAKEN_WEIGHT = 12;
+
+  // Standard weight value. Used when none of the heuristics set weight for
+  // the edge.
+  static const uint32_t NORMAL_WEIGHT = 16;
+
+  // Minimum weight of an edge. Please note, that weight is NEVER 0.
+  static const uint32_t MIN_WEIGHT = 1;
+
+  // Return TRUE if the edge BB->Succ is the back edge of a loop.
+  bool isBackEdge(BasicBlock *BB, BasicBlock *Succ) const {
+    Loop *L = LI->getLoopFor(Succ);
+    return L && L->getHeader() == Succ && L->contains(BB);
+  }
+
+  // Give every successor of BB the same weight.
+  void setUniformWeights(BasicBlock *BB) {
+    SuccWeights.assign(BB->getTerminator()->getNumSuccessors(), NORMAL_WEIGHT);
+  }
+
+  bool calcProfileWeights(BasicBlock *BB);
+  bool calcUnreachableHeuristics(BasicBlock *BB);
+  bool calcLoopBranchHeuristics(BasicBlock *BB);
+  bool calcPointerHeuristics(BasicBlock *BB);
+  bool calcZeroHeuristics(BasicBlock *BB);
+
+  // Copy SuccWeights into the edge weight map, merging duplicate successors.
+  void commitWeights(BasicBlock *BB);
+
+public:
+  BranchProbabilityAnalysis(DenseMap<Edge, uint32_t> *W,
+                            LoopInfo *LI, ProfileInfo *PI)
+    : Weights(W), LI(LI), PI(PI) {
+  }
+
+  bool runOnFunction(Function &F);
+};
+
+// The weights are bound to references by std::max and the conditional
+// operator, so they need definitions.
+const uint32_t BranchProbabilityAnalysis::LBH_TAKEN_WEIGHT;
+const uint32_t BranchProbabilityAnalysis::LBH_NONTAKEN_WEIGHT;
+const uint32_t BranchProbabilityAnalysis::UR_TAKEN_WEIGHT;
+const uint32_t BranchProbabilityAnalysis::UR_NONTAKEN_WEIGHT;
+const uint32_t BranchProbabilityAnalysis::PH_TAKEN_WEIGHT;
+const uint32_t BranchProbabilityAnalysis::PH_NONTAKEN_WEIGHT;
+const uint32_t BranchProbabilityAnalysis::ZH_TAKEN_WEIGHT;
+const uint32_t BranchProbabilityAnalysis::ZH_NONTAKEN_WEIGHT;
+const uint32_t BranchProbabilityAnalysis::NORMAL_WEIGHT;
+const uint32_t BranchProbabilityAnalysis::MIN_WEIGHT;
+} // end anonymous namespace
+
+// Use the edge counts of ProfileInfo, if it has a count for every edge
+// leaving BB and at least one of them is non-zero.
+bool BranchProbabilityAnalysis::calcProfileWeights(BasicBlock *BB) {
+  TerminatorInst *TI = BB->getTerminator();
+  unsigned NumSuccs = TI->getNumSuccessors();
+  if (NumSuccs < 2)
+    return false;
+
+  SmallVector<double, 8> Counts;
+  double Max = 0;
+  for (unsigned i = 0; i != NumSuccs; ++i) {
+    double Count = PI->getEdgeWeight(ProfileInfo::getEdge(BB,
+                                                          TI->getSuccessor(i)));
+    if (Count == ProfileInfo::MissingValue || Count < 0)
+      return false;
+    Counts.push_back(Count);
+    if (Count > Max)
+      Max = Count;
+  }
+  if (Max == 0)
+    return false;
+
+  // Scale the counts so that the sum of the weights cannot overflow, even
+  // when a successor is listed more than once.
+  double Scale = 1.0;
+  double Limit = (double)(UINT32_MAX / NumSuccs);
+  if (Max > Limit)
+    Scale = Limit / Max;
+
+  SuccWeights.clear();
+  for (unsigned i = 0; i != NumSuccs; ++i) {
+    // Duplicate successors share one profile edge; only count it once.
+    bool Seen = false;
+    for (unsigned j = 0; j != i; ++j)
+      if (TI->getSuccessor(j) == TI->getSuccessor(i))
+        Seen = true;
+    uint32_t Weight = Seen ? 0 : (uint32_t)(Counts[i] * Scale);
+    SuccWeights.push_back(Seen ? 0 : std::max(Weight, MIN_WEIGHT));
+  }
+  return true;
+}
+
+// Calculate Edge Weights using "Unreachable Heuristics". Predict a successor
+// which inevitably leads to an 'unreachable' instruction as not taken.
+bool BranchProbabilityAnalysis::calcUnreachableHeuristics(BasicBlock *BB) {
+  TerminatorInst *TI = BB->getTerminator();
+  unsigned NumSuccs = TI->getNumSuccessors();
+  if (NumSuccs == 0) {
+    if (isa<UnreachableInst>(TI))
+      PostDominatedByUnreachable.insert(BB);
+    return false;
+  }
+
+  unsigned NumUnreachable = 0;
+  for (unsigned i = 0; i != NumSuccs; ++i)
+    if (PostDominatedByUnreachable.count(TI->getSuccessor(i)))
+      ++NumUnreachable;
+
+  // If all successors are unreachable, BB is too.
+  if (NumUnreachable == NumSuccs) {
+    PostDominatedByUnreachable.insert(BB);
+    return false;
+  }
+
+  if (NumUnreachable == 0 || NumSuccs < 2)
+    return false;
+
+  SuccWeights.clear();
+  for (unsigned i = 0; i != NumSuccs; ++i)
+    SuccWeights.push_back(PostDominatedByUnreachable.count(TI->getSuccessor(i))
+                          ? UR_TAKEN_WEIGHT : UR_NONTAKEN_WEIGHT);
+  return true;
+}
+
+// Calculate Edge Weights using "Loop Branch Heuristics". Predict backedges
+// as taken, exiting edges as not-taken.
+bool BranchProbabilityAnalysis::calcLoopBranchHeuristics(BasicBlock *BB) {
+  Loop *L = LI->getLoopFor(BB);
+  if (!L)
+    return false;
+
+  TerminatorInst *TI = BB->getTerminator();
+  unsigned NumSuccs = TI->getNumSuccessors();
+  if (NumSuccs < 2)
+    return false;
+
+  unsigned NumBackEdges = 0, NumExitingEdges = 0, NumInEdges = 0;
+  for (unsigned i = 0; i != NumSuccs; ++i) {
+    BasicBlock *Succ = TI->getSuccessor(i);
+    if (isBackEdge(BB, Succ))
+      ++NumBackEdges;
+    else if (!L->contains(Succ))
+      ++NumExitingEdges;
+    else
+      ++NumInEdges;
+  }
+
+  if (NumBackEdges == 0 && NumExitingEdges == 0)
+    return false;
+
+  // The back edges and the edges staying in the loop share the taken weight;
+  // the exiting edges share the not-taken weight.
+  uint32_t TakenWeight = LBH_TAKEN_WEIGHT;
+  if (NumBackEdges && NumInEdges)
+    TakenWeight /= 2;
+
+  SuccWeights.clear();
+  for (unsigned i = 0; i != NumSuccs; ++i) {
+    BasicBlock *Succ = TI->getSuccessor(i);
+    uint32_t Weight;
+    if (isBackEdge(BB, Succ))
+      Weight = TakenWeight / NumBackEdges;
+    else if (!L->contains(Succ))
+      Weight = LBH_NONTAKEN_WEIGHT / NumExitingEdges;
+    else
+      Weight = TakenWeight / NumInEdges;
+    SuccWeights.push_back(std::max(Weight, MIN_WEIGHT));
+  }
+  return true;
+}
+
+// Calculate Edge Weights using "Pointer Heuristics". Predict a comparison
+// between two pointers or a pointer and NULL to be false.
+bool BranchProbabilityAnalysis::calcPointerHeuristics(BasicBlock *BB) {
+  BranchInst * BI = dyn_cast<BranchInst>(BB->getTerminator());
+  if (!BI || !BI->isConditional())
+    return false;
+
+  ICmpInst *CI = dyn_cast<ICmpInst>(BI->getCondition());
+  if (!CI || !CI->isEquality())
+    return false;
+
+  if (!CI->getOperand(0)->getType()->isPointerTy())
+    return false;
+
+  // p != 0   ->   isProb = true
+  // p == 0   ->   isProb = false
+  // p != q   ->   isProb = true
+  // p == q   ->   isProb = false;
+  bool isProb = CI->getPredicate() == ICmpInst::ICMP_NE;
+
+  SuccWeights.clear();
+  SuccWeights.push_back(isProb ? PH_TAKEN_WEIGHT : PH_NONTAKEN_WEIGHT);
+  SuccWeights.push_back(isProb ? PH_NONTAKEN_WEIGHT : PH_TAKEN_WEIGHT);
+  return true;
+}
+
+// Calculate Edge Weights using "Zero Heuristics". Predict an integer to be
+// non-zero and non-negative.
+bool BranchProbabilityAnalysis::calcZeroHeuristics(BasicBlock *BB) {
+  BranchInst * BI = dyn_cast<BranchInst>(BB->getTerminator());
+  if (!BI || !BI->isConditional())
+    return false;
+
+  ICmpInst *CI = dyn_cast<ICmpInst>(BI->getCondition());
+  if (!CI)
+    return false;
+
+  ConstantInt *CV = dyn_cast<ConstantInt>(CI->getOperand(1));
+  if (!CV || !CV->isZero())
+    return false;
+
+  bool isProb;
+  switch (CI->getPredicate()) {
+  case ICmpInst::ICMP_EQ:
+    // X == 0   ->  Unlikely
+    isProb = false;
+    break;
+  case ICmpInst::ICMP_NE:
+    // X != 0   ->  Likely
+    isProb = true;
+    break;
+  case ICmpInst::ICMP_SLT:
+    // X < 0   ->  Unlikely
+    isProb = false;
+    break;
+  case ICmpInst::ICMP_SGT:
+    // X > 0   ->  Likely
+    isProb = true;
+    break;
+  default:
+    return false;
+  }
+
+  SuccWeights.clear();
+  SuccWeights.push_back(isProb ? ZH_TAKEN_WEIGHT : ZH_NONTAKEN_WEIGHT);
+  SuccWeights.push_back(isProb ? ZH_NONTAKEN_WEIGHT : ZH_TAKEN_WEIGHT);
+  return true;
+}
+
+void BranchProbabilityAnalysis::commitWeights(BasicBlock *BB) {
+  TerminatorInst *TI = BB->getTerminator();
+  for (unsigned i = 0, e = TI->getNumSuccessors(); i != e; ++i)
+    (*Weights)[std::make_pair(BB, TI->getSuccessor(i))] = 0;
+  for (unsigned i = 0, e = TI->getNumSuccessors(); i != e; ++i)
+    (*Weights)[std::make_pair(BB, TI->getSuccessor(i))] += SuccWeights[i];
+  for (unsigned i = 0, e = TI->getNumSuccessors(); i != e; ++i) {
+    uint32_t &W = (*Weights)[std::make_pair(BB, TI->getSuccessor(i))];
+    W = std::max(W, MIN_WEIGHT);
+  }
+}
+
+bool BranchProbabilityAnalysis::runOnFunction(Function &F) {
+  // Walk the blocks in post order so that a block's successors are classified
+  // as post-dominated by 'unreachable' before the block itself, back edges
+  // aside.
+  for (po_iterator<BasicBlock *> I = po_begin(&F.getEntryBlock()),
+       E = po_end(&F.getEntryBlock()); I != E; ++I) {
+    BasicBlock *BB = *I;
+
+    // The unreachable heuristic also classifies BB for its predecessors, so
+    // it runs even when profile counts are available.
+    bool Done = calcUnreachableHeuristics(BB);
+
+    // Measured counts beat every static guess.
+    if (calcProfileWeights(BB))
+      Done = true;
+
+    if (!Done && !calcLoopBranchHeuristics(BB) && !calcPointerHeuristics(BB) &&
+        !calcZeroHeuristics(BB))
+      setUniformWeights(BB);
+    commitWeights(BB);
+  }
+  return false;
+}
+
+void BranchProbabilityInfo::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<LoopInfo>();
+  AU.addRequired<ProfileInfo>();
+  AU.setPreservesAll();
+}
+
+bool BranchProbabilityInfo::runOnFunction(Function &F) {
+  Weights.clear();
+  LoopInfo &LI = getAnalysis<LoopInfo>();
+  ProfileInfo &PI = getAnalysis<ProfileInfo>();
+  BranchProbabilityAnalysis BPA(&Weights, &LI, &PI);
+  return BPA.runOnFunction(F);
+}
+
+void BranchProbabilityInfo::print(raw_ostream &OS, const Module *) const {
+  if (Weights.empty())
+    return;
+  const Function *F = Weights.begin()->first.first->getParent();
+  OS << "---- Branch Probabilities of " << F->getName() << " ----\n";
+  for (Function::const_iterator BI = F->begin(), BE = F->end(); BI != BE;
+       ++BI) {
+    const TerminatorInst *TI = BI->getTerminator();
+    for (unsigned i = 0, e = TI->getNumSuccessors(); i != e; ++i) {
+      const BasicBlock *Succ = TI->getSuccessor(i);
+      // Print each distinct edge once.
+      bool Seen = false;
+      for (unsigned j = 0; j != i; ++j)
+        if (TI->getSuccessor(j) == Succ)
+          Seen = true;
+      if (!Seen)
+        printEdgeProbability(OS, BI, Succ);
+    }
+  }
+}
+
+uint32_t BranchProbabilityInfo::getSumForBlock(const BasicBlock *BB) const {
+  uint32_t Sum = 0;
+  SmallPtrSet<const BasicBlock *, 8> Visited;
+  for (succ_const_iterator I = succ_begin(BB), E = succ_end(BB); I != E; ++I) {
+    const BasicBlock *Succ = *I;
+    if (!Visited.insert(Succ))
+      continue;
+    uint32_t Weight = getEdgeWeight(BB, Succ);
+    uint32_t PrevSum = Sum;
+
+    Sum += Weight;
+    assert(Sum > PrevSum); (void) PrevSum;
+  }
+
+  return Sum;
+}
+
+bool BranchProbabilityInfo::isEdgeHot(const BasicBlock *Src,
+                                      const BasicBlock *Dst) const {
+  // Hot probability is at least 4/5 = 80%
+  return getEdgeProbability(Src, Dst) >= BranchProbability(4, 5);
+}
+
+BasicBlock *BranchProbabilityInfo::getHotSucc(BasicBlock *BB) const {
+  uint32_t Sum = 0;
+  uint32_t MaxWeight = 0;
+  BasicBlock *MaxSucc = 0;
+
+  SmallPtrSet<BasicBlock *, 8> Visited;
+  for (succ_iterator I = succ_begin(BB), E = succ_end(BB); I != E; ++I) {
+    BasicBlock *Succ = *I;
+    if (!Visited.insert(Succ))
+      continue;
+    uint32_t Weight = getEdgeWeight(BB, Succ);
+    uint32_t PrevSum = Sum;
+
+    Sum += Weight;
+    assert(Sum > PrevSum); (void) PrevSum;
+
+    if (Weight > MaxWeight) {
+      MaxWeight = Weight;
+      MaxSucc = Succ;
+    }
+  }
+
+  // Hot probability is at least 4/5 = 80%
+  if (MaxSucc && BranchProbability(MaxWeight, Sum) >= BranchProbability(4, 5))
+    return MaxSucc;
+
+  return 0;
+}
+
+// Return edge's weight. If can't find it, return DEFAULT_WEIGHT value.
+uint32_t
+BranchProbabilityInfo::getEdgeWeight(const BasicBlock *Src,
+                                     const BasicBlock *Dst) const {
+  Edge E(Src, Dst);
+  DenseMap<Edge, uint32_t>::const_iterator I = Weights.find(E);
+
+  if (I != Weights.end())
+    return I->second;
+
+  return DEFAULT_WEIGHT;
+}
+
+void BranchProbabilityInfo::setEdgeWeight(const BasicBlock *Src,
+                                          const BasicBlock *Dst,
+                                          uint32_t Weight) {
+  Weights[std::make_pair(Src, Dst)] = Weight;
+  DEBUG(dbgs() << "set edge " << Src->getNameStr() << " -> "
+               << Dst->getNameStr() << " weight to " << Weight
+               << (isEdgeHot(Src, Dst) ? " [is HOT now]\n" : "\n"));
+}
+
+
+BranchProbability BranchProbabilityInfo::
+getEdgeProbability(const BasicBlock *Src, const BasicBlock *Dst) const {
+
+  uint32_t N = getEdgeWeight(Src, Dst);
+  uint32_t D = getSumForBlock(Src);
+
+  return BranchProbability(N, D);
+}
+
+raw_ostream &
+BranchProbabilityInfo::printEdgeProbability(raw_ostream &OS,
+                                            const BasicBlock *Src,
+                                            const BasicBlock *Dst) const {
+
+  const BranchProbability Prob = getEdgeProbability(Src, Dst);
+  OS << "edge " << Src->getNameStr() << " -> " << Dst->getNameStr()
+     << " probability is " << Prob
+     << (isEdgeHot(Src, Dst) ? " [HOT edge]\n" : "\n");
+
+  return OS;
+}
@@ -13,9 +13,12 @@
 // Please note that this is work in progress and the interface is subject to
 // change.
 //
-// TODO: adapt as implementation progresses.
-//
-// TODO: document lingo (pair, subscript, index)
+// A pair is two memory accesses in the loop, at least one of them a write.
+// If both go through GEPs of the same object, each index of the GEPs forms a
+// subscript, and the accesses are independent if any subscript never takes
+// the same value for both.  Subscripts are tested with the classic ZIV, SIV,
+// GCD and Banerjee tests, which also tell the directions and distances a
+// dependence may have in each loop of the nest.
 //
 //===----------------------------------------------------------------------===//
 
@@ -32,8 +35,10 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetData.h"
+#include <algorithm>
 using namespace llvm;
 
 STATISTIC(NumAnswered,    "Number of dependence queries answered");
@@ -96,10 +101,6 @@ static AliasAnalysis::AliasResult UnderlyingObjectsAlias(AliasAnalysis *AA,
                    bObj, AA->getTypeStoreSize(bObj->getType()));
 }
 
-static inline const SCEV *GetZeroSCEV(ScalarEvolution *SE) {
-  return SE->getConstant(Type::getInt32Ty(SE->getContext()), 0L);
-}
-
 //===----------------------------------------------------------------------===//
 //                             Dependence Testing
 //===----------------------------------------------------------------------===//
@@ -142,42 +143,355 @@ bool LoopDependenceAnalysis::isLoopInvariant(const SCEV *S) const {
   return loops.empty();
 }
 
-bool LoopDependenceAnalysis::isAffine(const SCEV *S) const {
-  const SCEVAddRecExpr *rec = dyn_cast<SCEVAddRecExpr>(S);
-  return isLoopInvariant(S) || (rec && rec->isAffine());
+bool LoopDependenceAnalysis::getLinearForm(const SCEV *S,
+                                           SmallVectorImpl<int64_t> &Coeffs,
+                                           const SCEV *&Const) const {
+  Coeffs.assign(Nest.size(), 0);
+  while (const SCEVAddRecExpr *rec = dyn_cast<SCEVAddRecExpr>(S)) {
+    if (!rec->isAffine())
+      return false;
+    SmallVectorImpl<const Loop*>::const_iterator level =
+      std::find(Nest.begin(), Nest.end(), rec->getLoop());
+    if (level == Nest.end())
+      return false;
+    const SCEVConstant *step =
+      dyn_cast<SCEVConstant>(rec->getStepRecurrence(*SE));
+    if (!step || step->getValue()->getValue().getMinSignedBits() > 32)
+      return false;
+    Coeffs[level - Nest.begin()] += step->getValue()->getSExtValue();
+    S = rec->getStart();
+  }
+  if (!isLoopInvariant(S))
+    return false;
+  Const = S;
+  return true;
 }
 
-bool LoopDependenceAnalysis::isZIVPair(const SCEV *A, const SCEV *B) const {
-  return isLoopInvariant(A) && isLoopInvariant(B);
+int64_t LoopDependenceAnalysis::getUpperBound(unsigned Level) const {
+  const SCEVConstant *max =
+    dyn_cast<SCEVConstant>(SE->getMaxBackedgeTakenCount(Nest[Level]));
+  if (!max || max->getValue()->getValue().getActiveBits() > 32)
+    return -1;
+  return max->getValue()->getZExtValue();
 }
 
-bool LoopDependenceAnalysis::isSIVPair(const SCEV *A, const SCEV *B) const {
-  DenseSet<const Loop*> loops;
-  getLoops(A, &loops);
-  getLoops(B, &loops);
-  return loops.size() == 1;
+/// GetConstantDelta - If Delta is a constant small enough to be negated
+/// without overflow, store it in Val and return true.
+static bool GetConstantDelta(const SCEV *Delta, int64_t &Val) {
+  const SCEVConstant *c = dyn_cast<SCEVConstant>(Delta);
+  if (!c || c->getValue()->getValue().getMinSignedBits() > 63)
+    return false;
+  Val = c->getValue()->getSExtValue();
+  return true;
 }
 
 LoopDependenceAnalysis::DependenceResult
-LoopDependenceAnalysis::analyseZIV(const SCEV *A,
-                                   const SCEV *B,
-                                   Subscript *S) const {
-  assert(isZIVPair(A, B) && "Attempted to ZIV-test non-ZIV SCEVs!");
-  return A == B ? Dependent : Independent;
+LoopDependenceAnalysis::analyseZIV(const SCEV *Delta, Subscript *S) const {
+  if (Delta->isZero()) {
+    DEBUG(dbgs() << "  -> [D] ZIV, same location\n");
+    return Dependent;
+  }
+  if (SE->isKnownNonZero(Delta)) {
+    DEBUG(dbgs() << "  -> [I] ZIV, different locations\n");
+    return Independent;
+  }
+  DEBUG(dbgs() << "  -> [?] ZIV, symbolic difference\n");
+  return Unknown;
 }
 
 LoopDependenceAnalysis::DependenceResult
-LoopDependenceAnalysis::analyseSIV(const SCEV *A,
-                                   const SCEV *B,
-                                   Subscript *S) const {
-  return Unknown; // TODO: Implement.
+LoopDependenceAnalysis::analyseSIV(unsigned L, int64_t CoeffA, int64_t CoeffB,
+                                   const SCEV *Delta, Subscript *S) const {
+  Level &level = S->Levels[L];
+  int64_t upper = getUpperBound(L);
+  int64_t delta;
+  bool isConstant = GetConstantDelta(Delta, delta);
+
+  // Strong SIV: a*i - a*j = Delta, so every dependence has the same distance
+  // j - i = -Delta/a.
+  if (CoeffA == CoeffB) {
+    if (!isConstant) {
+      // The distance is only known when no division is needed.
+      if (CoeffA != 1 && CoeffA != -1) {
+        DEBUG(dbgs() << "  -> [?] strong SIV, symbolic difference\n");
+        return Unknown;
+      }
+      level.Distance = CoeffA == 1 ? SE->getNegativeSCEV(Delta) : Delta;
+      if (SE->isKnownPositive(level.Distance))
+        level.Directions = LT;
+      else if (SE->isKnownNegative(level.Distance))
+        level.Directions = GT;
+      else if (SE->isKnownNonZero(level.Distance))
+        level.Directions = LT | GT;
+      DEBUG(dbgs() << "  -> [D] strong SIV, distance " << *level.Distance
+                   << "\n");
+      return Dependent;
+    }
+    if (delta % CoeffA != 0) {
+      DEBUG(dbgs() << "  -> [I] strong SIV, fractional distance\n");
+      return Independent;
+    }
+    int64_t distance = -delta / CoeffA;
+    if (upper >= 0 && (distance > upper || -distance > upper)) {
+      DEBUG(dbgs() << "  -> [I] strong SIV, distance exceeds trip count\n");
+      return Independent;
+    }
+    level.Distance = SE->getConstant(Delta->getType(), distance, true);
+    level.Directions = distance > 0 ? LT : distance < 0 ? GT : EQ;
+    DEBUG(dbgs() << "  -> [D] strong SIV, distance " << distance << "\n");
+    return Dependent;
+  }
+
+  // The remaining exact tests need a constant Delta.
+  if (!isConstant) {
+    DEBUG(dbgs() << "  -> [?] SIV, symbolic difference\n");
+    return Unknown;
+  }
+
+  // Weak-zero SIV: one of the accesses does not move, so the dependence, if
+  // any, is with the single iteration of the other one that reaches it.
+  if (CoeffA == 0 || CoeffB == 0) {
+    // a*i = Delta or -b*j = Delta.
+    int64_t coeff = CoeffA ? CoeffA : -CoeffB;
+    if (delta % coeff != 0) {
+      DEBUG(dbgs() << "  -> [I] weak-zero SIV, fractional iteration\n");
+      return Independent;
+    }
+    int64_t iter = delta / coeff;
+    if (iter < 0 || (upper >= 0 && iter > upper)) {
+      DEBUG(dbgs() << "  -> [I] weak-zero SIV, iteration out of range\n");
+      return Independent;
+    }
+    // The other access may be in any iteration, before or after iter.
+    bool notFirst = iter > 0, notLast = upper < 0 || iter < upper;
+    level.Directions = EQ;
+    if (CoeffA ? notLast : notFirst) level.Directions |= LT;
+    if (CoeffA ? notFirst : notLast) level.Directions |= GT;
+    DEBUG(dbgs() << "  -> [D] weak-zero SIV, iteration " << iter << "\n");
+    return Dependent;
+  }
+
+  // Weak-crossing SIV: a*i + a*j = Delta, the accesses meet at both sides of
+  // the iteration (i + j)/2.
+  if (CoeffA == -CoeffB) {
+    if (delta % CoeffA != 0) {
+      DEBUG(dbgs() << "  -> [I] weak-crossing SIV, fractional crossing\n");
+      return Independent;
+    }
+    int64_t sum = delta / CoeffA;
+    if (sum < 0 || (upper >= 0 && sum > 2 * upper)) {
+      DEBUG(dbgs() << "  -> [I] weak-crossing SIV, crossing out of range\n");
+      return Independent;
+    }
+    level.Directions = 0;
+    if (sum % 2 == 0)
+      level.Directions |= EQ;
+    if (sum >= 1 && (upper < 0 || sum <= 2 * upper - 1))
+      level.Directions |= LT | GT;
+    if (!level.Directions) {
+      DEBUG(dbgs() << "  -> [I] weak-crossing SIV, no crossing iteration\n");
+      return Independent;
+    }
+    DEBUG(dbgs() << "  -> [D] weak-crossing SIV, crossing at " << sum
+                 << "/2\n");
+    return Dependent;
+  }
+
+  // Fall back to the general tests.
+  SmallVector<int64_t, 4> coeffsA(Nest.size(), 0), coeffsB(Nest.size(), 0);
+  coeffsA[L] = CoeffA;
+  coeffsB[L] = CoeffB;
+  return analyseMIV(coeffsA, coeffsB, Delta, S);
+}
+
+namespace {
+  /// Range - The values a*i - b*j can take in one loop of the nest.
+  struct Range {
+    int64_t Min, Max;
+    Range() : Min(0), Max(0) {}
+    void add(int64_t V) { Min = std::min(Min, V); Max = std::max(Max, V); }
+  };
+}
+
+/// AddNoOverflow, SubNoOverflow, MulNoOverflow - Store X op Y in Result and
+/// return true, or return false if the result does not fit in an int64_t.
+static bool AddNoOverflow(int64_t X, int64_t Y, int64_t &Result) {
+  if (Y > 0 ? X > INT64_MAX - Y : X < INT64_MIN - Y)
+    return false;
+  Result = X + Y;
+  return true;
+}
+
+static bool SubNoOverflow(int64_t X, int64_t Y, int64_t &Result) {
+  if (Y < 0 ? X > INT64_MAX + Y : X < INT64_MIN + Y)
+    return false;
+  Result = X - Y;
+  return true;
+}
+
+static bool MulNoOverflow(int64_t X, int64_t Y, int64_t &Result) {
+  if (X && Y && (X > 0 ? (Y > 0 ? X > INT64_MAX / Y : Y < INT64_MIN / X)
+                       : (Y > 0 ? X < INT64_MIN / Y : X < INT64_MAX / Y)))
+    return false;
+  Result = X * Y;
+  return true;
+}
+
+/// GetBanerjeeRange - Compute the bounds of a*i - b*j for 0 <= i,j <= U under
+/// the given direction between i and j.  The bounds of a linear function over
+/// a polygon are found at its vertices.  Directions other than EQ need U >= 1.
+/// Return false if a bound overflows.
+static bool GetBanerjeeRange(int64_t A, int64_t B, int64_t U, unsigned Dir,
+                             Range &R) {
+  int64_t V0, V1, V2, T;
+  switch (Dir) {
+  default: llvm_unreachable("Not a single direction!");
+  case LoopDependenceAnalysis::EQ:
+    // i = j: (0,0), (U,U).
+    if (!SubNoOverflow(A, B, T) || !MulNoOverflow(T, U, V1))
+      return false;
+    R.Min = R.Max = 0;
+    R.add(V1);
+    return true;
+  case LoopDependenceAnalysis::LT:
+    // i < j: (0,1), (0,U), (U-1,U).
+    if (!SubNoOverflow(0, B, V0) || !MulNoOverflow(B, U, T) ||
+        !SubNoOverflow(0, T, V1) || !MulNoOverflow(A, U - 1, V2) ||
+        !SubNoOverflow(V2, T, V2))
+      return false;
+    break;
+  case LoopDependenceAnalysis::GT:
+    // i > j: (1,0), (U,0), (U,U-1).
+    V0 = A;
+    if (!MulNoOverflow(A, U, V1) || !MulNoOverflow(B, U - 1, T) ||
+        !SubNoOverflow(V1, T, V2))
+      return false;
+    break;
+  }
+  R.Min = R.Max = V0;
+  R.add(V1);
+  R.add(V2);
+  return true;
 }
 
 LoopDependenceAnalysis::DependenceResult
-LoopDependenceAnalysis::analyseMIV(const SCEV *A,
-                                   const SCEV *B,
-                                   Subscript *S) const {
-  return Unknown; // TODO: Implement.
+LoopDependenceAnalysis::analyseMIV(const SmallVectorImpl<int64_t> &CoeffsA,
+                                   const SmallVectorImpl<int64_t> &CoeffsB,
+                                   const SCEV *Delta, Subscript *S) const {
+  int64_t delta;
+  if (!GetConstantDelta(Delta, delta)) {
+    DEBUG(dbgs() << "  -> [?] MIV, symbolic difference\n");
+    return Unknown;
+  }
+
+  // GCD test: the equation has an integer solution only if the gcd of the
+  // coefficients divides Delta.
+  uint64_t gcd = 0;
+  for (unsigned i = 0, e = Nest.size(); i != e; ++i) {
+    gcd = GreatestCommonDivisor64(gcd, CoeffsA[i] < 0 ? -CoeffsA[i]
+                                                      : CoeffsA[i]);
+    gcd = GreatestCommonDivisor64(gcd, CoeffsB[i] < 0 ? -CoeffsB[i]
+                                                      : CoeffsB[i]);
+  }
+  if (gcd && delta % (int64_t)gcd != 0) {
+    DEBUG(dbgs() << "  -> [I] GCD test\n");
+    return Independent;
+  }
+
+  // Banerjee test: Delta has to lie within the bounds of the left hand side.
+  // The bounds are a sum over the loops, so a direction is infeasible in one
+  // loop if Delta is out of bounds even with any direction in the others.
+  // This needs constant trip counts, and coefficients small enough for the
+  // bounds not to overflow.
+  const unsigned AllDirs[] = { LT, EQ, GT };
+  SmallVector<Range, 4> dirRanges(Nest.size() * 3);
+  SmallVector<Range, 4> levelRanges(Nest.size());
+  for (unsigned i = 0, e = Nest.size(); i != e; ++i) {
+    if (!CoeffsA[i] && !CoeffsB[i])
+      continue;
+    int64_t upper = getUpperBound(i);
+    if (upper < 0) {
+      DEBUG(dbgs() << "  -> [D] GCD test, unknown trip count\n");
+      return Dependent;
+    }
+    unsigned &dirs = S->Levels[i].Directions;
+    for (unsigned d = 0; d != 3; ++d) {
+      // A loop that runs once has no pair of distinct iterations.
+      if (AllDirs[d] != EQ && upper < 1) {
+        dirs &= ~AllDirs[d];
+        continue;
+      }
+      if (!GetBanerjeeRange(CoeffsA[i], CoeffsB[i], upper, AllDirs[d],
+                            dirRanges[i * 3 + d])) {
+        DEBUG(dbgs() << "  -> [?] Banerjee test, bounds overflow\n");
+        return Unknown;
+      }
+    }
+  }
+
+  for (bool changed = true; changed; ) {
+    changed = false;
+    // Combine the directions still possible in each loop, and sum them up.
+    int64_t min = 0, max = 0;
+    for (unsigned i = 0, e = Nest.size(); i != e; ++i) {
+      if (!CoeffsA[i] && !CoeffsB[i])
+        continue;
+      unsigned dirs = S->Levels[i].Directions;
+      bool first = true;
+      for (unsigned d = 0; d != 3; ++d) {
+        if (!(dirs & AllDirs[d]))
+          continue;
+        const Range &r = dirRanges[i * 3 + d];
+        if (first) {
+          levelRanges[i] = r;
+          first = false;
+        } else {
+          levelRanges[i].add(r.Min);
+          levelRanges[i].add(r.Max);
+        }
+      }
+      if (first) {
+        DEBUG(dbgs() << "  -> [I] Banerjee test, no direction left\n");
+        return Independent;
+      }
+      if (!AddNoOverflow(min, levelRanges[i].Min, min) ||
+          !AddNoOverflow(max, levelRanges[i].Max, max)) {
+        DEBUG(dbgs() << "  -> [?] Banerjee test, bounds overflow\n");
+        return Unknown;
+      }
+    }
+    if (delta < min || delta > max) {
+      DEBUG(dbgs() << "  -> [I] Banerjee test\n");
+      return Independent;
+    }
+
+    // Try to rule out each direction.
+    for (unsigned i = 0, e = Nest.size(); i != e; ++i) {
+      if (!CoeffsA[i] && !CoeffsB[i])
+        continue;
+      unsigned &dirs = S->Levels[i].Directions;
+      for (unsigned d = 0; d != 3; ++d) {
+        if (!(dirs & AllDirs[d]))
+          continue;
+        // The bounds with only this direction in this loop.
+        const Range &r = dirRanges[i * 3 + d];
+        int64_t dirMin, dirMax;
+        if (!SubNoOverflow(r.Min, levelRanges[i].Min, dirMin) ||
+            !AddNoOverflow(min, dirMin, dirMin) ||
+            !SubNoOverflow(r.Max, levelRanges[i].Max, dirMax) ||
+            !AddNoOverflow(max, dirMax, dirMax)) {
+          DEBUG(dbgs() << "  -> [?] Banerjee test, bounds overflow\n");
+          return Unknown;
+        }
+        if (delta < dirMin || delta > dirMax) {
+          dirs &= ~AllDirs[d];
+          changed = true;
+        }
+      }
+    }
+  }
+  DEBUG(dbgs() << "  -> [D] Banerjee test\n");
+  return Dependent;
 }
 
 LoopDependenceAnalysis::DependenceResult
@@ -185,29 +499,45 @@ LoopDependenceAnalysis::analyseSubscript(const SCEV *A,
                                          const SCEV *B,
                                          Subscript *S) const {
   DEBUG(dbgs() << "  Testing subscript: " << *A << ", " << *B << "\n");
+  S->Levels.assign(Nest.size(), Level());
 
-  if (A == B) {
-    DEBUG(dbgs() << "  -> [D] same SCEV\n");
-    return Dependent;
-  }
-
-  if (!isAffine(A) || !isAffine(B)) {
+  SmallVector<int64_t, 4> coeffsA, coeffsB;
+  const SCEV *constA, *constB;
+  if (!getLinearForm(A, coeffsA, constA) ||
+      !getLinearForm(B, coeffsB, constB)) {
     DEBUG(dbgs() << "  -> [?] not affine\n");
     return Unknown;
   }
 
-  if (isZIVPair(A, B))
-    return analyseZIV(A, B, S);
+  // The indices may have different widths, compute Delta in the wider one.
+  const Type *aTy = SE->getEffectiveSCEVType(constA->getType());
+  const Type *bTy = SE->getEffectiveSCEVType(constB->getType());
+  const Type *ty =
+    SE->getTypeSizeInBits(aTy) >= SE->getTypeSizeInBits(bTy) ? aTy : bTy;
+  const SCEV *delta = SE->getMinusSCEV(SE->getNoopOrSignExtend(constB, ty),
+                                       SE->getNoopOrSignExtend(constA, ty));
+
+  // Classify the subscript by the number of loops it depends on.
+  unsigned numLevels = 0, level = 0;
+  for (unsigned i = 0, e = Nest.size(); i != e; ++i)
+    if (coeffsA[i] || coeffsB[i]) {
+      ++numLevels;
+      level = i;
+    }
+
+  if (numLevels == 0)
+    return analyseZIV(delta, S);
 
-  if (isSIVPair(A, B))
-    return analyseSIV(A, B, S);
+  if (numLevels == 1)
+    return analyseSIV(level, coeffsA[level], coeffsB[level], delta, S);
 
-  return analyseMIV(A, B, S);
+  return analyseMIV(coeffsA, coeffsB, delta, S);
 }
 
 LoopDependenceAnalysis::DependenceResult
 LoopDependenceAnalysis::analysePair(DependencePair *P) const {
   DEBUG(dbgs() << "Analysing:\n" << *P->A << "\n" << *P->B << "\n");
+  P->Levels.assign(Nest.size(), Level());
 
   // We only analyse loads and stores but no possible memory accesses by e.g.
   // free, call, or invoke instructions.
@@ -242,20 +572,25 @@ LoopDependenceAnalysis::analysePair(DependencePair *P) const {
 
   // FIXME: Is filtering coupled subscripts necessary?
 
-  // Collect GEP operand pairs (FIXME: use GetGEPOperands from BasicAA), adding
-  // trailing zeroes to the smaller GEP, if needed.
+  // Subscripts can only be compared index by index if both GEPs step from the
+  // same pointer, and so the same source type, with as many indices.  GEPs of
+  // different pointers into the same object, or with more indices on one
+  // side, address the object differently, and pairing up their indices gives
+  // wrong answers.
+  if (aGEP->getPointerOperand() != bGEP->getPointerOperand() ||
+      aGEP->getNumIndices() != bGEP->getNumIndices()) {
+    DEBUG(dbgs() << "---> [?] GEPs of different shape\n");
+    return Unknown;
+  }
+
+  // Collect GEP operand pairs (FIXME: use GetGEPOperands from BasicAA).
   typedef SmallVector<std::pair<const SCEV*, const SCEV*>, 4> GEPOpdPairsTy;
   GEPOpdPairsTy opds;
-  for(GEPOperator::const_op_iterator aIdx = aGEP->idx_begin(),
-                                     aEnd = aGEP->idx_end(),
-                                     bIdx = bGEP->idx_begin(),
-                                     bEnd = bGEP->idx_end();
-      aIdx != aEnd && bIdx != bEnd;
-      aIdx += (aIdx != aEnd), bIdx += (bIdx != bEnd)) {
-    const SCEV* aSCEV = (aIdx != aEnd) ? SE->getSCEV(*aIdx) : GetZeroSCEV(SE);
-    const SCEV* bSCEV = (bIdx != bEnd) ? SE->getSCEV(*bIdx) : GetZeroSCEV(SE);
-    opds.push_back(std::make_pair(aSCEV, bSCEV));
-  }
+  for (GEPOperator::const_op_iterator aIdx = aGEP->idx_begin(),
+                                      aEnd = aGEP->idx_end(),
+                                      bIdx = bGEP->idx_begin();
+       aIdx != aEnd; ++aIdx, ++bIdx)
+    opds.push_back(std::make_pair(SE->getSCEV(*aIdx), SE->getSCEV(*bIdx)));
 
   if (!opds.empty() && opds[0].first != opds[0].second) {
     // We cannot (yet) handle arbitrary GEP pointer offsets. By limiting
@@ -268,19 +603,55 @@ LoopDependenceAnalysis::analysePair(DependencePair *P) const {
   }
 
   // Now analyse the collected operand pairs (skipping the GEP ptr offsets).
+  // A single independent subscript proves the accesses independent.  The
+  // others constrain the dependence in each loop, so intersect what they
+  // allow, which may leave nothing.
+  DependenceResult result = Dependent;
   for (GEPOpdPairsTy::const_iterator i = opds.begin() + 1, end = opds.end();
        i != end; ++i) {
     Subscript subscript;
-    DependenceResult result = analyseSubscript(i->first, i->second, &subscript);
-    if (result != Dependent) {
-      // We either proved independence or failed to analyse this subscript.
-      // Further subscripts will not improve the situation, so abort early.
-      return result;
+    switch (analyseSubscript(i->first, i->second, &subscript)) {
+    case Independent:
+      return Independent;
+    case Unknown:
+      // Nothing is known about this subscript, but the others still hold.
+      result = Unknown;
+      continue;
+    case Dependent:
+      break;
+    }
+
+    for (unsigned l = 0, e = Nest.size(); l != e; ++l) {
+      Level &level = P->Levels[l];
+      const Level &other = subscript.Levels[l];
+      level.Directions &= other.Directions;
+      if (!level.Directions) {
+        DEBUG(dbgs() << "---> [I] no common direction\n");
+        return Independent;
+      }
+      if (!level.Distance) {
+        level.Distance = other.Distance;
+        continue;
+      }
+      const SCEVConstant *c1 = dyn_cast<SCEVConstant>(level.Distance);
+      const SCEVConstant *c2 = dyn_cast_or_null<SCEVConstant>(other.Distance);
+      if (c1 && c2 &&
+          c1->getValue()->getSExtValue() != c2->getValue()->getSExtValue()) {
+        DEBUG(dbgs() << "---> [I] different distances\n");
+        return Independent;
+      }
     }
     P->Subscripts.push_back(subscript);
   }
-  // We successfully analysed all subscripts but failed to prove independence.
-  return Dependent;
+
+  // Dependences only within the same iteration have distance zero.
+  for (unsigned l = 0, e = Nest.size(); l != e; ++l)
+    if (P->Levels[l].Directions == EQ && !P->Levels[l].Distance)
+      P->Levels[l].Distance =
+        SE->getConstant(Type::getInt64Ty(SE->getContext()), 0);
+
+  // We analysed all subscripts but failed to prove independence.
+  return result;
 }
 
 bool LoopDependenceAnalysis::depends(Value *A, Value *B) {
@@ -300,12 +671,27 @@ bool LoopDependenceAnalysis::depends(Value *A, Value *B) {
   return p->Result != Independent;
 }
 
+bool LoopDependenceAnalysis::getDependenceVector(Value *A, Value *B,
+                                               SmallVectorImpl<Level> &Levels) {
+  if (!depends(A, B))
+    return false;
+  DependencePair *p;
+  findOrInsertDependencePair(A, B, p);
+  Levels.clear();
+  Levels.append(p->Levels.begin(), p->Levels.end());
+  return true;
+}
+
 //===----------------------------------------------------------------------===//
 //                   LoopDependenceAnalysis Implementation
 //===----------------------------------------------------------------------===//
 
 bool LoopDependenceAnalysis::runOnLoop(Loop *L, LPPassManager &) {
   this->L = L;
+  Nest.clear();
+  for (const Loop *Cur = L; Cur; Cur = Cur->getParentLoop())
+    Nest.push_back(Cur);
+  std::reverse(Nest.begin(), Nest.end());
   AA = &getAnalysis<AliasAnalysis>();
   SE = &getAnalysis<ScalarEvolution>();
   return false;
@@ -322,6 +708,31 @@ void LoopDependenceAnalysis::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequiredTransitive<ScalarEvolution>();
 }
 
+static void PrintDependenceVector(raw_ostream &OS,
+             const SmallVectorImpl<LoopDependenceAnalysis::Level> &Levels) {
+  static const char *const Names[] = {
+    "", "<", "=", "<=", ">", "<>", ">=", "*"
+  };
+  bool hasDistance = false;
+  OS << " [";
+  for (unsigned i = 0, e = Levels.size(); i != e; ++i) {
+    OS << (i ? "," : "") << Names[Levels[i].Directions];
+    hasDistance |= Levels[i].Distance != 0;
+  }
+  OS << "]";
+  if (!hasDistance)
+    return;
+  OS << " [";
+  for (unsigned i = 0, e = Levels.size(); i != e; ++i) {
+    OS << (i ? "," : "");
+    if (Levels[i].Distance)
+      OS << *Levels[i].Distance;
+    else
+      OS << "?";
+  }
+  OS << "]";
+}
+
 static void PrintLoopInfo(raw_ostream &OS,
                           LoopDependenceAnalysis *LDA, const Loop *L) {
   if (!L->empty()) return; // ignore non-innermost loops
@@ -343,10 +754,18 @@ static void PrintLoopInfo(raw_ostream &OS,
        end = memrefs.end(); x != end; ++x)
     for (SmallVector<Instruction*, 8>::const_iterator y = x + 1;
          y != end; ++y)
-      if (LDA->isDependencePair(*x, *y))
+      if (LDA->isDependencePair(*x, *y)) {
         OS << "\t" << (x - memrefs.begin()) << "," << (y - memrefs.begin())
-           << ": " << (LDA->depends(*x, *y) ? "dependent" : "independent")
-           << "\n";
+           << ": ";
+        SmallVector<LoopDependenceAnalysis::Level, 4> levels;
+        if (LDA->getDependenceVector(*x, *y, levels)) {
+          OS << "dependent";
+          PrintDependenceVector(OS, levels);
+        } else {
+          OS << "independent";
+        }
+        OS << "\n";
+      }
 }
 
 void LoopDependenceAnalysis::print(raw_ostream &OS, const Module*) const {
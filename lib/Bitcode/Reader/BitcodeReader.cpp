@@ -1269,6 +1269,68 @@ bool BitcodeReader::RememberAndSkipFunctionBody() {
   return false;
 }
 
+/// ParseFunctionIndex - Read the FUNCTION_INDEX block, which gives the
+/// position of every function body in the module, instead of skipping over the
+/// function blocks one at a time.  On success the stream is left just past the
+/// index block, which follows the last function block.
+bool BitcodeReader::ParseFunctionIndex() {
+  uint64_t StreamSize = StreamFile.getLastChar() - StreamFile.getFirstChar();
+  if (FunctionIndexOffset * 4 >= StreamSize)
+    return Error("Malformed function index");
+
+  ModuleAbbrevWidth = Stream.GetAbbrevIDWidth();
+  Stream.JumpToBit(FunctionIndexOffset * 32);
+
+  if (Stream.ReadCode() != bitc::ENTER_SUBBLOCK ||
+      Stream.ReadSubBlockID() != bitc::FUNCTION_INDEX_BLOCK_ID ||
+      Stream.EnterSubBlock(bitc::FUNCTION_INDEX_BLOCK_ID))
+    return Error("Malformed function index");
+
+  SmallVector<uint64_t, 1> Record;
+
+  // Read all the records for this index.
+  while (1) {
+    unsigned Code = Stream.ReadCode();
+    if (Code == bitc::END_BLOCK) {
+      if (Stream.ReadBlockEnd())
+        return Error("Error at end of function index block");
+      UsedFunctionIndex = true;
+      return false;
+    }
+
+    if (Code == bitc::ENTER_SUBBLOCK) {
+      // No known subblocks, always skip them.
+      Stream.ReadSubBlockID();
+      if (Stream.SkipBlock())
+        return Error("Malformed block record");
+      continue;
+    }
+
+    if (Code == bitc::DEFINE_ABBREV) {
+      Stream.ReadAbbrevRecord();
+      continue;
+    }
+
+    // Read a record.
+    Record.clear();
+    switch (Stream.ReadRecord(Code, Record)) {
+    default:  // Default behavior: unknown type.
+      break;
+    case bitc::FNINDEX_CODE_ENTRY: {  // FNINDEX_ENTRY: [bitoffset]
+      if (Record.size() < 1 || Record[0] / 8 >= StreamSize)
+        return Error("Invalid FNINDEX_ENTRY record");
+      if (FunctionsWithBodies.empty())
+        return Error("Insufficient function protos");
+
+      Function *Fn = FunctionsWithBodies.back();
+      FunctionsWithBodies.pop_back();
+      DeferredFunctionInfo[Fn] = Record[0];
+      break;
+    }
+    }
+  }
+}
+
 bool BitcodeReader::ParseModule() {
   if (Stream.EnterSubBlock(bitc::MODULE_BLOCK_ID))
     return Error("Malformed block record");
@@ -1355,6 +1417,14 @@ bool BitcodeReader::ParseModule() {
           HasReversedFunctionsWithBodies = true;
         }
 
+        // If the module has an index of its function bodies, use it to find
+        // them all at once and continue after the last one.
+        if (FunctionIndexOffset && !UsedFunctionIndex) {
+          if (ParseFunctionIndex())
+            return true;
+          break;
+        }
+
         if (RememberAndSkipFunctionBody())
           return true;
         break;
@@ -1419,6 +1489,11 @@ bool BitcodeReader::ParseModule() {
       GCTable.push_back(S);
       break;
     }
+    case bitc::MODULE_CODE_FNINDEX:  // FNINDEX: [indexoffset]
+      if (Record.size() < 1)
+        return Error("Invalid MODULE_CODE_FNINDEX record");
+      FunctionIndexOffset = Record[0];
+      break;
     // GLOBALVAR: [pointer type, isconst, initid,
     //             linkage, alignment, section, visibility, threadlocal]
     case bitc::MODULE_CODE_GLOBALVAR: {
@@ -2528,6 +2603,16 @@ bool BitcodeReader::Materialize(GlobalValue *GV, std::string *ErrInfo) {
   // Move the bit stream to the saved position of the deferred function body.
   Stream.JumpToBit(DFII->second);
 
+  // Positions taken from the function index point at the block header rather
+  // than just past it.
+  if (UsedFunctionIndex &&
+      (Stream.Read(ModuleAbbrevWidth) != bitc::ENTER_SUBBLOCK ||
+       Stream.ReadSubBlockID() != bitc::FUNCTION_BLOCK_ID)) {
+    Error("Malformed function index");
+    if (ErrInfo) *ErrInfo = ErrorString;
+    return true;
+  }
+
   if (ParseFunctionBody(F)) {
     if (ErrInfo) *ErrInfo = ErrorString;
     return true;
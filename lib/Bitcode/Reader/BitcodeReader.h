@@ -168,6 +168,17 @@ class BitcodeReader : public GVMaterializer {
   /// map contains info about where to find deferred function body in the
   /// stream.
   DenseMap<Function*, uint64_t> DeferredFunctionInfo;
+
+  /// FunctionIndexOffset - The word offset of the FUNCTION_INDEX block given by
+  /// the MODULE_CODE_FNINDEX record, or zero if the module has no index.
+  uint64_t FunctionIndexOffset;
+
+  /// UsedFunctionIndex - True if DeferredFunctionInfo was filled in from the
+  /// function index.  The index records the start of each function block, so
+  /// the block header still has to be read when the body is materialized,
+  /// using ModuleAbbrevWidth to decode the ENTER_SUBBLOCK code.
+  bool UsedFunctionIndex;
+  unsigned ModuleAbbrevWidth;
   
   /// BlockAddrFwdRefs - These are blockaddr references to basic blocks.  These
   /// are resolved lazily when functions are loaded.
@@ -184,6 +195,7 @@ public:
   explicit BitcodeReader(MemoryBuffer *buffer, LLVMContext &C)
     : Context(C), TheModule(0), Buffer(buffer), BufferOwned(false),
       ErrorString(0), ValueList(C), MDValueList(C),
+      FunctionIndexOffset(0), UsedFunctionIndex(false), ModuleAbbrevWidth(0),
       LLVM2_7MetadataDetected(false) {
     HasReversedFunctionsWithBodies = false;
   }
@@ -270,6 +282,7 @@ private:
   bool ParseValueSymbolTable();
   bool ParseConstants();
   bool RememberAndSkipFunctionBody();
+  bool ParseFunctionIndex();
   bool ParseFunctionBody(Function *F);
   bool ResolveGlobalAndAliasInits();
   bool ParseMetadata();
@@ -1474,8 +1474,50 @@ static void WriteBlockInfo(const ValueEnumerator &VE, BitstreamWriter &Stream) {
 }
 
 
-/// WriteModule - Emit the specified module to the bitstream.
-static void WriteModule(const Module *M, BitstreamWriter &Stream) {
+/// WriteFunctionIndexPlaceholder - Emit a MODULE_CODE_FNINDEX record with a
+/// fixed width operand that is filled in once the function index has been
+/// written.  Returns the bit position of the operand.
+static uint64_t WriteFunctionIndexPlaceholder(BitstreamWriter &Stream) {
+  BitCodeAbbrev *Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::MODULE_CODE_FNINDEX));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+  unsigned FnIndexAbbrev = Stream.EmitAbbrev(Abbv);
+
+  SmallVector<unsigned, 1> Vals;
+  Vals.push_back(0);
+  Stream.EmitRecord(bitc::MODULE_CODE_FNINDEX, Vals, FnIndexAbbrev);
+  return Stream.GetCurrentBitNo() - 32;
+}
+
+/// WriteFunctionIndex - Emit the FUNCTION_INDEX block, which records where
+/// each function block starts, and point the MODULE_CODE_FNINDEX record at it.
+/// Offsets are relative to StartBit, the start of the bitcode magic number.
+static void WriteFunctionIndex(const std::vector<uint64_t> &FunctionOffsets,
+                               uint64_t FnIndexPlaceholder, uint64_t StartBit,
+                               BitstreamWriter &Stream) {
+  // Function blocks end word aligned, so the index starts on a word boundary.
+  uint64_t IndexOffset = Stream.GetCurrentBitNo() - StartBit;
+  assert((IndexOffset & 31) == 0 && "Function index not word aligned!");
+  assert((IndexOffset >> 5) == (uint32_t)(IndexOffset >> 5) &&
+         "Bitcode file too large for a function index!");
+  Stream.BackpatchBits(FnIndexPlaceholder, (uint32_t)(IndexOffset >> 5), 32);
+
+  Stream.EnterSubblock(bitc::FUNCTION_INDEX_BLOCK_ID, 3);
+
+  SmallVector<uint64_t, 1> Vals;
+  for (unsigned i = 0, e = FunctionOffsets.size(); i != e; ++i) {
+    Vals.push_back(FunctionOffsets[i]);
+    Stream.EmitRecord(bitc::FNINDEX_CODE_ENTRY, Vals);
+    Vals.clear();
+  }
+
+  Stream.ExitBlock();
+}
+
+/// WriteModule - Emit the specified module to the bitstream.  StartBit is the
+/// position of the bitcode magic number, which the reader treats as offset 0.
+static void WriteModule(const Module *M, BitstreamWriter &Stream,
+                        uint64_t StartBit) {
   Stream.EnterSubblock(bitc::MODULE_BLOCK_ID, 3);
 
   // Emit the version number if it is non-zero.
@@ -1507,10 +1549,22 @@ static void WriteModule(const Module *M, BitstreamWriter &Stream) {
   // Emit metadata.
   WriteModuleMetadata(M, VE, Stream);
 
-  // Emit function bodies.
-  for (Module::const_iterator I = M->begin(), E = M->end(); I != E; ++I)
-    if (!I->isDeclaration())
-      WriteFunction(*I, VE, Stream);
+  // Emit function bodies, followed by an index giving the position of each
+  // one, so that a lazy reader can find them without walking the stream.
+  std::vector<uint64_t> FunctionOffsets;
+  uint64_t FnIndexPlaceholder = 0;
+  for (Module::const_iterator I = M->begin(), E = M->end(); I != E; ++I) {
+    if (I->isDeclaration())
+      continue;
+
+    if (FunctionOffsets.empty())
+      FnIndexPlaceholder = WriteFunctionIndexPlaceholder(Stream);
+    FunctionOffsets.push_back(Stream.GetCurrentBitNo() - StartBit);
+    WriteFunction(*I, VE, Stream);
+  }
+
+  if (!FunctionOffsets.empty())
+    WriteFunctionIndex(FunctionOffsets, FnIndexPlaceholder, StartBit, Stream);
 
   // Emit metadata.
   WriteModuleMetadataStore(M, Stream);
@@ -1648,6 +1702,7 @@ void llvm::WriteBitcodeToStream(const Module *M, BitstreamWriter &Stream) {
     EmitDarwinBCHeader(Stream, M->getTargetTriple());
 
   // Emit the file header.
+  uint64_t StartBit = Stream.GetCurrentBitNo();
   Stream.Emit((unsigned)'B', 8);
   Stream.Emit((unsigned)'C', 8);
   Stream.Emit(0x0, 4);
@@ -1656,7 +1711,7 @@ void llvm::WriteBitcodeToStream(const Module *M, BitstreamWriter &Stream) {
   Stream.Emit(0xD, 4);
 
   // Emit the module.
-  WriteModule(M, Stream);
+  WriteModule(M, Stream, StartBit);
 
   if (isDarwin)
     EmitDarwinBCTrailer(Stream, Stream.getBuffer().size());
@@ -52,6 +52,11 @@ static cl::opt<bool> UnknownLocations("use-unknown-locations", cl::Hidden,
      cl::desc("Make an absense of debug location information explicit."),
      cl::init(false));
 
+static cl::opt<bool> DwarfStringPool("dwarf-string-pool", cl::Hidden,
+     cl::desc("Refer to strings in .debug_str instead of repeating them in "
+              "every DIE"),
+     cl::init(false));
+
 namespace {
   const char *DWARFGroupName = "DWARF Emission";
   const char *DbgTimerName = "DWARF Debug Writer";
@@ -459,9 +464,17 @@ void DwarfDebug::addSInt(DIE *Die, unsigned Attribute,
 }
 
 /// addString - Add a string attribute data and value. DIEString only
-/// keeps string reference.
+/// keeps string reference.  With -dwarf-string-pool, inline strings are
+/// instead placed in the string pool, which emits each distinct string once
+/// for the whole module, and the DIE refers to it with DW_FORM_strp.
 void DwarfDebug::addString(DIE *Die, unsigned Attribute, unsigned Form,
                            StringRef String) {
+  if (DwarfStringPool && Form == dwarf::DW_FORM_string) {
+    DIEValue *Value =
+      new (DIEValueAllocator) DIELabel(getStringPoolEntry(String));
+    Die->addValue(Attribute, dwarf::DW_FORM_strp, Value);
+    return;
+  }
   DIEValue *Value = new (DIEValueAllocator) DIEString(String);
   Die->addValue(Attribute, Form, Value);
 }
@@ -3159,6 +3172,14 @@ void DwarfDebug::emitDIE(DIE *Die) {
     if (Asm->isVerbose())
       Asm->OutStreamer.AddComment(dwarf::AttributeString(Attr));
 
+    // Strings in the string pool are referred to by their offset in
+    // .debug_str, whatever the attribute.
+    if (Form == dwarf::DW_FORM_strp) {
+      DIELabel *L = cast<DIELabel>(Values[i]);
+      Asm->EmitSectionOffset(L->getValue(), DwarfStrSectionSym);
+      continue;
+    }
+
     switch (Attr) {
     case dwarf::DW_AT_sibling:
       Asm->EmitInt32(Die->getSiblingOffset());
@@ -3707,8 +3728,10 @@ void DwarfDebug::emitDebugStr() {
     // Emit a label for reference from debug information entries.
     Asm->OutStreamer.EmitLabel(Entries[i].second->getValue().first);
 
-    // Emit the string itself.
-    Asm->OutStreamer.EmitBytes(Entries[i].second->getKey(), 0/*addrspace*/);
+    // Emit the string itself with a terminating null byte.
+    Asm->OutStreamer.EmitBytes(StringRef(Entries[i].second->getKeyData(),
+                                         Entries[i].second->getKeyLength()+1),
+                               0/*addrspace*/);
   }
 }
 
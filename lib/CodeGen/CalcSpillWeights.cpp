@@ -13,10 +13,12 @@
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/CodeGen/CalcSpillWeights.h"
 #include "llvm/CodeGen/LiveIntervalAnalysis.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineLoopInfo.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/SlotIndexes.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetInstrInfo.h"
@@ -24,17 +26,25 @@
 #include "llvm/Target/TargetRegisterInfo.h"
 using namespace llvm;
 
+static cl::opt<bool>
+SpillWeightBlockFreq("spill-weight-block-freq", cl::init(false), cl::Hidden,
+           cl::desc("Weigh spill costs by estimated block frequency instead "
+                    "of loop depth"));
+
 char CalculateSpillWeights::ID = 0;
 INITIALIZE_PASS_BEGIN(CalculateSpillWeights, "calcspillweights",
                 "Calculate spill weights", false, false)
 INITIALIZE_PASS_DEPENDENCY(LiveIntervals)
 INITIALIZE_PASS_DEPENDENCY(MachineLoopInfo)
+INITIALIZE_PASS_DEPENDENCY(MachineBlockFrequencyInfo)
 INITIALIZE_PASS_END(CalculateSpillWeights, "calcspillweights",
                 "Calculate spill weights", false, false)
 
 void CalculateSpillWeights::getAnalysisUsage(AnalysisUsage &au) const {
   au.addRequired<LiveIntervals>();
   au.addRequired<MachineLoopInfo>();
+  if (SpillWeightBlockFreq)
+    au.addRequired<MachineBlockFrequencyInfo>();
   au.setPreservesAll();
   MachineFunctionPass::getAnalysisUsage(au);
 }
@@ -46,7 +56,10 @@ bool CalculateSpillWeights::runOnMachineFunction(MachineFunction &fn) {
                << fn.getFunction()->getName() << '\n');
 
   LiveIntervals &lis = getAnalysis<LiveIntervals>();
-  VirtRegAuxInfo vrai(fn, lis, getAnalysis<MachineLoopInfo>());
+  const MachineBlockFrequencyInfo *mbfi = 0;
+  if (SpillWeightBlockFreq)
+    mbfi = &getAnalysis<MachineBlockFrequencyInfo>();
+  VirtRegAuxInfo vrai(fn, lis, getAnalysis<MachineLoopInfo>(), mbfi);
   for (LiveIntervals::iterator I = lis.begin(), E = lis.end(); I != E; ++I) {
     LiveInterval &li = *I->second;
     if (TargetRegisterInfo::isVirtualRegister(li.reg))
@@ -92,6 +105,7 @@ void VirtRegAuxInfo::CalculateWeightAndHint(LiveInterval &li) {
   MachineBasicBlock *mbb = 0;
   MachineLoop *loop = 0;
   unsigned loopDepth = 0;
+  float blockFreq = 0;
   bool isExiting = false;
   float totalWeight = 0;
   SmallPtrSet<MachineInstr*, 8> visited;
@@ -116,12 +130,16 @@ void VirtRegAuxInfo::CalculateWeightAndHint(LiveInterval &li) {
       loop = loops_.getLoopFor(mbb);
       loopDepth = loop ? loop->getLoopDepth() : 0;
       isExiting = loop ? loop->isLoopExiting(mbb) : false;
+      if (mbfi_)
+        blockFreq = (float)mbfi_->getBlockFreq(mbb).getFrequency() /
+                    mbfi_->getEntryFreq();
     }
 
     // Calculate instr weight.
     bool reads, writes;
     tie(reads, writes) = mi->readsWritesVirtualRegister(li.reg);
-    float weight = LiveIntervals::getSpillWeight(writes, reads, loopDepth);
+    float weight = mbfi_ ? (writes + reads) * blockFreq :
+                   LiveIntervals::getSpillWeight(writes, reads, loopDepth);
 
     // Give extra weight to what looks like a loop induction variable update.
     if (writes && isExiting && lis_.isLiveOutOfMBB(li, mbb))
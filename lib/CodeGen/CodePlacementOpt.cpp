@@ -8,17 +8,20 @@
 //===----------------------------------------------------------------------===//
 //
 // This file implements the pass that optimize code placement and align loop
-// headers to target specific alignment boundary.
+// headers to target specific alignment boundary.  With -enable-hot-fallthroughs
+// it also uses branch probabilities to make hot edges fall through.
 //
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "code-placement"
+#include "llvm/CodeGen/MachineBranchProbabilityInfo.h"
 #include "llvm/CodeGen/MachineLoopInfo.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/Target/TargetInstrInfo.h"
 #include "llvm/Target/TargetLowering.h"
 #include "llvm/Target/TargetMachine.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/ADT/Statistic.h"
@@ -27,10 +30,16 @@ using namespace llvm;
 STATISTIC(NumLoopsAligned,  "Number of loops aligned");
 STATISTIC(NumIntraElim,     "Number of intra loop branches eliminated");
 STATISTIC(NumIntraMoved,    "Number of intra loop branches moved");
+STATISTIC(NumHotMoved,      "Number of hot successors moved to fall through");
+
+static cl::opt<bool>
+EnableHotFallthroughs("enable-hot-fallthroughs", cl::init(false), cl::Hidden,
+        cl::desc("Lay out the hot successor of each block right after it"));
 
 namespace {
   class CodePlacementOpt : public MachineFunctionPass {
     const MachineLoopInfo *MLI;
+    const MachineBranchProbabilityInfo *MBPI;
     const TargetInstrInfo *TII;
     const TargetLowering  *TLI;
 
@@ -45,6 +54,8 @@ namespace {
 
     virtual void getAnalysisUsage(AnalysisUsage &AU) const {
       AU.addRequired<MachineLoopInfo>();
+      if (EnableHotFallthroughs)
+        AU.addRequired<MachineBranchProbabilityInfo>();
       AU.addPreservedID(MachineDominatorsID);
       MachineFunctionPass::getAnalysisUsage(AU);
     }
@@ -62,6 +73,7 @@ namespace {
                                      MachineLoop *L);
     bool OptimizeIntraLoopEdgesInLoopNest(MachineFunction &MF, MachineLoop *L);
     bool OptimizeIntraLoopEdges(MachineFunction &MF);
+    bool OptimizeHotFallthroughs(MachineFunction &MF);
     bool AlignLoops(MachineFunction &MF);
     bool AlignLoop(MachineFunction &MF, MachineLoop *L, unsigned Align);
   };
@@ -372,6 +384,53 @@ bool CodePlacementOpt::OptimizeIntraLoopEdges(MachineFunction &MF) {
   return Changed;
 }
 
+/// OptimizeHotFallthroughs - Move the hot successor of each block right after
+/// it, so the likely path falls through and the unlikely one takes the branch.
+/// Only successors entered from that block alone and in the same loop are
+/// moved; keeping loops contiguous is left to OptimizeIntraLoopEdges.
+///
+bool CodePlacementOpt::OptimizeHotFallthroughs(MachineFunction &MF) {
+  bool Changed = false;
+
+  if (!MBPI || !TLI->shouldOptimizeCodePlacement())
+    return Changed;
+
+  // Move each block at most once, so that unreachable cycles can't make this
+  // loop forever.
+  SmallPtrSet<MachineBasicBlock *, 16> Moved;
+  for (MachineFunction::iterator I = MF.begin(), E = MF.end(); I != E; ++I) {
+    MachineBasicBlock *MBB = I;
+    MachineBasicBlock *Succ = MBPI->getHotSucc(MBB);
+    if (!Succ || Succ == MBB || Succ == MF.begin())
+      continue;
+
+    // Nothing to do if Succ already follows MBB.
+    MachineFunction::iterator Next = llvm::next(I);
+    MachineFunction::iterator SuccI = Succ;
+    if (Next == SuccI)
+      continue;
+
+    if (Succ->pred_size() != 1 || Moved.count(Succ))
+      continue;
+    if (MLI->getLoopFor(Succ) != MLI->getLoopFor(MBB))
+      continue;
+
+    // Verify that all the branches touched by the move can be rewritten.
+    if (!HasAnalyzableTerminator(MBB) || !HasAnalyzableTerminator(Succ) ||
+        !HasAnalyzableTerminator(prior(SuccI)))
+      continue;
+
+    DEBUG(dbgs() << "CGP: Moving hot successor BB#" << Succ->getNumber()
+                 << " after BB#" << MBB->getNumber() << ".\n");
+    Splice(MF, Next, SuccI, llvm::next(SuccI));
+    Moved.insert(Succ);
+    ++NumHotMoved;
+    Changed = true;
+  }
+
+  return Changed;
+}
+
 /// AlignLoops - Align loop headers to target preferred alignments.
 ///
 bool CodePlacementOpt::AlignLoops(MachineFunction &MF) {
@@ -411,13 +470,17 @@ bool CodePlacementOpt::AlignLoop(MachineFunction &MF, MachineLoop *L,
 
 bool CodePlacementOpt::runOnMachineFunction(MachineFunction &MF) {
   MLI = &getAnalysis<MachineLoopInfo>();
-  if (MLI->empty())
-    return false;  // No loops.
-
+  MBPI = EnableHotFallthroughs ? &getAnalysis<MachineBranchProbabilityInfo>()
+                               : 0;
   TLI = MF.getTarget().getTargetLowering();
   TII = MF.getTarget().getInstrInfo();
 
-  bool Changed = OptimizeIntraLoopEdges(MF);
+  bool Changed = OptimizeHotFallthroughs(MF);
+
+  if (MLI->empty())
+    return Changed;  // No loops.
+
+  Changed |= OptimizeIntraLoopEdges(MF);
 
   Changed |= AlignLoops(MF);
 
@@ -101,6 +101,16 @@ EnableFastISelOption("fast-isel", cl::Hidden,
 static cl::opt<bool> EnableSplitGEPGVN("split-gep-gvn", cl::Hidden,
     cl::desc("Split GEPs and run no-load GVN"));
 
+// Enable or disable the experimental loop vectorizer, which uses the target's
+// legal vector types to pick a width.
+static cl::opt<bool> EnableLoopVectorize("vectorize-loops", cl::Hidden,
+    cl::desc("Vectorize innermost loops before loop strength reduction"));
+
+// Enable or disable the SLP vectorizer, which uses the target's legal vector
+// types and operations in its cost model.
+static cl::opt<bool> EnableSLPVectorize("vectorize-slp", cl::Hidden,
+    cl::desc("Vectorize straight-line code before loop strength reduction"));
+
 LLVMTargetMachine::LLVMTargetMachine(const Target &T,
                                      const std::string &Triple)
   : TargetMachine(T), TargetTriple(Triple) {
@@ -265,6 +275,14 @@ bool LLVMTargetMachine::addCommonCodeGenPasses(PassManagerBase &PM,
     PM.add(createGVNPass(/*NoLoads=*/true));
   }
 
+  // The loop vectorizer only handles loops in simplified form.
+  if (OptLevel != CodeGenOpt::None && EnableLoopVectorize) {
+    PM.add(createLoopSimplifyPass());
+    PM.add(createLoopVectorizePass(getTargetLowering()));
+  }
+  if (OptLevel != CodeGenOpt::None && EnableSLPVectorize)
+    PM.add(createSLPVectorizePass(getTargetLowering()));
+
   // Run loop strength reduction before anything else.
   if (OptLevel != CodeGenOpt::None && !DisableLSR) {
     PM.add(createLoopStrengthReducePass(getTargetLowering()));
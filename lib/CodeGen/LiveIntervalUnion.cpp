@@ -0,0 +1,122 @@
+//===-- LiveIntervalUnion.cpp - Union of live intervals -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the LiveIntervalUnion class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "LiveIntervalUnion.h"
+#include "llvm/CodeGen/LiveInterval.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+using namespace llvm;
+
+namespace {
+  /// EndsAfter - Compare a position with the end of a range, for finding the
+  /// first range in a sorted run of disjoint ranges that ends after it.
+  struct EndsAfter {
+    template<typename RangeT>
+    bool operator()(SlotIndex Pos, const RangeT &R) const {
+      return Pos < R.end;
+    }
+  };
+}
+
+/// advancePast - Return the first range in [I, E) that ends after Pos.  The
+/// ranges must be sorted and disjoint, so that their ends are sorted too.
+/// Successive queries usually move a short distance, so probe ahead in steps
+/// of increasing size before falling back to a binary search.
+template<typename IterT>
+static IterT advancePast(IterT I, IterT E, SlotIndex Pos) {
+  if (I == E || Pos < I->end)
+    return I;
+  size_t Step = 1;
+  while (Step < size_t(E - I) && !(Pos < I[Step].end)) {
+    I += Step;
+    Step *= 2;
+  }
+  IterT Hi = Step < size_t(E - I) ? I + Step + 1 : E;
+  return std::upper_bound(I + 1, Hi, Pos, EndsAfter());
+}
+
+void LiveIntervalUnion::unify(const LiveInterval &LI) {
+  if (LI.empty())
+    return;
+
+  // Merge the two sorted lists by start, then coalesce.
+  std::vector<Segment> Merged;
+  Merged.reserve(Segments.size() + LI.ranges.size());
+  std::vector<Segment>::const_iterator SI = Segments.begin(),
+                                       SE = Segments.end();
+  LiveInterval::const_iterator LII = LI.begin(), LIE = LI.end();
+  while (SI != SE || LII != LIE) {
+    SlotIndex Start, End;
+    if (SI != SE && (LII == LIE || SI->start < LII->start)) {
+      Start = SI->start;
+      End = SI->end;
+      ++SI;
+    } else {
+      Start = LII->start;
+      End = LII->end;
+      ++LII;
+    }
+    Segment Next(Start, End);
+    if (!Merged.empty() && !(Merged.back().end < Next.start)) {
+      if (Merged.back().end < Next.end)
+        Merged.back().end = Next.end;
+    } else {
+      Merged.push_back(Next);
+    }
+  }
+  Segments.swap(Merged);
+}
+
+bool LiveIntervalUnion::overlaps(const LiveInterval &LI) const {
+  if (Segments.empty() || LI.empty())
+    return false;
+
+  // Alternately skip each side forward to the first range that ends after the
+  // start of the current range on the other side.  The two ranges then
+  // overlap unless the one skipped to starts after the other ends.
+  const_iterator SI = Segments.begin(), SE = Segments.end();
+  LiveInterval::const_iterator LII = LI.begin(), LIE = LI.end();
+  for (;;) {
+    SI = advancePast(SI, SE, LII->start);
+    if (SI == SE)
+      return false;
+    if (SI->start < LII->end)
+      return true;
+
+    LII = advancePast(LII, LIE, SI->start);
+    if (LII == LIE)
+      return false;
+    if (LII->start < SI->end)
+      return true;
+  }
+}
+
+bool LiveIntervalUnion::overlaps(SlotIndex Start, SlotIndex End) const {
+  assert(Start < End && "Invalid range");
+  const_iterator I = advancePast(begin(), end(), Start);
+  return I != end() && I->start < End;
+}
+
+void LiveIntervalUnion::print(raw_ostream &OS) const {
+  if (Segments.empty()) {
+    OS << "EMPTY";
+    return;
+  }
+  for (const_iterator I = begin(), E = end(); I != E; ++I)
+    OS << '[' << I->start << ',' << I->end << ')';
+}
+
+void LiveIntervalUnion::dump() const {
+  dbgs() << *this << "\n";
+}
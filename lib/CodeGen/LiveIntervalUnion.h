@@ -0,0 +1,79 @@
+//===-- LiveIntervalUnion.h - Union of live intervals -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// LiveIntervalUnion is a compact representation of the live ranges of several
+// intervals that a register allocator checks for interference as a whole, such
+// as the fixed intervals of a physical register and all of its aliases.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_LIVEINTERVALUNION_H
+#define LLVM_CODEGEN_LIVEINTERVALUNION_H
+
+#include "llvm/CodeGen/SlotIndexes.h"
+#include <vector>
+
+namespace llvm {
+
+  class LiveInterval;
+  class raw_ostream;
+
+  /// LiveIntervalUnion - The union of the live ranges of a set of intervals,
+  /// kept as a sorted vector of disjoint segments.  Overlapping and adjacent
+  /// ranges are merged as they are added, so the union is never larger than
+  /// the intervals it was built from and is usually much smaller.
+  ///
+  /// Interference queries skip through the segments with a galloping search,
+  /// so checking an interval against a union takes time logarithmic in the
+  /// size of the union rather than linear.
+  class LiveIntervalUnion {
+  public:
+    /// Segment - A half-open range [start, end) covered by the union.
+    struct Segment {
+      SlotIndex start;
+      SlotIndex end;
+
+      Segment(SlotIndex S, SlotIndex E) : start(S), end(E) {}
+    };
+
+    typedef std::vector<Segment>::const_iterator const_iterator;
+
+    const_iterator begin() const { return Segments.begin(); }
+    const_iterator end() const { return Segments.end(); }
+    bool empty() const { return Segments.empty(); }
+    unsigned size() const { return Segments.size(); }
+
+    /// clear - Remove all segments from the union.
+    void clear() { Segments.clear(); }
+
+    /// unify - Add the live ranges of LI to the union.
+    void unify(const LiveInterval &LI);
+
+    /// overlaps - Return true if any live range of LI overlaps the union.
+    bool overlaps(const LiveInterval &LI) const;
+
+    /// overlaps - Return true if [Start, End) overlaps the union.
+    bool overlaps(SlotIndex Start, SlotIndex End) const;
+
+    void print(raw_ostream &OS) const;
+    void dump() const;
+
+  private:
+    std::vector<Segment> Segments;
+  };
+
+  inline raw_ostream &operator<<(raw_ostream &OS,
+                                 const LiveIntervalUnion &LIU) {
+    LIU.print(OS);
+    return OS;
+  }
+
+} // End llvm namespace
+
+#endif // LLVM_CODEGEN_LIVEINTERVALUNION_H
@@ -0,0 +1,208 @@
+//===- MachineBranchProbabilityInfo.cpp - Machine Branch Probability Info -===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This analysis maps the branch probabilities of the LLVM IR onto the machine
+// CFG.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/BasicBlock.h"
+#include "llvm/Analysis/BranchProbabilityInfo.h"
+#include "llvm/CodeGen/MachineBranchProbabilityInfo.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CFG.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+INITIALIZE_PASS_BEGIN(MachineBranchProbabilityInfo, "machine-branch-prob",
+                      "Machine Branch Probability Analysis", true, true)
+INITIALIZE_PASS_DEPENDENCY(BranchProbabilityInfo)
+INITIALIZE_PASS_DEPENDENCY(MachineLoopInfo)
+INITIALIZE_PASS_END(MachineBranchProbabilityInfo, "machine-branch-prob",
+                    "Machine Branch Probability Analysis", true, true)
+
+char MachineBranchProbabilityInfo::ID = 0;
+
+// Weights used for blocks whose edges have no IR counterpart.  These match
+// the loop branch heuristic of BranchProbabilityInfo.
+static const uint32_t LBH_TAKEN_WEIGHT = 124;
+static const uint32_t LBH_NONTAKEN_WEIGHT = 4;
+
+void MachineBranchProbabilityInfo::
+getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<BranchProbabilityInfo>();
+  AU.addRequired<MachineLoopInfo>();
+  AU.setPreservesAll();
+  MachineFunctionPass::getAnalysisUsage(AU);
+}
+
+/// isIRSuccessor - Return true if Succ is a successor of BB in the IR CFG.
+static bool isIRSuccessor(const BasicBlock *BB, const BasicBlock *Succ) {
+  for (succ_const_iterator I = succ_begin(BB), E = succ_end(BB); I != E; ++I)
+    if (*I == Succ)
+      return true;
+  return false;
+}
+
+bool MachineBranchProbabilityInfo::runOnMachineFunction(MachineFunction &mf) {
+  MF = &mf;
+  Weights.clear();
+  BranchProbabilityInfo &BPI = getAnalysis<BranchProbabilityInfo>();
+  MachineLoopInfo &MLI = getAnalysis<MachineLoopInfo>();
+
+  for (MachineFunction::const_iterator I = mf.begin(), E = mf.end(); I != E;
+       ++I) {
+    const MachineBasicBlock *MBB = I;
+    SmallVector<const MachineBasicBlock *, 4> Succs;
+    SmallPtrSet<const MachineBasicBlock *, 4> Visited;
+    for (MachineBasicBlock::const_succ_iterator SI = MBB->succ_begin(),
+         SE = MBB->succ_end(); SI != SE; ++SI)
+      if (Visited.insert(*SI))
+        Succs.push_back(*SI);
+    if (Succs.size() < 2)
+      continue;
+
+    // Use the IR weights if every edge corresponds to an IR edge.
+    const BasicBlock *BB = MBB->getBasicBlock();
+    bool AllMapped = BB != 0;
+    for (unsigned i = 0, e = Succs.size(); AllMapped && i != e; ++i) {
+      const BasicBlock *SuccBB = Succs[i]->getBasicBlock();
+      AllMapped = SuccBB && isIRSuccessor(BB, SuccBB);
+    }
+    if (AllMapped) {
+      for (unsigned i = 0, e = Succs.size(); i != e; ++i)
+        Weights[std::make_pair(MBB, Succs[i])] =
+          BPI.getEdgeWeight(BB, Succs[i]->getBasicBlock());
+      continue;
+    }
+
+    // Otherwise predict the back edges of a loop as taken and the exits as
+    // not taken.
+    MachineLoop *L = MLI.getLoopFor(MBB);
+    if (!L)
+      continue;
+    for (unsigned i = 0, e = Succs.size(); i != e; ++i) {
+      const MachineBasicBlock *Succ = Succs[i];
+      uint32_t Weight = DEFAULT_WEIGHT;
+      if (Succ == L->getHeader())
+        Weight = LBH_TAKEN_WEIGHT;
+      else if (!L->contains(Succ))
+        Weight = LBH_NONTAKEN_WEIGHT;
+      Weights[std::make_pair(MBB, Succ)] = Weight;
+    }
+  }
+  return false;
+}
+
+void MachineBranchProbabilityInfo::print(raw_ostream &OS,
+                                         const Module *) const {
+  if (!MF)
+    return;
+  OS << "---- Machine Branch Probabilities of " << MF->getFunction()->getName()
+     << " ----\n";
+  for (MachineFunction::const_iterator I = MF->begin(), E = MF->end(); I != E;
+       ++I) {
+    SmallPtrSet<const MachineBasicBlock *, 4> Visited;
+    for (MachineBasicBlock::const_succ_iterator SI = I->succ_begin(),
+         SE = I->succ_end(); SI != SE; ++SI)
+      if (Visited.insert(*SI))
+        printEdgeProbability(OS, I, *SI);
+  }
+}
+
+uint32_t MachineBranchProbabilityInfo::
+getSumForBlock(const MachineBasicBlock *MBB) const {
+  uint32_t Sum = 0;
+  SmallPtrSet<const MachineBasicBlock *, 4> Visited;
+  for (MachineBasicBlock::const_succ_iterator I = MBB->succ_begin(),
+       E = MBB->succ_end(); I != E; ++I) {
+    if (!Visited.insert(*I))
+      continue;
+    uint32_t Weight = getEdgeWeight(MBB, *I);
+    uint32_t PrevSum = Sum;
+
+    Sum += Weight;
+    assert(Sum > PrevSum); (void) PrevSum;
+  }
+
+  return Sum;
+}
+
+uint32_t MachineBranchProbabilityInfo::
+getEdgeWeight(const MachineBasicBlock *Src,
+              const MachineBasicBlock *Dst) const {
+  DenseMap<Edge, uint32_t>::const_iterator I =
+    Weights.find(std::make_pair(Src, Dst));
+  if (I != Weights.end())
+    return I->second;
+  return DEFAULT_WEIGHT;
+}
+
+bool MachineBranchProbabilityInfo::
+isEdgeHot(const MachineBasicBlock *Src, const MachineBasicBlock *Dst) const {
+  // Hot probability is at least 4/5 = 80%
+  return getEdgeProbability(Src, Dst) >= BranchProbability(4, 5);
+}
+
+MachineBasicBlock *
+MachineBranchProbabilityInfo::getHotSucc(MachineBasicBlock *MBB) const {
+  uint32_t Sum = 0;
+  uint32_t MaxWeight = 0;
+  MachineBasicBlock *MaxSucc = 0;
+
+  SmallPtrSet<const MachineBasicBlock *, 4> Visited;
+  for (MachineBasicBlock::const_succ_iterator I = MBB->succ_begin(),
+       E = MBB->succ_end(); I != E; ++I) {
+    MachineBasicBlock *Succ = *I;
+    if (!Visited.insert(Succ))
+      continue;
+    uint32_t Weight = getEdgeWeight(MBB, Succ);
+    uint32_t PrevSum = Sum;
+
+    Sum += Weight;
+    assert(Sum > PrevSum); (void) PrevSum;
+
+    if (Weight > MaxWeight) {
+      MaxWeight = Weight;
+      MaxSucc = Succ;
+    }
+  }
+
+  // Hot probability is at least 4/5 = 80%
+  if (MaxSucc && BranchProbability(MaxWeight, Sum) >= BranchProbability(4, 5))
+    return MaxSucc;
+
+  return 0;
+}
+
+BranchProbability MachineBranchProbabilityInfo::
+getEdgeProbability(const MachineBasicBlock *Src,
+                   const MachineBasicBlock *Dst) const {
+  uint32_t N = getEdgeWeight(Src, Dst);
+  uint32_t D = getSumForBlock(Src);
+
+  return BranchProbability(N, D);
+}
+
+raw_ostream &MachineBranchProbabilityInfo::
+printEdgeProbability(raw_ostream &OS, const MachineBasicBlock *Src,
+                     const MachineBasicBlock *Dst) const {
+
+  const BranchProbability Prob = getEdgeProbability(Src, Dst);
+  OS << "edge BB#" << Src->getNumber() << " -> BB#" << Dst->getNumber()
+     << " probability is " << Prob
+     << (isEdgeHot(Src, Dst) ? " [HOT edge]\n" : "\n");
+
+  return OS;
+}
@@ -72,6 +72,7 @@ MachineFunction::MachineFunction(const Function *F, const TargetMachine &TM,
 MachineFunction::~MachineFunction() {
   BasicBlocks.clear();
   InstructionRecycler.clear(Allocator);
+  OperandRecycler.clear(Allocator);
   BasicBlockRecycler.clear(Allocator);
   if (RegInfo) {
     RegInfo->~MachineRegisterInfo();
@@ -150,7 +151,7 @@ MachineInstr *
 MachineFunction::CreateMachineInstr(const TargetInstrDesc &TID,
                                     DebugLoc DL, bool NoImp) {
   return new (InstructionRecycler.Allocate<MachineInstr>(Allocator))
-    MachineInstr(TID, DL, NoImp);
+    MachineInstr(*this, TID, DL, NoImp);
 }
 
 /// CloneMachineInstr - Create a new MachineInstr which is a copy of the
@@ -167,7 +168,12 @@ MachineFunction::CloneMachineInstr(const MachineInstr *Orig) {
 ///
 void
 MachineFunction::DeleteMachineInstr(MachineInstr *MI) {
+  // The operand array and the MachineInstr itself are recycled separately.
+  MachineOperand *Operands = MI->Operands;
+  OperandCapacity CapOperands = MI->CapOperands;
   MI->~MachineInstr();
+  if (Operands)
+    deallocateOperandArray(CapOperands, Operands);
   InstructionRecycler.Deallocate(Allocator, MI);
 }
 
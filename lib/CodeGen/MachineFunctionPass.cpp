@@ -43,6 +43,8 @@ void MachineFunctionPass::getAnalysisUsage(AnalysisUsage &AU) const {
   // because CodeGen overloads that to mean preserving the MachineBasicBlock
   // CFG in addition to the LLVM IR CFG.
   AU.addPreserved<AliasAnalysis>();
+  AU.addPreserved("branch-prob");
+  AU.addPreserved("block-freq");
   AU.addPreserved("scalar-evolution");
   AU.addPreserved("iv-users");
   AU.addPreserved("memdep");
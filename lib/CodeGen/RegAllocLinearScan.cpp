@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "regalloc"
+#include "LiveIntervalUnion.h"
 #include "VirtRegMap.h"
 #include "VirtRegRewriter.h"
 #include "Spiller.h"
@@ -138,12 +139,23 @@ namespace {
     ///
     IntervalPtrs fixed_;
 
+    /// fixedUnions_ - For each physical register, the union of the fixed
+    /// intervals of the register and all of its aliases.  Checking a
+    /// candidate register against its union avoids walking all of fixed_.
+    std::vector<LiveIntervalUnion> fixedUnions_;
+
     /// active_ - Intervals that are currently being processed, and which have a
     /// live range active for the current point.
     IntervalPtrs active_;
 
     /// inactive_ - Intervals that are currently being processed, but which have
     /// a hold at the current point.
+    ///
+    /// These are still scanned linearly rather than kept in per-register
+    /// unions like the fixed intervals.  Intervals move between active_ and
+    /// inactive_ at nearly every step, which a union that can only grow does
+    /// not support, and every overlapping inactive interval has to be visited
+    /// anyway to add its weight to the spill weights of its register.
     IntervalPtrs inactive_;
 
     typedef std::priority_queue<LiveInterval*,
@@ -220,6 +232,10 @@ namespace {
     ///
     void initIntervalSets();
 
+    /// buildFixedUnions - (Re)compute fixedUnions_ from the intervals in
+    /// fixed_.
+    void buildFixedUnions();
+
     /// processActiveIntervals - expire old intervals and move non-overlapping
     /// ones to the inactive list.
     void processActiveIntervals(SlotIndex CurPoint);
@@ -519,6 +535,7 @@ bool RALinScan::runOnMachineFunction(MachineFunction &fn) {
   finalizeRegUses();
 
   fixed_.clear();
+  fixedUnions_.clear();
   active_.clear();
   inactive_.clear();
   handled_.clear();
@@ -554,6 +571,21 @@ void RALinScan::initIntervalSets()
         unhandled_.push(i->second);
     }
   }
+
+  buildFixedUnions();
+}
+
+/// buildFixedUnions - Compute the union of the fixed intervals that conflict
+/// with each physical register.
+void RALinScan::buildFixedUnions() {
+  fixedUnions_.clear();
+  fixedUnions_.resize(tri_->getNumRegs());
+  for (unsigned i = 0, e = fixed_.size(); i != e; ++i) {
+    LiveInterval *I = fixed_[i].first;
+    fixedUnions_[I->reg].unify(*I);
+    for (const unsigned *AS = tri_->getAliasSet(I->reg); *AS; ++AS)
+      fixedUnions_[*AS].unify(*I);
+  }
 }
 
 void RALinScan::linearScan() {
@@ -1042,32 +1074,10 @@ void RALinScan::assignRegOrStackSlotAtInterval(LiveInterval* cur) {
   unsigned physReg = getFreePhysReg(cur);
   unsigned BestPhysReg = physReg;
   if (physReg) {
-    // We got a register.  However, if it's in the fixed_ list, we might
-    // conflict with it.  Check to see if we conflict with it or any of its
-    // aliases.
-    SmallSet<unsigned, 8> RegAliases;
-    for (const unsigned *AS = tri_->getAliasSet(physReg); *AS; ++AS)
-      RegAliases.insert(*AS);
-
-    bool ConflictsWithFixed = false;
-    for (unsigned i = 0, e = fixed_.size(); i != e; ++i) {
-      IntervalPtr &IP = fixed_[i];
-      if (physReg == IP.first->reg || RegAliases.count(IP.first->reg)) {
-        // Okay, this reg is on the fixed list.  Check to see if we actually
-        // conflict.
-        LiveInterval *I = IP.first;
-        if (I->endIndex() > StartPosition) {
-          LiveInterval::iterator II = I->advanceTo(IP.second, StartPosition);
-          IP.second = II;
-          if (II != I->begin() && II->start > StartPosition)
-            --II;
-          if (cur->overlapsFrom(*I, II)) {
-            ConflictsWithFixed = true;
-            break;
-          }
-        }
-      }
-    }
+    // We got a register.  However, if it or any of its aliases is in the
+    // fixed_ list, we might conflict with it.  The union of those fixed
+    // intervals tells us without looking at the rest of the list.
+    bool ConflictsWithFixed = fixedUnions_[physReg].overlaps(*cur);
 
     // Okay, the register picked by our speculative getFreePhysReg call turned
     // out to be in use.  Actually add all of the conflicting fixed registers to
@@ -1197,6 +1207,7 @@ void RALinScan::assignRegOrStackSlotAtInterval(LiveInterval* cur) {
           if (I->reg == minReg || tri_->isSubRegister(minReg, I->reg))
             IP.second = I->advanceTo(I->begin(), StartPosition);
         }
+        buildFixedUnions();
 
         DowngradedRegs.clear();
         assignRegOrStackSlotAtInterval(cur);
@@ -29,6 +29,7 @@
 #include "llvm/Target/TargetLowering.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/CommandLine.h"
@@ -63,9 +64,14 @@ namespace {
     bool LegalOperations;
     bool LegalTypes;
 
-    // Worklist of all of the nodes that need to be simplified.
+    // Worklist of all of the nodes that need to be simplified.  Nodes that
+    // are removed or moved to the back leave a null entry behind, so that
+    // neither operation has to search the list.
     std::vector<SDNode*> WorkList;
 
+    // WorkListMap - The index of each node's live entry in WorkList.
+    DenseMap<SDNode*, unsigned> WorkListMap;
+
     // AA - Used for DAG load/store alias analysis.
     AliasAnalysis &AA;
 
@@ -87,15 +93,36 @@ namespace {
     /// AddToWorkList - Add to the work list making sure it's instance is at the
     /// the back (next to be processed.)
     void AddToWorkList(SDNode *N) {
-      removeFromWorkList(N);
+      std::pair<DenseMap<SDNode*, unsigned>::iterator, bool> IP =
+        WorkListMap.insert(std::make_pair(N, WorkList.size()));
+      if (!IP.second) {
+        WorkList[IP.first->second] = 0;
+        IP.first->second = WorkList.size();
+      }
       WorkList.push_back(N);
     }
 
-    /// removeFromWorkList - remove all instances of N from the worklist.
+    /// removeFromWorkList - remove N from the worklist, if it is there.
     ///
     void removeFromWorkList(SDNode *N) {
-      WorkList.erase(std::remove(WorkList.begin(), WorkList.end(), N),
-                     WorkList.end());
+      DenseMap<SDNode*, unsigned>::iterator I = WorkListMap.find(N);
+      if (I == WorkListMap.end())
+        return;
+      WorkList[I->second] = 0;
+      WorkListMap.erase(I);
+    }
+
+    /// getNextWorkListEntry - Remove and return the node at the back of the
+    /// worklist, or null if the worklist is empty.
+    SDNode *getNextWorkListEntry() {
+      SDNode *N = 0;
+      while (!N && !WorkList.empty()) {
+        N = WorkList.back();
+        WorkList.pop_back();
+      }
+      if (N)
+        WorkListMap.erase(N);
+      return N;
     }
 
     SDValue CombineTo(SDNode *N, const SDValue *To, unsigned NumTo,
@@ -929,7 +956,7 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
   WorkList.reserve(DAG.allnodes_size());
   for (SelectionDAG::allnodes_iterator I = DAG.allnodes_begin(),
        E = DAG.allnodes_end(); I != E; ++I)
-    WorkList.push_back(I);
+    AddToWorkList(I);
 
   // Create a dummy node (which is not added to allnodes), that adds a reference
   // to the root node, preventing it from being deleted, and tracking any
@@ -942,9 +969,7 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
 
   // while the worklist isn't empty, inspect the node on the end of it and
   // try and combine it.
-  while (!WorkList.empty()) {
-    SDNode *N = WorkList.back();
-    WorkList.pop_back();
+  while (SDNode *N = getNextWorkListEntry()) {
 
     // If N has no uses, it is dead.  Make sure to revisit all N's operands once
     // N is deleted from the DAG, since they too may now be dead or may have a
@@ -1881,6 +1881,49 @@ struct MatchScope {
 
 }
 
+/// getSwitchCaseOffsets - Return the case table of the OPC_SwitchOpcode or
+/// OPC_SwitchType whose cases start at CaseIndex, decoding it the first time
+/// the switch is reached.
+const std::vector<unsigned> &SelectionDAGISel::
+getSwitchCaseOffsets(const unsigned char *MatcherTable, unsigned CaseIndex,
+                     bool IsType) {
+  std::pair<DenseMap<unsigned, std::vector<unsigned> >::iterator, bool> IP =
+    SwitchCaseOffsets.insert(std::make_pair(CaseIndex,
+                                            std::vector<unsigned>()));
+  std::vector<unsigned> &Cases = IP.first->second;
+  if (!IP.second)
+    return Cases;
+
+  unsigned Idx = CaseIndex;
+  while (1) {
+    // Get the size of this case.
+    unsigned CaseSize = MatcherTable[Idx++];
+    if (CaseSize & 128)
+      CaseSize = GetVBR(CaseSize, MatcherTable, Idx);
+    if (CaseSize == 0) break;
+
+    unsigned Key;
+    if (IsType) {
+      MVT::SimpleValueType CaseVT = (MVT::SimpleValueType)MatcherTable[Idx++];
+      if (CaseVT == MVT::iPTR)
+        CaseVT = TLI.getPointerTy().SimpleTy;
+      Key = CaseVT;
+    } else {
+      uint16_t Opc = MatcherTable[Idx++];
+      Opc |= (unsigned short)MatcherTable[Idx++] << 8;
+      Key = Opc;
+    }
+
+    // The first case for a key is the one that a linear scan would execute.
+    if (Key >= Cases.size())
+      Cases.resize(Key+1);
+    if (Cases[Key] == 0)
+      Cases[Key] = Idx;
+    Idx += CaseSize;
+  }
+  return Cases;
+}
+
 SDNode *SelectionDAGISel::
 SelectCodeCommon(SDNode *NodeToMatch, const unsigned char *MatcherTable,
                  unsigned TableSize) {
@@ -2139,27 +2182,12 @@ SelectCodeCommon(SDNode *NodeToMatch, const unsigned char *MatcherTable,
     case OPC_SwitchOpcode: {
       unsigned CurNodeOpcode = N.getOpcode();
       unsigned SwitchStart = MatcherIndex-1; (void)SwitchStart;
-      unsigned CaseSize;
-      while (1) {
-        // Get the size of this case.
-        CaseSize = MatcherTable[MatcherIndex++];
-        if (CaseSize & 128)
-          CaseSize = GetVBR(CaseSize, MatcherTable, MatcherIndex);
-        if (CaseSize == 0) break;
+      const std::vector<unsigned> &Cases =
+        getSwitchCaseOffsets(MatcherTable, MatcherIndex, false);
 
-        uint16_t Opc = MatcherTable[MatcherIndex++];
-        Opc |= (unsigned short)MatcherTable[MatcherIndex++] << 8;
-
-        // If the opcode matches, then we will execute this case.
-        if (CurNodeOpcode == Opc)
-          break;
-      
-        // Otherwise, skip over this case.
-        MatcherIndex += CaseSize;
-      }
-      
       // If no cases matched, bail out.
-      if (CaseSize == 0) break;
+      if (CurNodeOpcode >= Cases.size() || Cases[CurNodeOpcode] == 0) break;
+      MatcherIndex = Cases[CurNodeOpcode];
       
       // Otherwise, execute the case we found.
       DEBUG(errs() << "  OpcodeSwitch from " << SwitchStart
@@ -2170,29 +2198,12 @@ SelectCodeCommon(SDNode *NodeToMatch, const unsigned char *MatcherTable,
     case OPC_SwitchType: {
       MVT::SimpleValueType CurNodeVT = N.getValueType().getSimpleVT().SimpleTy;
       unsigned SwitchStart = MatcherIndex-1; (void)SwitchStart;
-      unsigned CaseSize;
-      while (1) {
-        // Get the size of this case.
-        CaseSize = MatcherTable[MatcherIndex++];
-        if (CaseSize & 128)
-          CaseSize = GetVBR(CaseSize, MatcherTable, MatcherIndex);
-        if (CaseSize == 0) break;
-        
-        MVT::SimpleValueType CaseVT =
-          (MVT::SimpleValueType)MatcherTable[MatcherIndex++];
-        if (CaseVT == MVT::iPTR)
-          CaseVT = TLI.getPointerTy().SimpleTy;
-        
-        // If the VT matches, then we will execute this case.
-        if (CurNodeVT == CaseVT)
-          break;
-        
-        // Otherwise, skip over this case.
-        MatcherIndex += CaseSize;
-      }
-      
+      const std::vector<unsigned> &Cases =
+        getSwitchCaseOffsets(MatcherTable, MatcherIndex, true);
+
       // If no cases matched, bail out.
-      if (CaseSize == 0) break;
+      if (unsigned(CurNodeVT) >= Cases.size() || Cases[CurNodeVT] == 0) break;
+      MatcherIndex = Cases[CurNodeVT];
       
       // Otherwise, execute the case we found.
       DEBUG(errs() << "  TypeSwitch[" << EVT(CurNodeVT).getEVTString()
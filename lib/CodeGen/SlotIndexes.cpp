@@ -11,6 +11,7 @@
 
 #include "llvm/CodeGen/SlotIndexes.h"
 #include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/ManagedStatic.h"
@@ -18,6 +19,9 @@
 
 using namespace llvm;
 
+STATISTIC(NumLocalRenumberings,  "Number of local renumberings");
+STATISTIC(NumGlobalRenumberings, "Number of global renumberings");
+
 
 // Yep - these are thread safe. See the header for details. 
 namespace {
@@ -103,7 +107,7 @@ bool SlotIndexes::runOnMachineFunction(MachineFunction &fn) {
     // Insert an index for the MBB start.
     SlotIndex blockStartIndex(back(), SlotIndex::LOAD);
 
-    index += SlotIndex::NUM;
+    index += EntrySpacing;
 
     for (MachineBasicBlock::iterator miItr = mbb->begin(), miEnd = mbb->end();
          miItr != miEnd; ++miItr) {
@@ -124,7 +128,7 @@ bool SlotIndexes::runOnMachineFunction(MachineFunction &fn) {
       if (Slots == 0)
         Slots = 1;
 
-      index += (Slots + 1) * SlotIndex::NUM;
+      index += (Slots + 1) * EntrySpacing;
     }
 
     // One blank instruction at the end.
@@ -137,6 +141,8 @@ bool SlotIndexes::runOnMachineFunction(MachineFunction &fn) {
     idx2MBBMap.push_back(IdxMBBPair(blockStartIndex, mbb));
   }
 
+  instrCount = functionSize;
+
   // Sort the Idx2MBBMap
   std::sort(idx2MBBMap.begin(), idx2MBBMap.end(), Idx2MBBCompare());
 
@@ -155,6 +161,7 @@ void SlotIndexes::renumberIndexes() {
   // pass during the initial numbering of the function if the new instructions
   // had been present.
 
+  ++NumGlobalRenumberings;
   functionSize = 0;
   unsigned index = 0;
 
@@ -165,7 +172,7 @@ void SlotIndexes::renumberIndexes() {
 
     if (curEntry->getInstr() == 0) {
       // MBB start entry. Just step index by 1.
-      index += SlotIndex::NUM;
+      index += EntrySpacing;
     }
     else {
       ++functionSize;
@@ -173,9 +180,31 @@ void SlotIndexes::renumberIndexes() {
       if (Slots == 0)
         Slots = 1;
 
-      index += (Slots + 1) * SlotIndex::NUM;
+      index += (Slots + 1) * EntrySpacing;
     }
   }
+  instrCount = functionSize;
+}
+
+void SlotIndexes::renumberIndexes(IndexListEntry *curEntry) {
+  assert(curEntry != front() && "Cannot renumber from the first entry.");
+
+  // Give the new entry and those after it the smallest spacing that still
+  // leaves room for one more insertion between any two of them.  A fresh
+  // numbering spaces instructions further apart than that, so this soon
+  // catches up with an entry whose old index is already large enough, and the
+  // rest of the function is left alone.
+  IndexListEntry *startEntry = curEntry->getPrev();
+  unsigned index = startEntry->getIndex();
+  do {
+    index += EntrySpacing;
+    curEntry->setIndex(index);
+    curEntry = curEntry->getNext();
+  } while (curEntry != getTail() && curEntry->getIndex() <= index);
+
+  ++NumLocalRenumberings;
+  DEBUG(dbgs() << "\n*** Renumbered SlotIndexes " << startEntry->getIndex()
+               << '-' << index << " ***\n");
 }
 
 void SlotIndexes::dump() const {
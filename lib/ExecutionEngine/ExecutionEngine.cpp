@@ -56,6 +56,7 @@ ExecutionEngine::ExecutionEngine(Module *M)
   CompilingLazily         = false;
   GVCompilationDisabled   = false;
   SymbolSearchingDisabled = false;
+  CallProfilingEnabled    = false;
   Modules.push_back(M);
   assert(M && "Module is null?");
 }
@@ -128,7 +129,7 @@ Function *ExecutionEngine::FindFunctionNamed(const char *FnName) {
 
 
 void *ExecutionEngineState::RemoveMapping(
-  const MutexGuard &, const GlobalValue *ToUnmap) {
+  const MutexGuard &locked, const GlobalValue *ToUnmap) {
   GlobalAddressMapTy::iterator I = GlobalAddressMap.find(ToUnmap);
   void *OldVal;
   if (I == GlobalAddressMap.end())
@@ -137,11 +138,32 @@ void *ExecutionEngineState::RemoveMapping(
     OldVal = I->second;
     GlobalAddressMap.erase(I);
   }
+  setAvailableAddress(locked, ToUnmap, 0);
 
   GlobalAddressReverseMap.erase(OldVal);
   return OldVal;
 }
 
+void ExecutionEngineState::setAvailableAddress(const MutexGuard &,
+                                               const GlobalValue *GV,
+                                               void *Addr) {
+  sys::ScopedWriter Writer(AvailableAddressLock);
+  if (Addr)
+    AvailableAddressMap[GV] = Addr;
+  else
+    AvailableAddressMap.erase(GV);
+}
+
+void ExecutionEngineState::clearAvailableAddresses(const MutexGuard &) {
+  sys::ScopedWriter Writer(AvailableAddressLock);
+  AvailableAddressMap.clear();
+}
+
+void *ExecutionEngineState::getAvailableAddress(const GlobalValue *GV) {
+  sys::ScopedReader Reader(AvailableAddressLock);
+  return AvailableAddressMap.lookup(GV);
+}
+
 /// addGlobalMapping - Tell the execution engine that the specified global is
 /// at the specified location.  This is used internally as functions are JIT'd
 /// and as global variables are laid out in memory.  It can and should also be
@@ -155,6 +177,7 @@ void ExecutionEngine::addGlobalMapping(const GlobalValue *GV, void *Addr) {
   void *&CurVal = EEState.getGlobalAddressMap(locked)[GV];
   assert((CurVal == 0 || Addr == 0) && "GlobalMapping already established!");
   CurVal = Addr;
+  EEState.setAvailableAddress(locked, GV, Addr);
   
   // If we are using the reverse mapping, add it too
   if (!EEState.getGlobalAddressReverseMap(locked).empty()) {
@@ -172,6 +195,7 @@ void ExecutionEngine::clearAllGlobalMappings() {
   
   EEState.getGlobalAddressMap(locked).clear();
   EEState.getGlobalAddressReverseMap(locked).clear();
+  EEState.clearAvailableAddresses(locked);
 }
 
 /// clearGlobalMappingsFromModule - Clear all global mappings that came from a
@@ -208,6 +232,7 @@ void *ExecutionEngine::updateGlobalMapping(const GlobalValue *GV, void *Addr) {
   if (CurVal && !EEState.getGlobalAddressReverseMap(locked).empty())
     EEState.getGlobalAddressReverseMap(locked).erase(CurVal);
   CurVal = Addr;
+  EEState.setAvailableAddress(locked, GV, Addr);
   
   // If we are using the reverse mapping, add it too
   if (!EEState.getGlobalAddressReverseMap(locked).empty()) {
@@ -223,11 +248,7 @@ void *ExecutionEngine::updateGlobalMapping(const GlobalValue *GV, void *Addr) {
 /// global value if it is has already been codegen'd, otherwise it returns null.
 ///
 void *ExecutionEngine::getPointerToGlobalIfAvailable(const GlobalValue *GV) {
-  MutexGuard locked(lock);
-  
-  ExecutionEngineState::GlobalAddressMapTy::iterator I =
-    EEState.getGlobalAddressMap(locked).find(GV);
-  return I != EEState.getGlobalAddressMap(locked).end() ? I->second : 0;
+  return EEState.getAvailableAddress(GV);
 }
 
 /// getGlobalValueAtAddress - Return the LLVM global value object that starts
@@ -497,6 +518,9 @@ void *ExecutionEngine::getPointerToGlobal(const GlobalValue *GV) {
   if (Function *F = const_cast<Function*>(dyn_cast<Function>(GV)))
     return getPointerToFunction(F);
 
+  if (void *p = EEState.getAvailableAddress(GV))
+    return p;
+
   MutexGuard locked(lock);
   void *p = EEState.getGlobalAddressMap(locked)[GV];
   if (p)
@@ -1121,6 +1145,10 @@ void ExecutionEngineState::AddressMapConfig::onDelete(
   ExecutionEngineState *EES, const GlobalValue *Old) {
   void *OldVal = EES->GlobalAddressMap.lookup(Old);
   EES->GlobalAddressReverseMap.erase(OldVal);
+
+  // The ValueMap holds the ExecutionEngine lock while calling us.
+  sys::ScopedWriter Writer(EES->AvailableAddressLock);
+  EES->AvailableAddressMap.erase(Old);
 }
 
 void ExecutionEngineState::AddressMapConfig::onRAUW(
@@ -12,13 +12,18 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "jit"
 #include "JIT.h"
 #include "llvm/Constants.h"
 #include "llvm/DerivedTypes.h"
 #include "llvm/Function.h"
 #include "llvm/GlobalVariable.h"
 #include "llvm/Instructions.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Metadata.h"
+#include "llvm/Module.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/JITCodeEmitter.h"
 #include "llvm/CodeGen/MachineCodeInfo.h"
 #include "llvm/ExecutionEngine/GenericValue.h"
@@ -26,15 +31,23 @@
 #include "llvm/Target/TargetData.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetJITInfo.h"
+#include "llvm/Target/TargetOptions.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/Support/Debug.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/System/DynamicLibrary.h"
+#include "llvm/System/Host.h"
 #include "llvm/Config/config.h"
+#include <algorithm>
 
 using namespace llvm;
 
+STATISTIC(NumHotFunctions, "Number of functions moved to the hot code region");
+
 #ifdef __APPLE__ 
 // Apple gcc defaults to -fuse-cxa-atexit (i.e. calls __cxa_atexit instead
 // of atexit). It passes the address of linker generated symbol __dso_handle
@@ -227,9 +240,14 @@ ExecutionEngine *JIT::createJIT(Module *M,
   if (!TM || (ErrorStr && ErrorStr->length() > 0)) return 0;
   TM->setCodeModel(CMM);
 
+  // Describe the CPU features requested, for the code cache.
+  std::string CPUFeatures = MArch.str() + " " + MCPU.str();
+  for (unsigned i = 0, e = MAttrs.size(); i != e; ++i)
+    CPUFeatures += " " + MAttrs[i];
+
   // If the target supports JIT code generation, create a the JIT.
   if (TargetJITInfo *TJ = TM->getJITInfo()) {
-    return new JIT(M, *TM, *TJ, JMM, OptLevel, GVsWithCode);
+    return new JIT(M, *TM, *TJ, JMM, OptLevel, GVsWithCode, CPUFeatures);
   } else {
     if (ErrorStr)
       *ErrorStr = "target does not support JIT code generation";
@@ -281,11 +299,29 @@ extern "C" {
 }
 
 JIT::JIT(Module *M, TargetMachine &tm, TargetJITInfo &tji,
-         JITMemoryManager *JMM, CodeGenOpt::Level OptLevel, bool GVsWithCode)
+         JITMemoryManager *JMM, CodeGenOpt::Level OptLevel, bool GVsWithCode,
+         StringRef CPUFeatures)
   : ExecutionEngine(M), TM(tm), TJI(tji), AllocateGVsWithCode(GVsWithCode),
     isAlreadyCodeGenerating(false) {
   setTargetData(TM.getTargetData());
 
+  // Record everything outside the IR that the generated code depends on.  The
+  // host CPU is included because an empty feature string means "autodetect".
+  raw_string_ostream Settings(CodeGenSettings);
+  Settings << M->getTargetTriple() << ' '
+           << TM.getTargetData()->getStringRepresentation()
+           << " cpu=" << sys::getHostCPUName()
+           << " features=" << CPUFeatures
+           << " opt=" << OptLevel
+           << " reloc=" << TM.getRelocationModel()
+           << " cm=" << TM.getCodeModel()
+           << " gvs-with-code=" << GVsWithCode
+           << " options=" << NoFramePointerElim << NoFramePointerElimNonLeaf
+           << UnsafeFPMath << NoInfsFPMath << NoNaNsFPMath << UseSoftFloat
+           << FloatABIType << GuaranteedTailCallOpt << StackAlignment
+           << RealignStack << DisableJumpTables;
+  Settings.flush();
+
   jitstate = new JITState(M);
 
   // Initialize JCE
@@ -645,7 +681,12 @@ void JIT::runJITOnFunctionUnlocked(Function *F, const MutexGuard &locked) {
 
 void JIT::jitTheFunction(Function *F, const MutexGuard &locked) {
   isAlreadyCodeGenerating = true;
-  jitstate->getPM(locked).run(*F);
+  if (isCallProfilingEnabled() && !CallCounters.count(F))
+    insertCallCounter(F);
+
+  // Reuse the code emitted for this function by an earlier run if possible.
+  if (!loadCachedFunction(F))
+    jitstate->getPM(locked).run(*F);
   isAlreadyCodeGenerating = false;
 
   // clear basic block addresses after this function is done
@@ -779,6 +820,179 @@ void *JIT::recompileAndRelinkFunction(Function *F) {
   return Addr;
 }
 
+/// getCallCounterAddress - Return the address of Counter as a constant i64*.
+static Constant *getCallCounterAddress(Function *F, uint64_t *Counter,
+                                       const TargetData *TD) {
+  LLVMContext &Context = F->getContext();
+  Constant *Addr = ConstantInt::get(TD->getIntPtrType(Context),
+                                    (uintptr_t)Counter);
+  return ConstantExpr::getIntToPtr(Addr, Type::getInt64PtrTy(Context));
+}
+
+/// getCallCounterMDKind - Return the kind of the metadata that marks the
+/// instructions insertCallCounter adds, so that removeCallCounter can find
+/// them again.
+static unsigned getCallCounterMDKind(LLVMContext &Context) {
+  return Context.getMDKindID("jit.callcount");
+}
+
+static void incrementCallCounter(Constant *Addr, Instruction *InsertBefore) {
+  LLVMContext &Context = InsertBefore->getContext();
+  unsigned Kind = getCallCounterMDKind(Context);
+  MDNode *Tag = MDNode::get(Context, 0, 0);
+
+  Instruction *Load = new LoadInst(Addr, "jit.count", InsertBefore);
+  Instruction *Inc =
+    BinaryOperator::CreateAdd(Load, ConstantInt::get(Load->getType(), 1),
+                              "jit.count.inc", InsertBefore);
+  Instruction *Store = new StoreInst(Inc, Addr, InsertBefore);
+  Load->setMetadata(Kind, Tag);
+  Inc->setMetadata(Kind, Tag);
+  Store->setMetadata(Kind, Tag);
+}
+
+/// insertCallCounter - Give F a new counter, incremented on entry to F and
+/// whenever F branches backwards.  A branch counts as backwards if its target
+/// does not come after the branch in the function's block order, which
+/// catches every loop latch without having to compute loop information.
+///
+/// The increments are added to F's IR, tagged with !jit.callcount metadata,
+/// and stay there until removeCallCounter takes them out again.  They are a
+/// plain load, add and store, so increments made by several threads at once
+/// can be lost; the counts only have to be good enough to rank functions.
+///
+void JIT::insertCallCounter(Function *F) {
+  uint64_t *Counter = CallCounterAllocator.Allocate<uint64_t>();
+  *Counter = 0;
+  CallCounters[F] = Counter;
+  Constant *Addr = getCallCounterAddress(F, Counter, getTargetData());
+
+  DenseMap<const BasicBlock*, unsigned> BlockNumbers;
+  unsigned NextNumber = 0;
+  for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+    BlockNumbers[BB] = NextNumber++;
+
+  SmallVector<TerminatorInst*, 8> BackwardBranches;
+  for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
+    TerminatorInst *TI = BB->getTerminator();
+    for (unsigned i = 0, e = TI->getNumSuccessors(); i != e; ++i)
+      if (BlockNumbers[TI->getSuccessor(i)] <= BlockNumbers[BB]) {
+        BackwardBranches.push_back(TI);
+        break;
+      }
+  }
+
+  // Count the call after the entry block's allocas, so that they stay
+  // together at the start of the function.
+  BasicBlock::iterator IP = F->getEntryBlock().begin();
+  while (isa<AllocaInst>(IP))
+    ++IP;
+  incrementCallCounter(Addr, IP);
+  for (unsigned i = 0, e = BackwardBranches.size(); i != e; ++i)
+    incrementCallCounter(Addr, BackwardBranches[i]);
+}
+
+/// removeCallCounter - Remove the increments that insertCallCounter added to
+/// F, which are the instructions tagged with !jit.callcount.
+///
+void JIT::removeCallCounter(Function *F) {
+  unsigned Kind = getCallCounterMDKind(F->getContext());
+
+  SmallVector<Instruction*, 16> Tagged;
+  for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+    for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE; ++I)
+      if (I->getMetadata(Kind))
+        Tagged.push_back(I);
+
+  // Each store comes after the add it stores, which comes after its load, so
+  // erasing in reverse order removes every user before its operand.
+  while (!Tagged.empty()) {
+    Instruction *I = Tagged.pop_back_val();
+    assert(I->use_empty() && "Call counter used outside its increment!");
+    I->eraseFromParent();
+  }
+}
+
+namespace {
+  /// HotterFunction - Orders functions by decreasing call count, and then by
+  /// name so that the layout does not depend on where the IR was allocated.
+  struct HotterFunction {
+    bool operator()(const std::pair<uint64_t, Function*> &LHS,
+                    const std::pair<uint64_t, Function*> &RHS) const {
+      if (LHS.first != RHS.first)
+        return LHS.first > RHS.first;
+      return LHS.second->getName() < RHS.second->getName();
+    }
+  };
+}
+
+/// addCalleesFirst - Append F to Order after the functions in Hot that it
+/// calls directly, so that when they are recompiled in that order most calls
+/// between hot functions go straight to the new code.
+static void addCalleesFirst(Function *F, const SmallPtrSet<Function*, 32> &Hot,
+                            SmallPtrSet<Function*, 32> &Visited,
+                            std::vector<Function*> &Order) {
+  if (!Visited.insert(F))
+    return;
+  for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+    for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE; ++I) {
+      CallSite CS(I);
+      if (!CS)
+        continue;
+      Function *Callee = CS.getCalledFunction();
+      if (Callee && Hot.count(Callee))
+        addCalleesFirst(Callee, Hot, Visited, Order);
+    }
+  Order.push_back(F);
+}
+
+/// relayoutHotFunctions - Recompile the MaxFunctions compiled functions with
+/// the highest call counts into the hot code region of the memory manager,
+/// without their counters.  As in recompileAndRelinkFunction, the entry of
+/// the old copy of each function is overwritten with a branch to the new one,
+/// and its lazy stub, if any, is pointed at the new copy.
+///
+unsigned JIT::relayoutHotFunctions(unsigned MaxFunctions) {
+  MutexGuard locked(lock);
+
+  std::vector<std::pair<uint64_t, Function*> > Ranked;
+  for (CallCounterMapTy::iterator I = CallCounters.begin(),
+       E = CallCounters.end(); I != E; ++I) {
+    Function *F = const_cast<Function*>(I->first);
+    if (I->second && *I->second && getPointerToGlobalIfAvailable(F))
+      Ranked.push_back(std::make_pair(*I->second, F));
+  }
+  std::sort(Ranked.begin(), Ranked.end(), HotterFunction());
+  if (Ranked.size() > MaxFunctions)
+    Ranked.resize(MaxFunctions);
+
+  SmallPtrSet<Function*, 32> Hot;
+  for (unsigned i = 0, e = Ranked.size(); i != e; ++i)
+    Hot.insert(Ranked[i].second);
+  SmallPtrSet<Function*, 32> Visited;
+  std::vector<Function*> Order;
+  for (unsigned i = 0, e = Ranked.size(); i != e; ++i)
+    addCalleesFirst(Ranked[i].second, Hot, Visited, Order);
+
+  setEmittingHotCode(true);
+  for (unsigned i = 0, e = Order.size(); i != e; ++i) {
+    Function *F = Order[i];
+    removeCallCounter(F);
+    CallCounters[F] = 0;
+
+    void *OldAddr = getPointerToGlobalIfAvailable(F);
+    addGlobalMapping(F, 0);
+    runJITOnFunctionUnlocked(F, locked);
+    relinkRecompiledFunction(F, OldAddr);
+    DEBUG(dbgs() << "JIT: Moved " << F->getName() << " to the hot region at ["
+                 << getPointerToGlobalIfAvailable(F) << "]\n");
+  }
+  setEmittingHotCode(false);
+
+  NumHotFunctions += Order.size();
+  return Order.size();
+}
+
 /// getMemoryForGV - This method abstracts memory allocation of global
 /// variable so that the JIT can allocate thread local variables depending
 /// on the target.
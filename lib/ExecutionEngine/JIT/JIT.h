@@ -16,6 +16,7 @@
 
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/PassManager.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/ValueHandle.h"
 
 namespace llvm {
@@ -54,6 +55,7 @@ class JIT : public ExecutionEngine {
   /// types
   typedef ValueMap<const BasicBlock *, void *>
       BasicBlockAddressMapTy;
+  typedef ValueMap<const Function *, uint64_t *> CallCounterMapTy;
   /// data
   TargetMachine &TM;       // The current target we are compiling to
   TargetJITInfo &TJI;      // The JITInfo for the target we are compiling to
@@ -76,10 +78,22 @@ class JIT : public ExecutionEngine {
   /// taken.
   BasicBlockAddressMapTy BasicBlockAddressMap;
 
+  /// CodeGenSettings - A description of the target, CPU features and code
+  /// generator options the JIT compiles with.  Code cached on disk is only
+  /// reused by a JIT with the same settings.
+  std::string CodeGenSettings;
+
+  /// CallCounters - The counter of calls and loop iterations of each function
+  /// compiled while call profiling was enabled.  Functions that have been
+  /// moved to the hot code region map to null.  The counters themselves live
+  /// in CallCounterAllocator, since the code keeps using them until the JIT
+  /// is destroyed.
+  CallCounterMapTy CallCounters;
+  BumpPtrAllocator CallCounterAllocator;
 
   JIT(Module *M, TargetMachine &tm, TargetJITInfo &tji,
       JITMemoryManager *JMM, CodeGenOpt::Level OptLevel,
-      bool AllocateGVsWithCode);
+      bool AllocateGVsWithCode, StringRef CPUFeatures);
 public:
   ~JIT();
 
@@ -166,6 +180,16 @@ public:
   ///
   void *recompileAndRelinkFunction(Function *F);
 
+  /// relayoutHotFunctions - Recompile the most frequently run of the functions
+  /// with call counters into the hot code region of the memory manager.
+  ///
+  unsigned relayoutHotFunctions(unsigned MaxFunctions);
+
+  /// setCodeCacheDirectory - Save compiled code in Dir and reuse the code
+  /// saved there.  See ExecutionEngine::setCodeCacheDirectory.
+  ///
+  bool setCodeCacheDirectory(StringRef Dir);
+
   /// freeMachineCodeForFunction - deallocate memory used to code-generate this
   /// Function.
   ///
@@ -177,6 +201,10 @@ public:
   ///
   void addPendingFunction(Function *F);
 
+  /// getCodeGenSettings - Return a description of the target and code
+  /// generator options, for use in the keys of the on-disk code cache.
+  const std::string &getCodeGenSettings() const { return CodeGenSettings; }
+
   /// getCodeEmitter - Return the code emitter this JIT is emitting into.
   ///
   JITCodeEmitter *getCodeEmitter() const { return JCE; }
@@ -224,6 +252,11 @@ private:
   void runJITOnFunctionUnlocked(Function *F, const MutexGuard &locked);
   void updateFunctionStub(Function *F);
   void jitTheFunction(Function *F, const MutexGuard &locked);
+  bool loadCachedFunction(Function *F);
+  void insertCallCounter(Function *F);
+  void removeCallCounter(Function *F);
+  void setEmittingHotCode(bool Hot);
+  void relinkRecompiledFunction(Function *F, void *OldAddr);
 
 protected:
 
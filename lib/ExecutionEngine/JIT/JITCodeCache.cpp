@@ -0,0 +1,277 @@
+//===-- JITCodeCache.cpp - On-disk cache of JIT-compiled code -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the JITCodeCache object, which saves the machine code
+// of JIT-compiled functions to disk and reads it back in a later run.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "jit"
+#include "JITCodeCache.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Function.h"
+#include "llvm/Module.h"
+#include "llvm/TypeSymbolTable.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Config/config.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/InstIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/System/Path.h"
+#include <cstring>
+using namespace llvm;
+
+/// Bump CodeCacheVersion whenever the file format changes, so that files
+/// written by an older JIT are treated as misses.
+static const char CodeCacheMagic[8] = { 'L','L','V','M','J','I','T','C' };
+static const uint32_t CodeCacheVersion = 1;
+
+//===----------------------------------------------------------------------===//
+// Cache keys
+//===----------------------------------------------------------------------===//
+
+/// describeGlobal - Print the properties of a global referenced by a cached
+/// function that can affect the code generated for the reference.
+static void describeGlobal(const GlobalValue *GV, raw_ostream &OS) {
+  // Functions are described by their signature rather than printed, so that
+  // changing the body of a callee does not invalidate its callers.
+  if (const Function *Callee = dyn_cast<Function>(GV)) {
+    OS << "function " << Callee->getName() << ' ' << Callee->getLinkage()
+       << ' ' << Callee->getVisibility() << ' ' << Callee->getCallingConv()
+       << ' ' << Callee->isDeclaration() << ' ';
+    Callee->getType()->print(OS);
+    OS << '\n';
+    return;
+  }
+
+  // Global variables are printed with their initializer, since constant
+  // initializers may be folded into the code.
+  GV->print(OS);
+  OS << '\n';
+}
+
+void JITCodeCache::computeKey(const Function *F, StringRef Settings,
+                              std::string &Key) {
+  raw_string_ostream OS(Key);
+  OS << "LLVM " << PACKAGE_VERSION << '\n' << Settings << '\n';
+
+  // Named types are printed by name in the IR, so record their structure.
+  const TypeSymbolTable &TST = F->getParent()->getTypeSymbolTable();
+  for (TypeSymbolTable::const_iterator I = TST.begin(), E = TST.end();
+       I != E; ++I)
+    OS << "type " << I->first << " = " << I->second->getDescription() << '\n';
+
+  // Describe every global the function refers to, directly or through a
+  // constant expression.
+  SmallPtrSet<const Value*, 32> Visited;
+  SmallVector<const Value*, 32> Worklist;
+  for (const_inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I)
+    for (User::const_op_iterator OI = I->op_begin(), OE = I->op_end();
+         OI != OE; ++OI)
+      if (isa<Constant>(*OI))
+        Worklist.push_back(*OI);
+
+  while (!Worklist.empty()) {
+    const Value *V = Worklist.pop_back_val();
+    if (!Visited.insert(V))
+      continue;
+
+    if (const GlobalValue *GV = dyn_cast<GlobalValue>(V)) {
+      describeGlobal(GV, OS);
+      continue;
+    }
+
+    const Constant *C = cast<Constant>(V);
+    for (User::const_op_iterator OI = C->op_begin(), OE = C->op_end();
+         OI != OE; ++OI)
+      Worklist.push_back(*OI);
+  }
+
+  F->print(OS);
+  OS.flush();
+}
+
+//===----------------------------------------------------------------------===//
+// Cache files
+//===----------------------------------------------------------------------===//
+
+namespace {
+  /// CacheFileReader - Reads the fields of a cache file, remembering whether
+  /// it ran off the end of the buffer.
+  class CacheFileReader {
+    const char *Ptr, *End;
+    bool Failed;
+  public:
+    CacheFileReader(const char *Start, const char *End)
+      : Ptr(Start), End(End), Failed(false) {}
+
+    bool hasFailed() const { return Failed; }
+
+    StringRef readBytes(uint64_t Size) {
+      if (Failed || uint64_t(End - Ptr) < Size) {
+        Failed = true;
+        return StringRef();
+      }
+      StringRef Result(Ptr, Size);
+      Ptr += Size;
+      return Result;
+    }
+
+    uint64_t readU64() {
+      uint64_t V = 0;
+      StringRef Bytes = readBytes(sizeof(V));
+      if (!Failed)
+        memcpy(&V, Bytes.data(), sizeof(V));
+      return V;
+    }
+
+    uint32_t readU32() {
+      uint32_t V = 0;
+      StringRef Bytes = readBytes(sizeof(V));
+      if (!Failed)
+        memcpy(&V, Bytes.data(), sizeof(V));
+      return V;
+    }
+
+    StringRef readString() {
+      return readBytes(readU64());
+    }
+  };
+}
+
+static void writeU64(raw_ostream &OS, uint64_t V) {
+  OS.write((const char*)&V, sizeof(V));
+}
+
+static void writeU32(raw_ostream &OS, uint32_t V) {
+  OS.write((const char*)&V, sizeof(V));
+}
+
+static void writeString(raw_ostream &OS, StringRef S) {
+  writeU64(OS, S.size());
+  OS << S;
+}
+
+std::string JITCodeCache::getPathForKey(const std::string &Key) const {
+  // Name the file after a 64-bit FNV-1a hash of the key.  Collisions only
+  // cost a miss, since the full key is checked on lookup.
+  uint64_t Hash = 14695981039346656037ULL;
+  for (unsigned i = 0, e = Key.size(); i != e; ++i) {
+    Hash ^= (unsigned char)Key[i];
+    Hash *= 1099511628211ULL;
+  }
+
+  sys::Path P(Dir);
+  P.appendComponent(utohexstr(Hash) + ".jitcache");
+  return P.str();
+}
+
+bool JITCodeCache::lookup(const std::string &Key, Entry &E) const {
+  OwningPtr<MemoryBuffer> Buffer(MemoryBuffer::getFile(getPathForKey(Key)));
+  if (!Buffer)
+    return false;
+
+  CacheFileReader R(Buffer->getBufferStart(), Buffer->getBufferEnd());
+  if (R.readBytes(sizeof(CodeCacheMagic)) !=
+        StringRef(CodeCacheMagic, sizeof(CodeCacheMagic)) ||
+      R.readU32() != CodeCacheVersion ||
+      R.readString() != Key)
+    return false;
+
+  E.Skew = R.readU32();
+  E.CodeOffset = R.readU64();
+  E.CodeSize = R.readU64();
+  StringRef Image = R.readString();
+  E.Image.assign(Image.begin(), Image.end());
+  if (R.hasFailed() || E.Skew >= MaxAlignment ||
+      E.CodeOffset + E.CodeSize > E.Image.size())
+    return false;
+
+  uint64_t NumRelocations = R.readU64();
+  if (NumRelocations > Image.size())
+    return false;
+  E.Relocations.resize(NumRelocations);
+  for (unsigned i = 0, e = NumRelocations; i != e; ++i) {
+    Relocation &Rel = E.Relocations[i];
+    Rel.Offset = R.readU64();
+    Rel.Type = R.readU32();
+    Rel.ConstantVal = R.readU64();
+    unsigned Kind = R.readU32();
+    Rel.Kind = Relocation::TargetKind(Kind);
+    Rel.MayNeedFarStub = R.readU32() != 0;
+    Rel.Symbol = R.readString();
+    Rel.TargetOffset = R.readU64();
+    if (R.hasFailed() || Kind > Relocation::ImageOffset ||
+        Rel.Offset >= E.Image.size() ||
+        (Kind == Relocation::ImageOffset && Rel.TargetOffset > E.Image.size()))
+      return false;
+  }
+  return true;
+}
+
+void JITCodeCache::store(const std::string &Key, const Entry &E) const {
+  std::string ErrMsg;
+  if (sys::Path(Dir).createDirectoryOnDisk(true, &ErrMsg)) {
+    DEBUG(dbgs() << "JIT: Cannot create code cache: " << ErrMsg << "\n");
+    return;
+  }
+
+  // Write the entry to a temporary file and rename it into place, so that a
+  // process reading the cache concurrently never sees a partial entry.
+  std::string Path = getPathForKey(Key);
+  sys::Path TmpPath(Path + ".tmp");
+  {
+    raw_fd_ostream OS(TmpPath.c_str(), ErrMsg, raw_fd_ostream::F_Binary);
+    if (!ErrMsg.empty()) {
+      DEBUG(dbgs() << "JIT: Cannot write code cache: " << ErrMsg << "\n");
+      return;
+    }
+
+    OS.write(CodeCacheMagic, sizeof(CodeCacheMagic));
+    writeU32(OS, CodeCacheVersion);
+    writeString(OS, Key);
+    writeU32(OS, E.Skew);
+    writeU64(OS, E.CodeOffset);
+    writeU64(OS, E.CodeSize);
+    // An empty image has no first element to take the address of.
+    writeString(OS, E.Image.empty() ? StringRef() :
+                StringRef((const char*)&E.Image[0], E.Image.size()));
+    writeU64(OS, E.Relocations.size());
+    for (unsigned i = 0, e = E.Relocations.size(); i != e; ++i) {
+      const Relocation &Rel = E.Relocations[i];
+      writeU64(OS, Rel.Offset);
+      writeU32(OS, Rel.Type);
+      writeU64(OS, Rel.ConstantVal);
+      writeU32(OS, Rel.Kind);
+      writeU32(OS, Rel.MayNeedFarStub);
+      writeString(OS, Rel.Symbol);
+      writeU64(OS, Rel.TargetOffset);
+    }
+
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      TmpPath.eraseFromDisk();
+      return;
+    }
+  }
+
+  if (TmpPath.renamePathOnDisk(sys::Path(Path), &ErrMsg)) {
+    DEBUG(dbgs() << "JIT: Cannot write code cache: " << ErrMsg << "\n");
+    TmpPath.eraseFromDisk();
+  }
+}
+
+void JITCodeCache::invalidate(const std::string &Key) const {
+  sys::Path(getPathForKey(Key)).eraseFromDisk();
+}
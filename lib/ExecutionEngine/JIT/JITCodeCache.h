@@ -0,0 +1,98 @@
+//===-- JITCodeCache.h - On-disk cache of JIT-compiled code -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a JITCodeCache object that is used by the JIT to save the
+// machine code of each function it compiles to a directory, so that a later
+// run of the same program can reload the code instead of running codegen.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTION_ENGINE_JIT_CODECACHE_H
+#define LLVM_EXECUTION_ENGINE_JIT_CODECACHE_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/System/DataTypes.h"
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class Function;
+
+/// JITCodeCache - A directory of cache files, one per function, each holding
+/// the function's machine code before relocation together with a description
+/// of its relocations that does not depend on the process which emitted it.
+///
+/// Entries are keyed by the text of the function's IR, the declarations it
+/// refers to, and a description of the target and code generator settings.
+/// The whole key is stored in the file and compared on lookup, so an entry is
+/// only ever reused for exactly the same input; anything else is a miss and
+/// the entry is replaced once the function has been compiled again.
+class JITCodeCache {
+public:
+  /// MaxAlignment - The largest alignment the code or constant pool of a
+  /// cached function may require.  A reloaded function is placed at the same
+  /// address modulo this value as when it was emitted.
+  static const unsigned MaxAlignment = 64;
+
+  /// Relocation - A relocation in a cached function.
+  struct Relocation {
+    enum TargetKind {
+      GlobalValue,     // The global named Symbol.
+      IndirectSymbol,  // An indirect symbol for the global named Symbol.
+      ExternalSymbol,  // The external function named Symbol.
+      ImageOffset      // Offset TargetOffset in the function's own image.
+    };
+
+    uint64_t Offset;         // Offset of the fixup from the start of the image.
+    unsigned Type;           // Target-specific relocation type.
+    int64_t ConstantVal;     // Target-specific addend.
+    TargetKind Kind;
+    bool MayNeedFarStub;
+    std::string Symbol;
+    uint64_t TargetOffset;
+  };
+
+  /// Entry - The cached code of one function.  The image covers the whole
+  /// function allocation up to the end of the code, including the constant
+  /// pool that precedes it.
+  struct Entry {
+    unsigned Skew;           // Image start address modulo MaxAlignment.
+    uint64_t CodeOffset;     // Where the function's code starts in the image.
+    uint64_t CodeSize;
+    std::vector<uint8_t> Image;
+    std::vector<Relocation> Relocations;
+  };
+
+  explicit JITCodeCache(StringRef Dir) : Dir(Dir) {}
+
+  /// computeKey - Describe everything the machine code of F depends on.
+  /// Settings describes the target and the code generator options.
+  static void computeKey(const Function *F, StringRef Settings,
+                         std::string &Key);
+
+  /// lookup - Read the entry for Key into E.  Returns false if there is no
+  /// entry, or if it is unreadable or was made for a different key.
+  bool lookup(const std::string &Key, Entry &E) const;
+
+  /// store - Save E as the entry for Key, replacing any existing entry.
+  void store(const std::string &Key, const Entry &E) const;
+
+  /// invalidate - Remove the entry for Key, if there is one.
+  void invalidate(const std::string &Key) const;
+
+private:
+  std::string getPathForKey(const std::string &Key) const;
+
+  std::string Dir;
+};
+
+} // End llvm namespace
+
+#endif // LLVM_EXECUTION_ENGINE_JIT_CODECACHE_H
@@ -14,6 +14,7 @@
 
 #define DEBUG_TYPE "jit"
 #include "JIT.h"
+#include "JITCodeCache.h"
 #include "JITDebugRegisterer.h"
 #include "JITDwarfEmitter.h"
 #include "llvm/ADT/OwningPtr.h"
@@ -36,8 +37,11 @@
 #include "llvm/Target/TargetJITInfo.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/InstIterator.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MutexGuard.h"
 #include "llvm/Support/ValueHandle.h"
@@ -58,6 +62,16 @@ using namespace llvm;
 STATISTIC(NumBytes, "Number of bytes of machine code compiled");
 STATISTIC(NumRelos, "Number of relocations applied");
 STATISTIC(NumRetries, "Number of retries with more memory");
+STATISTIC(NumCacheHits, "Number of functions loaded from the code cache");
+STATISTIC(NumCacheMisses, "Number of functions not found in the code cache");
+STATISTIC(NumCacheStores, "Number of functions saved to the code cache");
+STATISTIC(NumUncacheable, "Number of functions that could not be cached");
+
+static cl::opt<std::string>
+CodeCacheDir("jit-code-cache-dir",
+             cl::desc("Save JIT-compiled code in this directory and reuse it "
+                      "in later runs"),
+             cl::value_desc("directory"), cl::init(""));
 
 
 // A declaration may stop being a declaration once it's fully read from bitcode.
@@ -112,6 +126,12 @@ namespace {
     /// Instance of the JIT this ResolverState serves.
     JIT *TheJIT;
 
+    /// CallSiteLock - Guards the call site maps and the resolver's GOT map.
+    /// JITCompilerFn takes only this lock, so resolving a stub whose function
+    /// is already compiled does not wait for a compilation holding the JIT
+    /// lock.  Code that needs both must take the JIT lock first.
+    sys::Mutex CallSiteLock;
+
   public:
     JITResolverState(JIT *jit) : FunctionToLazyStubMap(this),
                                  FunctionToCallSitesMap(this),
@@ -128,9 +148,11 @@ namespace {
       return GlobalToIndirectSymMap;
     }
 
+    sys::Mutex &getCallSiteLock() { return CallSiteLock; }
+
     pair<void *, Function *> LookupFunctionFromCallSite(
         const MutexGuard &locked, void *CallSite) const {
-      assert(locked.holds(TheJIT->lock));
+      assert(locked.holds(CallSiteLock));
 
       // The address given to us for the stub may not be exactly right, it might be
       // a little bit after the stub.  As such, use upper_bound to find it.
@@ -143,7 +165,7 @@ namespace {
     }
 
     void AddCallSite(const MutexGuard &locked, void *CallSite, Function *F) {
-      assert(locked.holds(TheJIT->lock));
+      assert(locked.holds(CallSiteLock));
 
       bool Inserted = CallSiteToFunctionMap.insert(
           std::make_pair(CallSite, F)).second;
@@ -326,6 +348,19 @@ namespace {
     /// DR - The debug registerer for the jit.
     OwningPtr<JITDebugRegisterer> DR;
 
+    /// CodeCache - The on-disk cache of emitted functions, if enabled.
+    OwningPtr<JITCodeCache> CodeCache;
+
+    /// CanCacheCode - False if the code this emitter produces cannot be
+    /// cached at all.
+    bool CanCacheCode;
+
+    /// CacheKeyFn, CacheKey - The function being compiled after a code cache
+    /// miss, and its key.  The key has to be computed before codegen, which
+    /// modifies the IR.
+    const Function *CacheKeyFn;
+    std::string CacheKey;
+
     /// LabelLocations - This vector is a mapping from Label ID's to their
     /// address.
     DenseMap<MCSymbol*, uintptr_t> LabelLocations;
@@ -363,8 +398,8 @@ namespace {
 
   public:
     JITEmitter(JIT &jit, JITMemoryManager *JMM, TargetMachine &TM)
-      : SizeEstimate(0), Resolver(jit, *this), MMI(0), CurFn(0),
-        EmittedFunctions(this), TheJIT(&jit) {
+      : SizeEstimate(0), Resolver(jit, *this), CacheKeyFn(0), MMI(0),
+        CurFn(0), EmittedFunctions(this), TheJIT(&jit) {
       MemMgr = JMM ? JMM : JITMemoryManager::CreateDefaultMemManager();
       if (jit.getJITInfo().needsGOT()) {
         MemMgr->AllocateGOT();
@@ -377,6 +412,15 @@ namespace {
       if (JITEmitDebugInfo) {
         DR.reset(new JITDebugRegisterer(TM));
       }
+
+      // Exception tables and debug info are emitted from the MachineFunction,
+      // which a cached function does not have, and GOT and PIC base relative
+      // code cannot be moved to another address.
+      CanCacheCode = !JITExceptionHandling && !JITEmitDebugInfo &&
+                     !jit.getJITInfo().needsGOT() &&
+                     !jit.getJITInfo().hasCustomConstantPool() &&
+                     TM.getRelocationModel() != Reloc::PIC_;
+      setCodeCacheDir(CodeCacheDir);
     }
     ~JITEmitter() {
       delete MemMgr;
@@ -392,6 +436,33 @@ namespace {
     virtual void startFunction(MachineFunction &F);
     virtual bool finishFunction(MachineFunction &F);
 
+    /// loadCachedFunction - If the code cache holds code for F, load and
+    /// relocate it in place of running codegen.  Returns true on success.
+    bool loadCachedFunction(Function *F);
+
+    /// setCodeCacheDir - Use the code cache in Dir from now on, or no cache
+    /// if Dir is empty.  Returns false if the code cannot be cached.
+    bool setCodeCacheDir(StringRef Dir) {
+      CodeCache.reset();
+      CacheKeyFn = 0;
+      if (Dir.empty())
+        return true;
+      if (!CanCacheCode)
+        return false;
+      CodeCache.reset(new JITCodeCache(Dir));
+      return true;
+    }
+
+    /// setEmittingHotCode - Tell the memory manager whether the functions
+    /// emitted from now on belong in its hot code region.
+    void setEmittingHotCode(bool Hot) {
+      MemMgr->setAllocateHotCode(Hot);
+    }
+
+    /// relinkRecompiledFunction - Overwrite the entry of the old code of F
+    /// with a branch to the code just emitted for it.
+    void relinkRecompiledFunction(Function *F, void *OldAddr);
+
     void emitConstantPool(MachineConstantPool *MCP);
     void initJumpTableInfo(MachineJumpTableInfo *MJTI);
     void emitJumpTableInfo(MachineJumpTableInfo *MJTI);
@@ -470,6 +541,9 @@ namespace {
     void *getPointerToGlobal(GlobalValue *GV, void *Reference,
                              bool MayNeedFarStub);
     void *getPointerToGVIndirectSym(GlobalValue *V, void *Reference);
+
+    JITCodeCache::Entry *createCacheEntry(MachineFunction &F, uint8_t *FnStart,
+                                          uint8_t *FnEnd);
   };
 }
 
@@ -478,6 +552,7 @@ void CallSiteValueMapConfig::onDelete(JITResolverState *JRS, Function *F) {
 }
 
 void JITResolverState::EraseAllCallSitesForPrelocked(Function *F) {
+  MutexGuard locked(CallSiteLock);
   FunctionToCallSitesMapTy::iterator F2C = FunctionToCallSitesMap.find(F);
   if (F2C == FunctionToCallSitesMap.end())
     return;
@@ -567,7 +642,8 @@ void *JITResolver::getLazyFunctionStub(Function *F) {
 
     // Finally, keep track of the stub-to-Function mapping so that the
     // JITCompilerFn knows which function to compile!
-    state.AddCallSite(locked, Stub, F);
+    MutexGuard CallSiteLocked(state.getCallSiteLock());
+    state.AddCallSite(CallSiteLocked, Stub, F);
   } else if (!Actual) {
     // If we are JIT'ing non-lazily but need to call a function that does not
     // exist yet, add it to the JIT's work list so that we can fill in the
@@ -617,6 +693,7 @@ void *JITResolver::getExternalFunctionStub(void *FnAddr) {
 }
 
 unsigned JITResolver::getGOTIndexForAddr(void* addr) {
+  MutexGuard locked(state.getCallSiteLock());
   unsigned idx = revGOTMap[addr];
   if (!idx) {
     idx = ++nextGOTIndex;
@@ -640,8 +717,10 @@ void *JITResolver::JITCompilerFn(void *Stub) {
   {
     // Only lock for getting the Function. The call getPointerToFunction made
     // in this function might trigger function materializing, which requires
-    // JIT lock to be unlocked.
-    MutexGuard locked(JR->TheJIT->lock);
+    // JIT lock to be unlocked.  The call site lock is enough here, so a
+    // thread resolving a stub to an already compiled function does not wait
+    // for other threads' compilations.
+    MutexGuard locked(JR->state.getCallSiteLock());
 
     // The address given to us for the stub may not be exactly right, it might
     // be a little bit after the stub.  As such, use upper_bound to find it.
@@ -671,7 +750,7 @@ void *JITResolver::JITCompilerFn(void *Stub) {
   }
 
   // Reacquire the lock to update the GOT map.
-  MutexGuard locked(JR->TheJIT->lock);
+  MutexGuard locked(JR->state.getCallSiteLock());
 
   // We might like to remove the call site from the CallSiteToFunction map, but
   // we can't do that! Multiple threads could be stuck, waiting to acquire the
@@ -830,6 +909,11 @@ bool JITEmitter::finishFunction(MachineFunction &F) {
   // FnEnd is the end of the function's machine code.
   uint8_t *FnEnd = CurBufferPtr;
 
+  // Copy the function for the code cache before it is relocated.
+  OwningPtr<JITCodeCache::Entry> CacheEntry;
+  if (CodeCache && CacheKeyFn == F.getFunction())
+    CacheEntry.reset(createCacheEntry(F, FnStart, FnEnd));
+
   if (!Relocations.empty()) {
     CurFn = F.getFunction();
     NumRelos += Relocations.size();
@@ -914,6 +998,12 @@ bool JITEmitter::finishFunction(MachineFunction &F) {
   BufferBegin = CurBufferPtr = 0;
   NumBytes += FnEnd-FnStart;
 
+  if (CacheEntry) {
+    CodeCache->store(CacheKey, *CacheEntry);
+    ++NumCacheStores;
+  }
+  CacheKeyFn = 0;
+
   // Invalidate the icache if necessary.
   sys::Memory::InvalidateInstructionCache(FnStart, FnEnd-FnStart);
 
@@ -1004,6 +1094,257 @@ bool JITEmitter::finishFunction(MachineFunction &F) {
   return false;
 }
 
+/// referencesGlobal - Return true if C refers to a global value, whose address
+/// would be baked into the constant pool when C is emitted.
+static bool referencesGlobal(const Constant *C) {
+  if (isa<GlobalValue>(C))
+    return true;
+  for (User::const_op_iterator I = C->op_begin(), E = C->op_end(); I != E; ++I)
+    if (referencesGlobal(cast<Constant>(*I)))
+      return true;
+  return false;
+}
+
+/// createCacheEntry - Describe the function that has just been emitted, before
+/// its relocations are applied, so that it can be reloaded at another address.
+/// Returns null if the code depends on its address in a way the code cache
+/// cannot represent.
+JITCodeCache::Entry *JITEmitter::createCacheEntry(MachineFunction &F,
+                                                  uint8_t *FnStart,
+                                                  uint8_t *FnEnd) {
+  const Function *Fn = F.getFunction();
+  const MachineConstantPool *MCP = F.getConstantPool();
+  const MachineJumpTableInfo *MJTI = F.getJumpTableInfo();
+  bool Cacheable = Fn->getAlignment() <= JITCodeCache::MaxAlignment &&
+    MCP->getConstantPoolAlignment() <= JITCodeCache::MaxAlignment &&
+    (!MJTI || MJTI->isEmpty());
+
+  // Some targets resolve constant pool addresses into 32-bit code directly
+  // instead of leaving a relocation (see earlyResolveAddresses).
+  if (!MCP->isEmpty() && TheJIT->getTargetData()->getPointerSize() < 8)
+    Cacheable = false;
+
+  // Jump tables and address-taken blocks hold absolute code addresses.
+  for (MachineFunction::iterator MBB = F.begin(), E = F.end();
+       MBB != E && Cacheable; ++MBB)
+    if (MBB->hasAddressTaken())
+      Cacheable = false;
+
+  const std::vector<MachineConstantPoolEntry> &Constants = MCP->getConstants();
+  for (unsigned i = 0, e = Constants.size(); i != e && Cacheable; ++i)
+    if (Constants[i].isMachineConstantPoolEntry() ||
+        referencesGlobal(Constants[i].Val.ConstVal))
+      Cacheable = false;
+
+  // Calls to constant addresses are emitted relative to the call site.
+  for (const_inst_iterator I = inst_begin(Fn), E = inst_end(Fn);
+       I != E && Cacheable; ++I) {
+    ImmutableCallSite CS(&*I);
+    if (CS && isa<Constant>(CS.getCalledValue()) &&
+        !isa<GlobalValue>(CS.getCalledValue()->stripPointerCasts()))
+      Cacheable = false;
+  }
+
+  if (!Cacheable) {
+    ++NumUncacheable;
+    return 0;
+  }
+
+  OwningPtr<JITCodeCache::Entry> E(new JITCodeCache::Entry());
+  E->Skew = (uintptr_t)BufferBegin & (JITCodeCache::MaxAlignment-1);
+  E->CodeOffset = FnStart - BufferBegin;
+  E->CodeSize = FnEnd - FnStart;
+  E->Image.assign(BufferBegin, FnEnd);
+
+  E->Relocations.resize(Relocations.size());
+  for (unsigned i = 0, e = Relocations.size(); i != e; ++i) {
+    const MachineRelocation &MR = Relocations[i];
+    JITCodeCache::Relocation &R = E->Relocations[i];
+    if (MR.letTargetResolve() || MR.isGOTRelative() || MR.isJumpTableIndex()) {
+      ++NumUncacheable;
+      return 0;
+    }
+
+    R.Offset = MR.getMachineCodeOffset();
+    R.Type = MR.getRelocationType();
+    R.ConstantVal = MR.getConstantVal();
+    R.MayNeedFarStub = MR.mayNeedFarStub();
+    R.TargetOffset = 0;
+    if (MR.isExternalSymbol()) {
+      R.Kind = JITCodeCache::Relocation::ExternalSymbol;
+      R.Symbol = MR.getExternalSymbol();
+    } else if (MR.isGlobalValue() || MR.isIndirectSymbol()) {
+      // Globals are found again by name when the function is reloaded.
+      const GlobalValue *GV = MR.getGlobalValue();
+      if (!GV->hasName()) {
+        ++NumUncacheable;
+        return 0;
+      }
+      R.Kind = MR.isGlobalValue() ? JITCodeCache::Relocation::GlobalValue :
+                                    JITCodeCache::Relocation::IndirectSymbol;
+      R.Symbol = GV->getName();
+    } else {
+      uintptr_t Target = MR.isBasicBlock() ?
+        getMachineBasicBlockAddress(MR.getBasicBlock()) :
+        getConstantPoolEntryAddress(MR.getConstantPoolIndex());
+      R.Kind = JITCodeCache::Relocation::ImageOffset;
+      R.TargetOffset = Target - (uintptr_t)BufferBegin;
+    }
+  }
+  return E.take();
+}
+
+bool JIT::loadCachedFunction(Function *F) {
+  assert(isa<JITEmitter>(JCE) && "Unexpected MCE?");
+  return cast<JITEmitter>(JCE)->loadCachedFunction(F);
+}
+
+bool JIT::setCodeCacheDirectory(StringRef Dir) {
+  MutexGuard locked(lock);
+  assert(isa<JITEmitter>(JCE) && "Unexpected MCE?");
+  return cast<JITEmitter>(JCE)->setCodeCacheDir(Dir);
+}
+
+bool JITEmitter::loadCachedFunction(Function *F) {
+  // Call counters are compiled in as absolute addresses, which are only
+  // meaningful in this process.
+  if (!CodeCache || TheJIT->isCallProfilingEnabled())
+    return false;
+
+  // The key is computed from the IR, so read the body in first.
+  if (F->isMaterializable()) {
+    std::string ErrInfo;
+    if (F->Materialize(&ErrInfo))
+      report_fatal_error("Error reading function '" + F->getName()+
+                        "' from bitcode file: " + ErrInfo);
+  }
+
+  std::string Key;
+  JITCodeCache::computeKey(F, TheJIT->getCodeGenSettings(), Key);
+  JITCodeCache::Entry E;
+  if (!CodeCache->lookup(Key, E)) {
+    ++NumCacheMisses;
+    CacheKeyFn = F;
+    CacheKey.swap(Key);
+    return false;
+  }
+
+  // Find the targets of the relocations before allocating anything, so that a
+  // stale entry can be dropped without side effects.
+  Module *M = F->getParent();
+  std::vector<GlobalValue*> Targets(E.Relocations.size());
+  for (unsigned i = 0, e = E.Relocations.size(); i != e; ++i) {
+    const JITCodeCache::Relocation &R = E.Relocations[i];
+    if (R.Kind != JITCodeCache::Relocation::GlobalValue &&
+        R.Kind != JITCodeCache::Relocation::IndirectSymbol)
+      continue;
+    Targets[i] = M->getNamedValue(R.Symbol);
+    if (!Targets[i]) {
+      DEBUG(dbgs() << "JIT: Dropping cached code for " << F->getName()
+                   << ": cannot find " << R.Symbol << "\n");
+      CodeCache->invalidate(Key);
+      ++NumCacheMisses;
+      CacheKeyFn = F;
+      CacheKey.swap(Key);
+      return false;
+    }
+  }
+
+  // Allocate room for the image, with enough slack to place it at the same
+  // address modulo MaxAlignment as when it was emitted.
+  uintptr_t ActualSize = E.Image.size() + JITCodeCache::MaxAlignment;
+  uintptr_t MinSize = ActualSize;
+  MemMgr->setMemoryWritable();
+  BufferBegin = CurBufferPtr = MemMgr->startFunctionBody(F, ActualSize);
+  BufferEnd = BufferBegin+ActualSize;
+  EmittedFunctions[F].FunctionBody = BufferBegin;
+
+  uint8_t *ImageStart = 0, *FnStart = 0;
+  if (ActualSize >= MinSize) {
+    while (((uintptr_t)CurBufferPtr & (JITCodeCache::MaxAlignment-1)) != E.Skew)
+      ++CurBufferPtr;
+    ImageStart = CurBufferPtr;
+    if (!E.Image.empty())
+      memcpy(ImageStart, &E.Image[0], E.Image.size());
+    CurBufferPtr += E.Image.size();
+    FnStart = ImageStart + E.CodeOffset;
+    TheJIT->updateGlobalMapping(F, FnStart);
+
+    // Resolve the relocations the same way finishFunction does.
+    for (unsigned i = 0, e = E.Relocations.size(); i != e; ++i) {
+      const JITCodeCache::Relocation &R = E.Relocations[i];
+      void *Reference = ImageStart + R.Offset;
+      MachineRelocation MR =
+        MachineRelocation::getConstPool(R.Offset, R.Type, 0, R.ConstantVal);
+      void *ResultPtr = ImageStart + R.TargetOffset;
+      switch (R.Kind) {
+      case JITCodeCache::Relocation::ExternalSymbol:
+        MR = MachineRelocation::getExtSym(R.Offset, R.Type, R.Symbol.c_str(),
+                                          R.ConstantVal, false,
+                                          R.MayNeedFarStub);
+        ResultPtr = TheJIT->getPointerToNamedFunction(R.Symbol, false);
+        if (R.MayNeedFarStub)
+          ResultPtr = Resolver.getExternalFunctionStub(ResultPtr);
+        break;
+      case JITCodeCache::Relocation::GlobalValue:
+        MR = MachineRelocation::getGV(R.Offset, R.Type, Targets[i],
+                                      R.ConstantVal, R.MayNeedFarStub);
+        ResultPtr = getPointerToGlobal(Targets[i], Reference,
+                                       R.MayNeedFarStub);
+        break;
+      case JITCodeCache::Relocation::IndirectSymbol:
+        MR = MachineRelocation::getIndirectSymbol(R.Offset, R.Type, Targets[i],
+                                                  R.ConstantVal,
+                                                  R.MayNeedFarStub);
+        ResultPtr = getPointerToGVIndirectSym(Targets[i], Reference);
+        break;
+      case JITCodeCache::Relocation::ImageOffset:
+        break;
+      }
+      MR.setResultPointer(ResultPtr);
+      Relocations.push_back(MR);
+    }
+  }
+
+  // Globals allocated with the code may have used up the rest of the buffer.
+  MemMgr->endFunctionBody(F, BufferBegin, CurBufferPtr);
+  if (!ImageStart || CurBufferPtr == BufferEnd) {
+    DEBUG(dbgs() << "JIT: Not enough memory to load cached code for "
+                 << F->getName() << "\n");
+    Relocations.clear();
+    deallocateMemForFunction(F);
+    TheJIT->updateGlobalMapping(F, 0);
+    BufferBegin = CurBufferPtr = 0;
+    ++NumCacheMisses;
+    CacheKeyFn = F;
+    CacheKey.swap(Key);
+    return false;
+  }
+
+  if (!Relocations.empty()) {
+    NumRelos += Relocations.size();
+    TheJIT->getJITInfo().relocate(ImageStart, &Relocations[0],
+                                  Relocations.size(), MemMgr->getGOTBase());
+    Relocations.clear();
+  }
+
+  EmittedFunctions[F].Code = FnStart;
+  BufferBegin = CurBufferPtr = 0;
+  NumBytes += E.CodeSize;
+  ++NumCacheHits;
+
+  sys::Memory::InvalidateInstructionCache(FnStart, E.CodeSize);
+  MemMgr->setMemoryExecutable();
+
+  DEBUG(dbgs() << "JIT: Loaded cached code for " << F->getName() << " at ["
+               << (void*)FnStart << "]: " << E.CodeSize << " bytes\n");
+
+  JITEvent_EmittedFunctionDetails Details;
+  Details.MF = 0;
+  TheJIT->NotifyFunctionEmitted(*F, FnStart, E.CodeSize, Details);
+  return true;
+}
+
 void JITEmitter::retryWithMoreMemory(MachineFunction &F) {
   DEBUG(dbgs() << "JIT: Ran out of space for native code.  Reattempting.\n");
   Relocations.clear();  // Clear the old relocations or we'll reapply them.
@@ -1275,6 +1616,29 @@ void *JIT::getPointerToFunctionOrStub(Function *F) {
   return JE->getJITResolver().getLazyFunctionStub(F);
 }
 
+void JIT::setEmittingHotCode(bool Hot) {
+  assert(isa<JITEmitter>(JCE) && "Unexpected MCE?");
+  cast<JITEmitter>(JCE)->setEmittingHotCode(Hot);
+}
+
+void JIT::relinkRecompiledFunction(Function *F, void *OldAddr) {
+  assert(isa<JITEmitter>(JCE) && "Unexpected MCE?");
+  JITEmitter *JE = cast<JITEmitter>(getCodeEmitter());
+  JE->relinkRecompiledFunction(F, OldAddr);
+
+  // Calls that have not been bound to the old code yet go through the stub.
+  if (JE->getJITResolver().getLazyFunctionStubIfAvailable(F))
+    updateFunctionStub(F);
+}
+
+void JITEmitter::relinkRecompiledFunction(Function *F, void *OldAddr) {
+  void *Addr = TheJIT->getPointerToGlobalIfAvailable(F);
+  assert(Addr && Addr != OldAddr && "Function was not recompiled!");
+  MemMgr->setMemoryWritable();
+  TheJIT->getJITInfo().replaceMachineCodeForFunction(OldAddr, Addr);
+  MemMgr->setMemoryExecutable();
+}
+
 void JIT::updateFunctionStub(Function *F) {
   // Get the empty stub we generated earlier.
   assert(isa<JITEmitter>(JCE) && "Unexpected MCE?");
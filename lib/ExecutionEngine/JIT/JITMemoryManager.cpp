@@ -18,6 +18,7 @@
 #include "llvm/ADT/Twine.h"
 #include "llvm/GlobalValue.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -31,6 +32,11 @@ using namespace llvm;
 
 STATISTIC(NumSlabs, "Number of slabs of memory allocated by the JIT");
 
+static cl::opt<bool>
+HugePageCodeSlabs("jit-huge-pages",
+                  cl::desc("Allocate JIT code in huge-page aligned slabs"),
+                  cl::init(false));
+
 JITMemoryManager::~JITMemoryManager() {}
 
 //===----------------------------------------------------------------------===//
@@ -273,6 +279,13 @@ namespace {
     // Whether to poison freed memory.
     bool PoisonMemory;
 
+    /// CodeSlabSize - The minimum size of a code slab.  When code slabs are
+    /// allocated from huge pages this is the huge page size, so that all of
+    /// the code is packed into as few instruction TLB entries as possible,
+    /// away from the stubs and data, which are allocated separately.
+    size_t CodeSlabSize;
+    bool UseHugePages;
+
     /// LastSlab - This points to the last slab allocated and is used as the
     /// NearBlock parameter to AllocateRWX so that we can attempt to lay out all
     /// stubs, data, and code contiguously in memory.  In general, however, this
@@ -293,6 +306,15 @@ namespace {
     // When emitting code into a memory block, this is the block.
     MemoryRangeHeader *CurBlock;
 
+    /// HotCodeSlabs - Slabs holding the functions emitted while AllocateHotCode
+    /// is set.  They are filled from front to back and their memory is never
+    /// reused, so that hot functions stay packed together in the order they
+    /// were emitted.  HotCodeCur and HotCodeEnd delimit the free space in the
+    /// last of them, and LastHotBlock is the most recent hot allocation.
+    std::vector<sys::MemoryBlock> HotCodeSlabs;
+    uint8_t *HotCodeCur, *HotCodeEnd, *LastHotBlock;
+    bool AllocateHotCode;
+
     uint8_t *GOTBase;     // Target Specific reserved memory
   public:
     DefaultJITMemoryManager();
@@ -302,6 +324,10 @@ namespace {
     /// last slab it allocated, so that subsequent allocations follow it.
     sys::MemoryBlock allocateNewSlab(size_t size);
 
+    /// allocateCodeSlab - Allocates a new MemoryBlock for code, from huge
+    /// pages if they are enabled.
+    sys::MemoryBlock allocateCodeSlab(size_t size);
+
     /// DefaultCodeSlabSize - When we have to go map more memory, we allocate at
     /// least this much unless more is requested.
     static const size_t DefaultCodeSlabSize;
@@ -318,17 +344,59 @@ namespace {
 
     // Testing methods.
     virtual bool CheckInvariants(std::string &ErrorStr);
-    size_t GetDefaultCodeSlabSize() { return DefaultCodeSlabSize; }
+    size_t GetDefaultCodeSlabSize() { return CodeSlabSize; }
     size_t GetDefaultDataSlabSize() { return DefaultSlabSize; }
     size_t GetDefaultStubSlabSize() { return DefaultSlabSize; }
     unsigned GetNumCodeSlabs() { return CodeSlabs.size(); }
     unsigned GetNumDataSlabs() { return DataAllocator.GetNumSlabs(); }
     unsigned GetNumStubSlabs() { return StubAllocator.GetNumSlabs(); }
 
+    /// setAllocateHotCode - Controls whether function bodies are allocated
+    /// from the hot code slabs.
+    void setAllocateHotCode(bool Hot) {
+      AllocateHotCode = Hot;
+    }
+
     /// startFunctionBody - When a function starts, allocate a block of free
     /// executable memory, returning a pointer to it and its actual size.
     uint8_t *startFunctionBody(const Function *F, uintptr_t &ActualSize) {
+      if (AllocateHotCode)
+        return startHotCodeBlock(ActualSize);
+      return startCodeBlock(ActualSize);
+    }
+
+    /// startHotCodeBlock - Return all of the free space left in the current
+    /// hot code slab, or a new slab if that is smaller than ActualSize.
+    uint8_t *startHotCodeBlock(uintptr_t &ActualSize) {
+      if (HotCodeCur == HotCodeEnd ||
+          uintptr_t(HotCodeEnd - HotCodeCur) < ActualSize) {
+        DEBUG(dbgs() << "JIT: Allocating another slab of memory for hot code.");
+        sys::MemoryBlock B =
+          allocateCodeSlab(std::max(CodeSlabSize, (size_t)ActualSize));
+        HotCodeSlabs.push_back(B);
+        HotCodeCur = (uint8_t*)B.base();
+        HotCodeEnd = HotCodeCur + B.size();
+      }
 
+      LastHotBlock = HotCodeCur;
+      ActualSize = HotCodeEnd - HotCodeCur;
+      return HotCodeCur;
+    }
+
+    /// isHotCode - Return true if Ptr points into one of the hot code slabs.
+    bool isHotCode(const void *Ptr) const {
+      for (unsigned i = 0, e = HotCodeSlabs.size(); i != e; ++i) {
+        const char *Start = (const char*)HotCodeSlabs[i].base();
+        if (Start <= (const char*)Ptr &&
+            (const char*)Ptr < Start + HotCodeSlabs[i].size())
+          return true;
+      }
+      return false;
+    }
+
+    /// startCodeBlock - Allocate the largest free block of code memory, or a
+    /// new one if none is at least ActualSize bytes long.
+    uint8_t *startCodeBlock(uintptr_t &ActualSize) {
       FreeRangeHeader* candidateBlock = FreeMemoryList;
       FreeRangeHeader* head = FreeMemoryList;
       FreeRangeHeader* iter = head->Next;
@@ -371,8 +439,8 @@ namespace {
       // two MemoryRangeHeaders: the one in the user's block, and the one at the
       // end of the slab.
       size_t PaddedMin = MinSize + 2 * sizeof(MemoryRangeHeader);
-      size_t SlabSize = std::max(DefaultCodeSlabSize, PaddedMin);
-      sys::MemoryBlock B = allocateNewSlab(SlabSize);
+      size_t SlabSize = std::max(CodeSlabSize, PaddedMin);
+      sys::MemoryBlock B = allocateCodeSlab(SlabSize);
       CodeSlabs.push_back(B);
       char *MemBase = (char*)(B.base());
 
@@ -403,6 +471,11 @@ namespace {
     void endFunctionBody(const Function *F, uint8_t *FunctionStart,
                          uint8_t *FunctionEnd) {
       assert(FunctionEnd > FunctionStart);
+      if (FunctionStart == LastHotBlock) {
+        assert(FunctionEnd <= HotCodeEnd && "Function overran its slab!");
+        HotCodeCur = FunctionEnd;
+        return;
+      }
       assert(FunctionStart == (uint8_t *)(CurBlock+1) &&
              "Mismatched function start/end!");
 
@@ -441,10 +514,10 @@ namespace {
       return (uint8_t*)DataAllocator.Allocate(Size, Alignment);
     }
 
-    /// startExceptionTable - Use startFunctionBody to allocate memory for the
-    /// function's exception table.
+    /// startExceptionTable - Allocate memory for the function's exception
+    /// table the same way as for a function body, but never among hot code.
     uint8_t* startExceptionTable(const Function* F, uintptr_t &ActualSize) {
-      return startFunctionBody(F, ActualSize);
+      return startCodeBlock(ActualSize);
     }
 
     /// endExceptionTable - The exception table of F is now allocated,
@@ -480,9 +553,20 @@ namespace {
     }
 
     /// deallocateFunctionBody - Deallocate all memory for the specified
-    /// function body.
+    /// function body.  Hot code is not reused, except that the most recent
+    /// hot block is given back so that the JIT can retry it with a larger
+    /// buffer.
     void deallocateFunctionBody(void *Body) {
-      if (Body) deallocateBlock(Body);
+      if (!Body)
+        return;
+      if (!isHotCode(Body)) {
+        deallocateBlock(Body);
+        return;
+      }
+      if (Body == LastHotBlock) {
+        HotCodeCur = LastHotBlock;
+        LastHotBlock = 0;
+      }
     }
 
     /// deallocateExceptionTable - Deallocate memory for the specified
@@ -497,6 +581,8 @@ namespace {
     {
       for (unsigned i = 0, e = CodeSlabs.size(); i != e; ++i)
         sys::Memory::setWritable(CodeSlabs[i]);
+      for (unsigned i = 0, e = HotCodeSlabs.size(); i != e; ++i)
+        sys::Memory::setWritable(HotCodeSlabs[i]);
     }
     /// setMemoryExecutable - When code generation is done and we're ready to
     /// start execution, the code pages may need permissions changed.
@@ -504,6 +590,8 @@ namespace {
     {
       for (unsigned i = 0, e = CodeSlabs.size(); i != e; ++i)
         sys::Memory::setExecutable(CodeSlabs[i]);
+      for (unsigned i = 0, e = HotCodeSlabs.size(); i != e; ++i)
+        sys::Memory::setExecutable(HotCodeSlabs[i]);
     }
 
     /// setPoisonMemory - Controls whether we write garbage over freed memory.
@@ -534,13 +622,19 @@ DefaultJITMemoryManager::DefaultJITMemoryManager()
 #else
     PoisonMemory(true),
 #endif
+    CodeSlabSize(DefaultCodeSlabSize),
+    UseHugePages(HugePageCodeSlabs && sys::Memory::getHugePageSize() != 0),
     LastSlab(0, 0),
     BumpSlabAllocator(*this),
     StubAllocator(DefaultSlabSize, DefaultSizeThreshold, BumpSlabAllocator),
-    DataAllocator(DefaultSlabSize, DefaultSizeThreshold, BumpSlabAllocator) {
+    DataAllocator(DefaultSlabSize, DefaultSizeThreshold, BumpSlabAllocator),
+    HotCodeCur(0), HotCodeEnd(0), LastHotBlock(0), AllocateHotCode(false) {
+
+  if (UseHugePages)
+    CodeSlabSize = std::max(CodeSlabSize, sys::Memory::getHugePageSize());
 
   // Allocate space for code.
-  sys::MemoryBlock MemBlock = allocateNewSlab(DefaultCodeSlabSize);
+  sys::MemoryBlock MemBlock = allocateCodeSlab(CodeSlabSize);
   CodeSlabs.push_back(MemBlock);
   uint8_t *MemBase = (uint8_t*)MemBlock.base();
 
@@ -602,6 +696,8 @@ void DefaultJITMemoryManager::AllocateGOT() {
 DefaultJITMemoryManager::~DefaultJITMemoryManager() {
   for (unsigned i = 0, e = CodeSlabs.size(); i != e; ++i)
     sys::Memory::ReleaseRWX(CodeSlabs[i]);
+  for (unsigned i = 0, e = HotCodeSlabs.size(); i != e; ++i)
+    sys::Memory::ReleaseRWX(HotCodeSlabs[i]);
 
   delete[] GOTBase;
 }
@@ -624,6 +720,26 @@ sys::MemoryBlock DefaultJITMemoryManager::allocateNewSlab(size_t size) {
   return B;
 }
 
+sys::MemoryBlock DefaultJITMemoryManager::allocateCodeSlab(size_t size) {
+  if (!UseHugePages)
+    return allocateNewSlab(size);
+
+  // Huge page slabs are placed wherever they can be aligned, so they do not
+  // become the LastSlab that other slabs are allocated near.
+  std::string ErrMsg;
+  sys::MemoryBlock B = sys::Memory::AllocateHugeRWX(size, &ErrMsg);
+  if (B.base() == 0) {
+    report_fatal_error("Allocation failed when allocating new memory in the"
+                       " JIT\n" + Twine(ErrMsg));
+  }
+  ++NumSlabs;
+  // Initialize the slab to garbage when debugging.
+  if (PoisonMemory) {
+    memset(B.base(), 0xCD, B.size());
+  }
+  return B;
+}
+
 /// CheckInvariants - For testing only.  Return "" if all internal invariants
 /// are preserved, and a helpful error message otherwise.  For free and
 /// allocated blocks, make sure that adding BlockSize gives a valid block.
@@ -71,6 +71,7 @@ static bool isFixupKindX86PCRel(unsigned Kind) {
   default:
     return false;
   case X86::reloc_pcrel_1byte:
+  case X86::reloc_pcrel_2byte:
   case X86::reloc_pcrel_4byte:
   case X86::reloc_riprel_4byte:
   case X86::reloc_riprel_4byte_movq_load:
@@ -85,6 +86,7 @@ static bool RelocNeedsGOT(unsigned Type) {
   case ELF::R_X86_64_GOT32:
   case ELF::R_X86_64_PLT32:
   case ELF::R_X86_64_GOTPCREL:
+  case ELF::R_X86_64_GOTOFF64:
     return true;
   }
 }
@@ -644,23 +646,57 @@ void ELFObjectWriterImpl::RecordRelocation(const MCAssembler &Asm,
   unsigned Type;
   if (Is64Bit) {
     if (IsPCRel) {
-      switch (Modifier) {
-      case MCSymbolRefExpr::VK_None:
-        Type = ELF::R_X86_64_PC32;
-        break;
-      case MCSymbolRefExpr::VK_PLT:
-        Type = ELF::R_X86_64_PLT32;
-        break;
-      case llvm::MCSymbolRefExpr::VK_GOTPCREL:
-        Type = ELF::R_X86_64_GOTPCREL;
+      switch ((unsigned)Fixup.getKind()) {
+      default: llvm_unreachable("invalid fixup kind!");
+      case FK_Data_8: Type = ELF::R_X86_64_PC64; break;
+      case X86::reloc_pcrel_2byte:
+      case FK_Data_2: Type = ELF::R_X86_64_PC16; break;
+      case X86::reloc_pcrel_1byte:
+      case FK_Data_1: Type = ELF::R_X86_64_PC8; break;
+      case X86::reloc_signed_4byte:
+      case X86::reloc_pcrel_4byte:
+      case X86::reloc_riprel_4byte:
+      case X86::reloc_riprel_4byte_movq_load:
+      case FK_Data_4:
+        switch (Modifier) {
+        case MCSymbolRefExpr::VK_None:
+          Type = ELF::R_X86_64_PC32;
+          break;
+        case MCSymbolRefExpr::VK_PLT:
+          Type = ELF::R_X86_64_PLT32;
+          break;
+        case llvm::MCSymbolRefExpr::VK_GOTPCREL:
+          Type = ELF::R_X86_64_GOTPCREL;
+          break;
+        case MCSymbolRefExpr::VK_GOTTPOFF:
+          Type = ELF::R_X86_64_GOTTPOFF;
+          break;
+        case MCSymbolRefExpr::VK_TLSGD:
+          Type = ELF::R_X86_64_TLSGD;
+          break;
+        default:
+          llvm_unreachable("Unimplemented");
+        }
         break;
-      default:
-        llvm_unreachable("Unimplemented");
       }
     } else {
       switch ((unsigned)Fixup.getKind()) {
       default: llvm_unreachable("invalid fixup kind!");
-      case FK_Data_8: Type = ELF::R_X86_64_64; break;
+      case FK_Data_8:
+        switch (Modifier) {
+        case MCSymbolRefExpr::VK_None:
+          Type = ELF::R_X86_64_64;
+          break;
+        case MCSymbolRefExpr::VK_GOTOFF:
+          Type = ELF::R_X86_64_GOTOFF64;
+          break;
+        case MCSymbolRefExpr::VK_TPOFF:
+          Type = ELF::R_X86_64_TPOFF64;
+          break;
+        default:
+          llvm_unreachable("Unimplemented");
+        }
+        break;
       case X86::reloc_signed_4byte:
       case X86::reloc_pcrel_4byte:
         assert(isInt<32>(Target.getConstant()));
@@ -674,12 +710,24 @@ void ELFObjectWriterImpl::RecordRelocation(const MCAssembler &Asm,
         case llvm::MCSymbolRefExpr::VK_GOTPCREL:
           Type = ELF::R_X86_64_GOTPCREL;
           break;
+        case MCSymbolRefExpr::VK_TPOFF:
+          Type = ELF::R_X86_64_TPOFF32;
+          break;
         default:
           llvm_unreachable("Unimplemented");
         }
         break;
       case FK_Data_4:
-        Type = ELF::R_X86_64_32;
+        switch (Modifier) {
+        case MCSymbolRefExpr::VK_None:
+          Type = ELF::R_X86_64_32;
+          break;
+        case MCSymbolRefExpr::VK_TPOFF:
+          Type = ELF::R_X86_64_TPOFF32;
+          break;
+        default:
+          llvm_unreachable("Unimplemented");
+        }
         break;
       case FK_Data_2: Type = ELF::R_X86_64_16; break;
       case X86::reloc_pcrel_1byte:
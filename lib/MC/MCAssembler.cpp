@@ -38,6 +38,7 @@ STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
+STATISTIC(SectionRelaxations, "Number of section relaxation passes");
 STATISTIC(SectionLayouts, "Number of section layouts");
 }
 }
@@ -622,10 +623,9 @@ void MCAssembler::AddSectionToTheEnd(const MCObjectWriter &Writer,
 
   Layout.LayoutSection(&SD);
 
-  // Layout until everything fits.
-  while (LayoutOnce(Writer, Layout))
-    continue;
-
+  // The instruction fragments have all been lowered by now, so there is
+  // nothing left to relax.
+  Layout.LayoutFile();
 }
 
 void MCAssembler::Finish(MCObjectWriter *Writer) {
@@ -691,8 +691,20 @@ void MCAssembler::Finish(MCObjectWriter *Writer) {
       report_fatal_error("unable to create object writer!");
   }
 
+  // Collect the instruction fragments that may need relaxation.  The
+  // relaxation passes only visit these, not the data and alignment fragments
+  // around them, and drop each one once it can no longer need relaxing.
+  std::vector<std::vector<MCInstFragment*> > Pending(size());
+  for (MCAssembler::iterator it = begin(), ie = end(); it != ie; ++it)
+    for (MCSectionData::iterator it2 = it->begin(),
+           ie2 = it->end(); it2 != ie2; ++it2)
+      if (MCInstFragment *IF = dyn_cast<MCInstFragment>(it2))
+        if (getBackend().MayNeedRelaxation(IF->getInst()))
+          Pending[it->getOrdinal()].push_back(IF);
+
   // Layout until everything fits.
-  while (LayoutOnce(*Writer, Layout))
+  Layout.LayoutFile();
+  while (LayoutOnce(*Writer, Layout, Pending))
     continue;
 
   DEBUG_WITH_TYPE("mc-dump", {
@@ -781,56 +793,80 @@ bool MCAssembler::FragmentNeedsRelaxation(const MCObjectWriter &Writer,
   return false;
 }
 
-bool MCAssembler::LayoutOnce(const MCObjectWriter &Writer,
-                             MCAsmLayout &Layout) {
-  ++stats::RelaxationSteps;
-
-  // Layout the sections in order.
-  Layout.LayoutFile();
-
-  // Scan for fragments that need relaxation.
+bool MCAssembler::LayoutSectionOnce(const MCObjectWriter &Writer,
+                                    MCAsmLayout &Layout,
+                                    std::vector<MCInstFragment*> &Pending) {
+  // Relaxing a fragment only moves the fragments after it, but it can make a
+  // fragment before it need relaxation too: a forward branch over the one that
+  // grew.  So every pending fragment is checked again on each pass, not just
+  // those downstream of a change.  Fragments that were relaxed to a form that
+  // never needs relaxing are dropped, so each pass only costs as much as the
+  // instructions that are still short.
   bool WasRelaxed = false;
-  for (iterator it = begin(), ie = end(); it != ie; ++it) {
-    MCSectionData &SD = *it;
-
-    for (MCSectionData::iterator it2 = SD.begin(),
-           ie2 = SD.end(); it2 != ie2; ++it2) {
-      // Check if this is an instruction fragment that needs relaxation.
-      MCInstFragment *IF = dyn_cast<MCInstFragment>(it2);
-      if (!IF || !FragmentNeedsRelaxation(Writer, IF, Layout))
-        continue;
-
-      ++stats::RelaxedInstructions;
+  unsigned NumPending = 0;
+  for (unsigned i = 0, e = Pending.size(); i != e; ++i) {
+    MCInstFragment *IF = Pending[i];
+    if (!FragmentNeedsRelaxation(Writer, IF, Layout)) {
+      Pending[NumPending++] = IF;
+      continue;
+    }
 
-      // FIXME-PERF: We could immediately lower out instructions if we can tell
-      // they are fully resolved, to avoid retesting on later passes.
+    ++stats::RelaxedInstructions;
+
+    // FIXME-PERF: We could immediately lower out instructions if we can tell
+    // they are fully resolved, to avoid retesting on later passes.
+
+    // Relax the fragment.
+
+    MCInst Relaxed;
+    getBackend().RelaxInstruction(IF->getInst(), Relaxed);
+
+    // Encode the new instruction.
+    //
+    // FIXME-PERF: If it matters, we could let the target do this. It can
+    // probably do so more efficiently in many cases.
+    SmallVector<MCFixup, 4> Fixups;
+    SmallString<256> Code;
+    raw_svector_ostream VecOS(Code);
+    getEmitter().EncodeInstruction(Relaxed, VecOS, Fixups);
+    VecOS.flush();
+
+    // Update the instruction fragment.
+    int SlideAmount = Code.size() - IF->getInstSize();
+    IF->setInst(Relaxed);
+    IF->getCode() = Code;
+    IF->getFixups().clear();
+    // FIXME: Eliminate copy.
+    for (unsigned i = 0, e = Fixups.size(); i != e; ++i)
+      IF->getFixups().push_back(Fixups[i]);
+
+    // Update the layout, and remember that we relaxed.  Only the fragments
+    // after this one are invalidated; they are laid out again lazily when
+    // the next fixup that depends on them is evaluated.
+    Layout.UpdateForSlide(IF, SlideAmount);
+    WasRelaxed = true;
+
+    if (getBackend().MayNeedRelaxation(Relaxed))
+      Pending[NumPending++] = IF;
+  }
 
-      // Relax the fragment.
+  Pending.resize(NumPending);
+  return WasRelaxed;
+}
 
-      MCInst Relaxed;
-      getBackend().RelaxInstruction(IF->getInst(), Relaxed);
+bool MCAssembler::LayoutOnce(const MCObjectWriter &Writer, MCAsmLayout &Layout,
+                      std::vector<std::vector<MCInstFragment*> > &Pending) {
+  ++stats::RelaxationSteps;
 
-      // Encode the new instruction.
-      //
-      // FIXME-PERF: If it matters, we could let the target do this. It can
-      // probably do so more efficiently in many cases.
-      SmallVector<MCFixup, 4> Fixups;
-      SmallString<256> Code;
-      raw_svector_ostream VecOS(Code);
-      getEmitter().EncodeInstruction(Relaxed, VecOS, Fixups);
-      VecOS.flush();
-
-      // Update the instruction fragment.
-      int SlideAmount = Code.size() - IF->getInstSize();
-      IF->setInst(Relaxed);
-      IF->getCode() = Code;
-      IF->getFixups().clear();
-      // FIXME: Eliminate copy.
-      for (unsigned i = 0, e = Fixups.size(); i != e; ++i)
-        IF->getFixups().push_back(Fixups[i]);
-
-      // Update the layout, and remember that we relaxed.
-      Layout.UpdateForSlide(IF, SlideAmount);
+  // Relax each section until it stops changing before moving on to the next.
+  // Relaxing a fragment only moves the fragments after it, so the sections
+  // already visited in this pass are not rescanned for every change made to a
+  // later one.  The caller repeats the pass until nothing changes, to catch
+  // fixups that cross sections.
+  bool WasRelaxed = false;
+  for (iterator it = begin(), ie = end(); it != ie; ++it) {
+    while (LayoutSectionOnce(Writer, Layout, Pending[it->getOrdinal()])) {
+      ++stats::SectionRelaxations;
       WasRelaxed = true;
     }
   }
@@ -35,12 +35,24 @@ using namespace llvm;
 // CreateInfoOutputFile - Return a file stream to print our output on.
 namespace llvm { extern raw_ostream *CreateInfoOutputFile(); }
 
+// PrintJSONString - Print a quoted JSON string, defined in Timer.cpp.
+namespace llvm { extern void PrintJSONString(StringRef S, raw_ostream &OS); }
+
 /// -stats - Command line option to cause transformations to emit stats about
 /// what they did.
 ///
 static cl::opt<bool>
 Enabled("stats", cl::desc("Enable statistics output from program"));
 
+/// -stats-json - Print the statistics as a JSON object on a single line
+/// instead of a table, for scripts that collect them across many runs.  The
+/// -timers-json reports go to the same file one line each, so the file can be
+/// read one object at a time.
+///
+static cl::opt<bool>
+StatsAsJSON("stats-json", cl::desc("Print -stats output as JSON, on one line"),
+            cl::Hidden);
+
 
 namespace {
 /// StatisticInfo - This class is used in a ManagedStatic so that it is created
@@ -50,6 +62,7 @@ class StatisticInfo {
   std::vector<const Statistic*> Stats;
   friend void llvm::PrintStatistics();
   friend void llvm::PrintStatistics(raw_ostream &OS);
+  friend void llvm::PrintStatisticsJSON(raw_ostream &OS);
 public:
   ~StatisticInfo();
 
@@ -102,6 +115,9 @@ void llvm::EnableStatistics() {
 }
 
 void llvm::PrintStatistics(raw_ostream &OS) {
+  if (StatsAsJSON)
+    return PrintStatisticsJSON(OS);
+
   StatisticInfo &Stats = *StatInfo;
 
   // Figure out how long the biggest Value and Name fields are.
@@ -135,6 +151,24 @@ void llvm::PrintStatistics(raw_ostream &OS) {
 
 }
 
+void llvm::PrintStatisticsJSON(raw_ostream &OS) {
+  StatisticInfo &Stats = *StatInfo;
+
+  std::stable_sort(Stats.Stats.begin(), Stats.Stats.end(), NameCompare());
+
+  OS << "{\"statistics\": [";
+  for (size_t i = 0, e = Stats.Stats.size(); i != e; ++i) {
+    const Statistic *S = Stats.Stats[i];
+    OS << (i ? ", " : "") << "{\"name\": ";
+    PrintJSONString(S->getName(), OS);
+    OS << ", \"desc\": ";
+    PrintJSONString(S->getDesc(), OS);
+    OS << ", \"value\": " << S->getValue() << '}';
+  }
+  OS << "]}\n";
+  OS.flush();
+}
+
 void llvm::PrintStatistics() {
   StatisticInfo &Stats = *StatInfo;
 
@@ -20,12 +20,17 @@
 #include "llvm/System/Mutex.h"
 #include "llvm/System/Process.h"
 #include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringMap.h"
 using namespace llvm;
 
 // CreateInfoOutputFile - Return a file stream to print our output on.
 namespace llvm { extern raw_ostream *CreateInfoOutputFile(); }
 
+// PrintJSONString - Print a quoted JSON string, shared with Statistic.cpp and
+// the pass manager.
+namespace llvm { extern void PrintJSONString(StringRef S, raw_ostream &OS); }
+
 // getLibSupportInfoOutputFilename - This ugly hack is brought to you courtesy
 // of constructor/destructor ordering being unspecified by C++.  Basically the
 // problem is that a Statistic object gets destroyed, which ends up calling
@@ -47,6 +52,20 @@ namespace {
                                       "tracking (this may be slow)"),
              cl::Hidden);
 
+  static cl::opt<bool>
+  TrackProcessTime("track-process-time",
+                   cl::desc("Sample user and system time as well as wall "
+                            "time when starting and stopping timers"),
+                   cl::init(true), cl::Hidden);
+
+  // -timers-json - Print each timer group report as a JSON object on a line of
+  // its own, in the same format as -stats-json, so that a file with both
+  // reports can be read one line at a time.
+  static cl::opt<bool>
+  TimersAsJSON("timers-json", cl::desc("Print timer reports as JSON, one "
+                                       "object per line"),
+               cl::Hidden);
+
   static cl::opt<std::string, true>
   InfoOutputFilename("info-output-file", cl::value_desc("filename"),
                      cl::desc("File to append -stats and -timer output to"),
@@ -104,6 +123,7 @@ void Timer::init(StringRef N) {
   assert(TG == 0 && "Timer already initialized");
   Name.assign(N.begin(), N.end());
   Started = false;
+  Running = 0;
   TG = getDefaultTimerGroup();
   TG->addTimer(*this);
 }
@@ -112,6 +132,7 @@ void Timer::init(StringRef N, TimerGroup &tg) {
   assert(TG == 0 && "Timer already initialized");
   Name.assign(N.begin(), N.end());
   Started = false;
+  Running = 0;
   TG = &tg;
   TG->addTimer(*this);
 }
@@ -130,13 +151,18 @@ TimeRecord TimeRecord::getCurrentTime(bool Start) {
   TimeRecord Result;
   sys::TimeValue now(0,0), user(0,0), sys(0,0);
   
-  if (Start) {
+  if (Start)
     Result.MemUsed = getMemUsage();
+
+  // Process times cost a system call on every sample, while the wall clock is
+  // usually read without entering the kernel at all.
+  if (TrackProcessTime)
     sys::Process::GetTimeUsage(now, user, sys);
-  } else {
-    sys::Process::GetTimeUsage(now, user, sys);
+  else
+    now = sys::TimeValue::now();
+
+  if (!Start)
     Result.MemUsed = getMemUsage();
-  }
 
   Result.WallTime   =  now.seconds() +  now.microseconds() / 1000000.0;
   Result.UserTime   = user.seconds() + user.microseconds() / 1000000.0;
@@ -144,25 +170,16 @@ TimeRecord TimeRecord::getCurrentTime(bool Start) {
   return Result;
 }
 
-static ManagedStatic<std::vector<Timer*> > ActiveTimers;
-
 void Timer::startTimer() {
   Started = true;
-  ActiveTimers->push_back(this);
+  ++Running;
   Time -= TimeRecord::getCurrentTime(true);
 }
 
 void Timer::stopTimer() {
+  assert(Running && "stop but no startTimer?");
+  --Running;
   Time += TimeRecord::getCurrentTime(false);
-
-  if (ActiveTimers->back() == this) {
-    ActiveTimers->pop_back();
-  } else {
-    std::vector<Timer*>::iterator I =
-      std::find(ActiveTimers->begin(), ActiveTimers->end(), this);
-    assert(I != ActiveTimers->end() && "stop but no startTimer?");
-    ActiveTimers->erase(I);
-  }
 }
 
 static void printVal(double Val, double Total, raw_ostream &OS) {
@@ -313,6 +330,27 @@ void TimerGroup::addTimer(Timer &T) {
   FirstTimer = &T;
 }
 
+void llvm::PrintJSONString(StringRef S, raw_ostream &OS) {
+  OS << '"';
+  for (unsigned i = 0, e = S.size(); i != e; ++i) {
+    unsigned char C = S[i];
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20 || C == 0x7f)
+      OS << "\\u00" << hexdigit(C >> 4) << hexdigit(C & 0xF);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+static void printJSONRecord(const TimeRecord &T, raw_ostream &OS) {
+  OS << "\"wall\": " << format("%.6f", T.getWallTime())
+     << ", \"user\": " << format("%.6f", T.getUserTime())
+     << ", \"system\": " << format("%.6f", T.getSystemTime())
+     << ", \"mem\": " << (long long)T.getMemUsed();
+}
+
 void TimerGroup::PrintQueuedTimers(raw_ostream &OS) {
   // Sort the timers in descending order by amount of time taken.
   std::sort(TimersToPrint.begin(), TimersToPrint.end());
@@ -321,6 +359,28 @@ void TimerGroup::PrintQueuedTimers(raw_ostream &OS) {
   for (unsigned i = 0, e = TimersToPrint.size(); i != e; ++i)
     Total += TimersToPrint[i].first;
   
+  // As a single line: {"timers": {"group": <name>, "entries": [{"name": <name>,
+  // "wall": <seconds>, ...}, ...], "total": {"wall": <seconds>, ...}}}.
+  if (TimersAsJSON) {
+    OS << "{\"timers\": {\"group\": ";
+    PrintJSONString(Name, OS);
+    OS << ", \"entries\": [";
+    for (unsigned i = 0, e = TimersToPrint.size(); i != e; ++i) {
+      const std::pair<TimeRecord, std::string> &Entry = TimersToPrint[e-i-1];
+      OS << (i ? ", " : "") << "{\"name\": ";
+      PrintJSONString(Entry.second, OS);
+      OS << ", ";
+      printJSONRecord(Entry.first, OS);
+      OS << '}';
+    }
+    OS << "], \"total\": {";
+    printJSONRecord(Total, OS);
+    OS << "}}}\n";
+    OS.flush();
+    TimersToPrint.clear();
+    return;
+  }
+
   // Print out timing header.
   OS << "===" << std::string(73, '-') << "===\n";
   // Figure out how many spaces to indent TimerGroup name.
@@ -23,6 +23,7 @@
 #include "llvm/MC/MCStreamer.h"
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/Target/Mangler.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Type.h"
@@ -576,7 +577,50 @@ void X86AsmPrinter::EmitInstruction(const MachineInstr *MI) {
     OutStreamer.EmitInstruction(TmpInst);
     return;
   }
-      
+
+  case X86::TLS_addr64: {
+    // The asm string is enough for a text streamer.
+    if (OutStreamer.hasRawTextSupport())
+      break;
+
+    // Otherwise emit the general dynamic sequence the linker expects, padding
+    // included, so that it can be relaxed to the initial or local exec one:
+    //     .byte 0x66
+    //     leaq sym@TLSGD(%rip), %rdi
+    //     .word 0x6666
+    //     rex64
+    //     call __tls_get_addr@PLT
+    MCInst AddrInst;
+    MCInstLowering.Lower(MI, AddrInst);
+
+    OutStreamer.EmitBytes(StringRef("\x66", 1), 0);
+    MCInst TmpInst;
+    TmpInst.setOpcode(X86::LEA64r);
+    TmpInst.addOperand(MCOperand::CreateReg(X86::RDI));
+    TmpInst.addOperand(MCOperand::CreateReg(X86::RIP));  // Base
+    TmpInst.addOperand(MCOperand::CreateImm(1));         // Scale
+    TmpInst.addOperand(MCOperand::CreateReg(0));         // Index
+    TmpInst.addOperand(AddrInst.getOperand(3));          // Disp
+    TmpInst.addOperand(MCOperand::CreateReg(0));         // Segment
+    OutStreamer.EmitInstruction(TmpInst);
+
+    OutStreamer.EmitBytes(StringRef("\x66\x66\x48", 3), 0);
+    MCSymbol *GetAddr =
+      OutContext.GetOrCreateSymbol(StringRef("__tls_get_addr"));
+    MCInst CallInst;
+    CallInst.setOpcode(X86::CALL64pcrel32);
+    CallInst.addOperand(MCOperand::CreateExpr(
+      MCSymbolRefExpr::Create(GetAddr, MCSymbolRefExpr::VK_PLT, OutContext)));
+    OutStreamer.EmitInstruction(CallInst);
+    return;
+  }
+
+  case X86::TLS_addr32:
+    // The object writer has no i386 TLS relocations yet.
+    if (!OutStreamer.hasRawTextSupport())
+      report_fatal_error("i386 ELF TLS is not supported in object files yet");
+    break;
+
   case X86::ADD32ri: {
     // Lower the MO_GOT_ABSOLUTE_ADDRESS form of ADD32ri.
     if (MI->getOperand(2).getTargetFlags() != X86II::MO_GOT_ABSOLUTE_ADDRESS)
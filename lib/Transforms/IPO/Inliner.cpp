@@ -19,6 +19,7 @@
 #include "llvm/IntrinsicInst.h"
 #include "llvm/Analysis/CallGraph.h"
 #include "llvm/Analysis/InlineCost.h"
+#include "llvm/Analysis/ProfileInfo.h"
 #include "llvm/Target/TargetData.h"
 #include "llvm/Transforms/IPO/InlinerPass.h"
 #include "llvm/Transforms/Utils/Cloning.h"
@@ -36,6 +37,7 @@ STATISTIC(NumInlined, "Number of functions inlined");
 STATISTIC(NumCallsDeleted, "Number of call sites deleted, not inlined");
 STATISTIC(NumDeleted, "Number of functions deleted because all callers found");
 STATISTIC(NumMergedAllocas, "Number of allocas merged together");
+STATISTIC(NumHotInlined, "Number of hot call sites inlined");
 
 static cl::opt<int>
 InlineLimit("inline-threshold", cl::Hidden, cl::init(225), cl::ZeroOrMore,
@@ -45,22 +47,59 @@ static cl::opt<int>
 HintThreshold("inlinehint-threshold", cl::Hidden, cl::init(325),
               cl::desc("Threshold for inlining functions with inline hint"));
 
+static cl::opt<bool>
+InlineProfile("inline-profile", cl::Hidden,
+              cl::desc("Use the edge profile (e.g. from -profile-loader) to "
+                       "guide inlining"));
+
+static cl::opt<int>
+HotThreshold("inline-hot-threshold", cl::Hidden, cl::init(1000),
+             cl::desc("Threshold for inlining at hot call sites"));
+
+static cl::opt<unsigned>
+HotCallSiteFraction("inline-hot-fraction", cl::Hidden, cl::init(100),
+                    cl::desc("A call site is hot if it runs at least 1/N as "
+                             "often as the hottest call site (default = 100)"));
+
+static cl::opt<unsigned>
+ColdCallSiteFraction("inline-cold-fraction", cl::Hidden, cl::init(10000),
+                     cl::desc("A call site is cold if it runs at most 1/N as "
+                              "often as the hottest call site "
+                              "(default = 10000)"));
+
+static cl::opt<unsigned>
+GrowthBudget("inline-growth-budget", cl::Hidden, cl::init(20),
+             cl::desc("Percentage by which inlining at hot call sites may "
+                      "grow the module (default = 20)"));
+
 // Threshold to use when optsize is specified (and there is no -inline-limit).
 const int OptSizeThreshold = 75;
 
 Inliner::Inliner(char &ID) 
-  : CallGraphSCCPass(ID), InlineThreshold(InlineLimit) {}
+  : CallGraphSCCPass(ID), InlineThreshold(InlineLimit), PI(0),
+    MaxCallSiteCount(0), ModuleSize(0), HotGrowth(0), ProfileScanned(false) {}
 
 Inliner::Inliner(char &ID, int Threshold) 
-  : CallGraphSCCPass(ID), InlineThreshold(Threshold) {}
+  : CallGraphSCCPass(ID), InlineThreshold(Threshold), PI(0),
+    MaxCallSiteCount(0), ModuleSize(0), HotGrowth(0), ProfileScanned(false) {}
 
 /// getAnalysisUsage - For this class, we declare that we require and preserve
 /// the call graph.  If the derived class implements this method, it should
 /// always explicitly call the implementation here.
 void Inliner::getAnalysisUsage(AnalysisUsage &Info) const {
+  if (InlineProfile)
+    Info.addRequired<ProfileInfo>();
   CallGraphSCCPass::getAnalysisUsage(Info);
 }
 
+/// getInstructionCount - Return the number of instructions in F.
+static unsigned getInstructionCount(const Function *F) {
+  unsigned Size = 0;
+  for (Function::const_iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+    Size += BB->size();
+  return Size;
+}
+
 
 typedef DenseMap<const ArrayType*, std::vector<AllocaInst*> >
 InlinedArrayAllocasTy;
@@ -193,9 +232,73 @@ unsigned Inliner::getInlineThreshold(CallSite CS) const {
       Callee->hasFnAttr(Attribute::InlineHint))
     thres = HintThreshold;
 
+  // Listen to the profile.  Cold call sites are only inlined when that makes
+  // the code smaller; hot ones get a higher threshold until inlining at hot
+  // call sites has used up the growth budget.
+  if (PI) {
+    if (isColdCallSite(CS))
+      return 0;
+    if (HotThreshold > thres && isHotCallSite(CS) &&
+        HotGrowth < (uint64_t)ModuleSize * GrowthBudget / 100)
+      thres = HotThreshold;
+  }
+
   return thres;
 }
 
+double Inliner::getCallSiteCount(CallSite CS) const {
+  if (!PI)
+    return ProfileInfo::MissingValue;
+  DenseMap<const Instruction*, double>::const_iterator I =
+    CallSiteCounts.find(CS.getInstruction());
+  if (I != CallSiteCounts.end())
+    return I->second;
+  return PI->getExecutionCount(CS.getInstruction()->getParent());
+}
+
+bool Inliner::isHotCallSite(CallSite CS) const {
+  if (MaxCallSiteCount <= 0)
+    return false;
+  double Count = getCallSiteCount(CS);
+  return Count >= 0 && Count * HotCallSiteFraction >= MaxCallSiteCount;
+}
+
+bool Inliner::isColdCallSite(CallSite CS) const {
+  if (MaxCallSiteCount <= 0)
+    return false;
+  double Count = getCallSiteCount(CS);
+  return Count >= 0 && Count * ColdCallSiteFraction <= MaxCallSiteCount;
+}
+
+/// scanProfile - Find the count of the hottest call site in the module, which
+/// hot and cold call sites are measured against, and the size of the module,
+/// which the growth budget is measured against.
+void Inliner::scanProfile(CallGraph &CG) {
+  Module &M = CG.getModule();
+  MaxCallSiteCount = 0;
+  ModuleSize = 0;
+  HotGrowth = 0;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    if (F->isDeclaration())
+      continue;
+    for (Function::iterator BB = F->begin(), BE = F->end(); BB != BE; ++BB) {
+      ModuleSize += BB->size();
+      for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE; ++I) {
+        CallSite CS(cast<Value>(I));
+        if (!CS || isa<IntrinsicInst>(I))
+          continue;
+        MaxCallSiteCount = std::max(MaxCallSiteCount,
+                                    PI->getExecutionCount(BB));
+        break;
+      }
+    }
+  }
+  ProfileScanned = true;
+  DEBUG(dbgs() << "Inliner profile: hottest call site count = "
+               << MaxCallSiteCount << ", module size = " << ModuleSize
+               << '\n');
+}
+
 /// shouldInline - Return true if the inliner should attempt to inline
 /// at the given CallSite.
 bool Inliner::shouldInline(CallSite CS) {
@@ -309,6 +412,10 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
   CallGraph &CG = getAnalysis<CallGraph>();
   const TargetData *TD = getAnalysisIfAvailable<TargetData>();
 
+  PI = InlineProfile ? &getAnalysis<ProfileInfo>() : 0;
+  if (PI && !ProfileScanned)
+    scanProfile(CG);
+
   SmallPtrSet<Function*, 8> SCCFunctions;
   DEBUG(dbgs() << "Inliner visiting SCC:");
   for (CallGraphSCC::iterator I = SCC.begin(), E = SCC.end(); I != E; ++I) {
@@ -347,6 +454,8 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
           continue;
         
         CallSites.push_back(std::make_pair(CS, -1));
+        if (PI)
+          CallSiteCounts[I] = PI->getExecutionCount(BB);
       }
   }
 
@@ -415,10 +524,20 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
         if (!shouldInline(CS))
           continue;
 
+        // Remember what the profile says about this call site before
+        // inlining removes it.
+        double Count = getCallSiteCount(CS);
+        bool Hot = PI && isHotCallSite(CS);
+        unsigned CalleeSize = Hot ? getInstructionCount(Callee) : 0;
+
         // Attempt to inline the function.
         if (!InlineCallIfPossible(CS, InlineInfo, InlinedArrayAllocas))
           continue;
         ++NumInlined;
+        if (Hot) {
+          HotGrowth += CalleeSize;
+          ++NumHotInlined;
+        }
         
         // If inlining this function gave us any new call sites, throw them
         // onto our worklist to process.  They are useful inline candidates.
@@ -432,6 +551,8 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
                i != e; ++i) {
             Value *Ptr = InlineInfo.InlinedCalls[i];
             CallSites.push_back(std::make_pair(CallSite(Ptr), NewHistoryID));
+            if (PI)
+              CallSiteCounts[cast<Instruction>(Ptr)] = Count;
           }
         }
         
@@ -467,6 +588,7 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
       // swap/pop_back for efficiency, but do not use it if doing so would
       // move a call site to a function in this SCC before the
       // 'FirstCallInSCC' barrier.
+      CallSiteCounts.erase(CallSites[CSi].first.getInstruction());
       if (SCC.isSingular()) {
         CallSites[CSi] = CallSites.back();
         CallSites.pop_back();
@@ -480,12 +602,14 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
     }
   } while (LocalChange);
 
+  CallSiteCounts.clear();
   return Changed;
 }
 
 // doFinalization - Remove now-dead linkonce functions at the end of
 // processing to avoid breaking the SCC traversal.
 bool Inliner::doFinalization(CallGraph &CG) {
+  ProfileScanned = false;
   return removeDeadFunctions(CG);
 }
 
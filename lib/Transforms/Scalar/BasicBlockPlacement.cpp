@@ -10,16 +10,16 @@
 // This file implements a very simple profile guided basic block placement
 // algorithm.  The idea is to put frequently executed blocks together at the
 // start of the function, and hopefully increase the number of fall-through
-// conditional branches.  If there is no profile information for a particular
-// function, this pass basically orders blocks in depth-first order
+// conditional branches.  The edge weights come from BranchProbabilityInfo, so
+// profile counts are used when they are available and static branch
+// heuristics otherwise.
 //
 // The algorithm implemented here is basically "Algo1" from "Profile Guided Code
-// Positioning" by Pettis and Hansen, except that it uses basic block counts
-// instead of edge counts.  This should be improved in many ways, but is very
-// simple for now.
+// Positioning" by Pettis and Hansen.  This should be improved in many ways, but
+// is very simple for now.
 //
 // Basically we "place" the entry block, then loop over all successors in a DFO,
-// placing the most frequently executed successor until we run out of blocks.  I
+// placing the most likely successor until we run out of blocks.  I
 // told you this was _extremely_ simplistic. :) This is also much slower than it
 // could be.  When it becomes important, this pass will be rewritten to use a
 // better algorithm, and then we can worry about efficiency.
@@ -27,7 +27,7 @@
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "block-placement"
-#include "llvm/Analysis/ProfileInfo.h"
+#include "llvm/Analysis/BranchProbabilityInfo.h"
 #include "llvm/Function.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CFG.h"
@@ -47,13 +47,12 @@ namespace {
 
     virtual void getAnalysisUsage(AnalysisUsage &AU) const {
       AU.setPreservesCFG();
-      AU.addRequired<ProfileInfo>();
-      //AU.addPreserved<ProfileInfo>();  // Does this work?
+      AU.addRequired<BranchProbabilityInfo>();
     }
   private:
-    /// PI - The profile information that is guiding us.
+    /// BPI - The branch probabilities that are guiding us.
     ///
-    ProfileInfo *PI;
+    BranchProbabilityInfo *BPI;
 
     /// NumMovedBlocks - Every time we move a block, increment this counter.
     ///
@@ -76,14 +75,14 @@ namespace {
 char BlockPlacement::ID = 0;
 INITIALIZE_PASS_BEGIN(BlockPlacement, "block-placement",
                 "Profile Guided Basic Block Placement", false, false)
-INITIALIZE_AG_DEPENDENCY(ProfileInfo)
+INITIALIZE_PASS_DEPENDENCY(BranchProbabilityInfo)
 INITIALIZE_PASS_END(BlockPlacement, "block-placement",
                 "Profile Guided Basic Block Placement", false, false)
 
 FunctionPass *llvm::createBlockPlacementPass() { return new BlockPlacement(); }
 
 bool BlockPlacement::runOnFunction(Function &F) {
-  PI = &getAnalysis<ProfileInfo>();
+  BPI = &getAnalysis<BranchProbabilityInfo>();
 
   NumMovedBlocks = 0;
   InsertPos = F.begin();
@@ -129,17 +128,17 @@ void BlockPlacement::PlaceBlocks(BasicBlock *BB) {
       /*empty*/;
     if (SI == E) return;  // No more successors to place.
 
-    double MaxExecutionCount = PI->getExecutionCount(*SI);
+    uint32_t MaxWeight = BPI->getEdgeWeight(BB, *SI);
     BasicBlock *MaxSuccessor = *SI;
 
-    // Scan for more frequently executed successors
+    // Scan for more likely successors
     for (; SI != E; ++SI)
       if (!PlacedBlocks.count(*SI)) {
-        double Count = PI->getExecutionCount(*SI);
-        if (Count > MaxExecutionCount ||
+        uint32_t Weight = BPI->getEdgeWeight(BB, *SI);
+        if (Weight > MaxWeight ||
             // Prefer to not disturb the code.
-            (Count == MaxExecutionCount && *SI == &*InsertPos)) {
-          MaxExecutionCount = Count;
+            (Weight == MaxWeight && *SI == &*InsertPos)) {
+          MaxWeight = Weight;
           MaxSuccessor = *SI;
         }
       }
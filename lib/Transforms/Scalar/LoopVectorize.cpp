@@ -0,0 +1,977 @@
+//===- LoopVectorize.cpp - Widen innermost loops into vector code ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass rewrites simple innermost loops so that each iteration of a new
+// vector loop does the work of several consecutive iterations of the original
+// loop, using one lane of a vector value for each of them.  For example,
+//
+//   for (i = 0; i != n; ++i)
+//     a[i] = b[i] * k + c[i];
+//
+// becomes a loop over i += 4 that loads, multiplies, adds and stores
+// <4 x float> values, followed by the original loop, which finishes the last
+// few iterations.
+//
+// The loops handled are single-block, rotated loops whose trip count
+// ScalarEvolution can compute, whose header phis are induction variables with
+// a constant step or integer reductions (add, mul, and, or, xor), and whose
+// loads and stores access consecutive elements or, for loads, a loop-invariant
+// address.  Control flow, calls, compares and selects inside the loop are not
+// supported.
+//
+// The scalar loop always runs at least one iteration after the vector loop, so
+// values used after the loop still come from it.  The vector loop is bypassed
+// when the trip count is too small, or when a run-time check finds that the
+// memory ranges accessed through pointers that alias analysis cannot tell
+// apart overlap.
+//
+// The width is chosen by a cost model that asks the target which vector types
+// and operations are legal, if the pass was given a TargetLowering, and that
+// otherwise assumes vector registers of -vector-register-bits bits.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "loop-vectorize"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Constants.h"
+#include "llvm/Instructions.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Target/TargetData.h"
+#include "llvm/Target/TargetLowering.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/IRBuilder.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+using namespace llvm;
+
+STATISTIC(NumVectorized,    "Number of loops vectorized");
+STATISTIC(NumRuntimeChecks, "Number of run-time overlap checks inserted");
+
+static cl::opt<unsigned>
+ForceVectorWidth("force-vector-width", cl::init(0), cl::Hidden,
+                 cl::desc("Vectorize loops with this many lanes, ignoring the "
+                          "cost model but not dependences"));
+
+static cl::opt<unsigned>
+VectorRegisterBits("vector-register-bits", cl::init(128), cl::Hidden,
+                   cl::desc("Size of the vector registers the loop vectorizer "
+                            "assumes when it has no target information"));
+
+static cl::opt<unsigned>
+MaxRuntimeChecks("vectorize-max-runtime-checks", cl::init(8), cl::Hidden,
+                 cl::desc("Maximum number of pointer pairs the loop "
+                          "vectorizer checks for overlap at run time"));
+
+/// MaxVectorWidth - The widest vector the cost model considers.
+static const unsigned MaxVectorWidth = 16;
+
+namespace {
+  /// MemAccess - A load or store in a loop being vectorized.
+  struct MemAccess {
+    Instruction *Inst;
+    Value *Ptr;
+    uint64_t Size;      // Bytes accessed by each scalar iteration.
+    bool IsStore;
+    bool Consecutive;   // Ptr advances by Size bytes each iteration; otherwise
+                        // it is loop invariant.
+  };
+
+  /// Reduction - A header phi that accumulates a value with an associative
+  /// and commutative operator, so that each lane can keep a partial result
+  /// that is combined with the others after the loop.
+  struct Reduction {
+    PHINode *Phi;
+    Instruction::BinaryOps Opcode;
+    Instruction *LoopValue;   // The value the phi takes on the back edge.
+  };
+
+  /// LoopVectorizer - Check whether one loop can be vectorized, and do it.
+  class LoopVectorizer {
+    Loop *L;
+    ScalarEvolution *SE;
+    AliasAnalysis *AA;
+    DominatorTree *DT;
+    LoopInfo *LI;
+    const TargetData *TD;
+    const TargetLowering *TLI;
+
+    BasicBlock *Preheader, *Header, *ExitBlock;
+    const SCEV *BackedgeTakenCount;
+
+    /// Inductions - Header phis that are affine recurrences with a constant
+    /// step, mapped to that step (in bytes for pointers).
+    DenseMap<PHINode*, ConstantInt*> Inductions;
+    SmallVector<Reduction, 4> Reductions;
+    SmallVector<MemAccess, 8> Accesses;
+
+    /// Uniforms - Instructions that are only used to compute addresses or to
+    /// control the loop.  They are not widened; the vector loop computes their
+    /// value for the first lane when it needs it.
+    SmallPtrSet<Instruction*, 16> Uniforms;
+
+    /// Widened - The instructions that are turned into vector instructions.
+    SmallVector<Instruction*, 16> Widened;
+
+    /// Checks - Pairs of Accesses whose ranges must be checked for overlap
+    /// before entering the vector loop.
+    SmallVector<std::pair<unsigned, unsigned>, 4> Checks;
+
+    /// MaxSafeWidth - The widest vector that does not break a dependence
+    /// between accesses a constant distance apart.
+    unsigned MaxSafeWidth;
+
+    // State used while emitting the vector loop.
+    unsigned VF;
+    IRBuilder<> Builder;
+    PHINode *Index;
+    DenseMap<Value*, Value*> VectorValues, Lane0Values, SplatValues;
+
+  public:
+    LoopVectorizer(Loop *l, Pass *P, const TargetLowering *tli)
+      : L(l), SE(&P->getAnalysis<ScalarEvolution>()),
+        AA(&P->getAnalysis<AliasAnalysis>()),
+        DT(&P->getAnalysis<DominatorTree>()), LI(&P->getAnalysis<LoopInfo>()),
+        TD(P->getAnalysisIfAvailable<TargetData>()), TLI(tli),
+        MaxSafeWidth(MaxVectorWidth), VF(0),
+        Builder(l->getHeader()->getContext()), Index(0) {}
+
+    /// run - Vectorize the loop if that is legal and the cost model finds a
+    /// width worth using.  Return true if the loop was changed.
+    bool run();
+
+  private:
+    bool canVectorize();
+    bool isInduction(PHINode *PN);
+    bool isReduction(PHINode *PN);
+    void findUniforms();
+    bool isWidenableType(const Type *Ty) const;
+    bool addAccess(Instruction *I, Value *Ptr, bool IsStore);
+    bool checkDependences();
+    unsigned chooseWidth();
+    bool isLegalWidth(unsigned Width) const;
+
+    void vectorize();
+    Value *getVectorValue(Value *V);
+    Value *getLane0Value(Value *V);
+    Value *getSplat(Value *V);
+    Value *getRangeStart(const MemAccess &A, DenseMap<Value*, Value*> &Cache,
+                         SCEVExpander &Exp);
+    void widen(Instruction *I);
+    unsigned getAlignment(Instruction *I, const Type *Ty) const;
+  };
+}
+
+bool LoopVectorizer::run() {
+  if (!canVectorize())
+    return false;
+
+  VF = chooseWidth();
+  if (VF < 2) {
+    DEBUG(dbgs() << "LV: No profitable vector width.\n");
+    return false;
+  }
+
+  // Short loops spend all their time in the scalar epilogue anyway.
+  if (const SCEVConstant *C = dyn_cast<SCEVConstant>(BackedgeTakenCount))
+    if (C->getValue()->getValue().ult(2 * VF - 1)) {
+      DEBUG(dbgs() << "LV: Trip count too small.\n");
+      return false;
+    }
+
+  DEBUG(dbgs() << "LV: Vectorizing " << Header->getName() << " with width "
+               << VF << ".\n");
+  vectorize();
+  ++NumVectorized;
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Legality
+//===----------------------------------------------------------------------===//
+
+bool LoopVectorizer::canVectorize() {
+  if (!TD || !L->empty() || L->getBlocks().size() != 1)
+    return false;
+
+  Header = L->getHeader();
+  Preheader = L->getLoopPreheader();
+  ExitBlock = L->getExitBlock();
+  if (!Preheader || !ExitBlock)
+    return false;
+  BranchInst *BI = dyn_cast<BranchInst>(Header->getTerminator());
+  if (!BI || !BI->isConditional())
+    return false;
+
+  BackedgeTakenCount = SE->getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BackedgeTakenCount)) {
+    DEBUG(dbgs() << "LV: Unknown trip count.\n");
+    return false;
+  }
+
+  for (BasicBlock::iterator I = Header->begin(); isa<PHINode>(I); ++I) {
+    PHINode *PN = cast<PHINode>(I);
+    if (!isInduction(PN) && !isReduction(PN)) {
+      DEBUG(dbgs() << "LV: Unsupported phi: " << *PN);
+      return false;
+    }
+  }
+
+  for (BasicBlock::iterator I = Header->getFirstNonPHI(), E = BI; I != E; ++I){
+    if (LoadInst *LD = dyn_cast<LoadInst>(I)) {
+      if (LD->isVolatile() || !addAccess(LD, LD->getPointerOperand(), false))
+        return false;
+    } else if (StoreInst *ST = dyn_cast<StoreInst>(I)) {
+      if (ST->isVolatile() || !addAccess(ST, ST->getPointerOperand(), true))
+        return false;
+    } else if (!isa<BinaryOperator>(I) && !isa<CastInst>(I) &&
+               !isa<GetElementPtrInst>(I) && !isa<CmpInst>(I)) {
+      DEBUG(dbgs() << "LV: Unsupported instruction: " << *I);
+      return false;
+    }
+  }
+
+  findUniforms();
+
+  for (BasicBlock::iterator I = Header->getFirstNonPHI(), E = BI; I != E; ++I){
+    if (Uniforms.count(I))
+      continue;
+    bool OK;
+    if (isa<LoadInst>(I))
+      OK = isWidenableType(I->getType());
+    else if (StoreInst *ST = dyn_cast<StoreInst>(I))
+      OK = isWidenableType(ST->getOperand(0)->getType());
+    else if (isa<BinaryOperator>(I))
+      OK = isWidenableType(I->getType());
+    else if (isa<CastInst>(I))
+      OK = isWidenableType(I->getType()) &&
+           isWidenableType(I->getOperand(0)->getType());
+    else
+      OK = false;
+    if (!OK) {
+      DEBUG(dbgs() << "LV: Cannot widen: " << *I);
+      return false;
+    }
+    Widened.push_back(I);
+  }
+
+  // Addresses must be computed from induction variables and invariants only.
+  for (unsigned i = 0, e = Accesses.size(); i != e; ++i) {
+    Instruction *Ptr = dyn_cast<Instruction>(Accesses[i].Ptr);
+    if (Ptr && L->contains(Ptr) && !Uniforms.count(Ptr) &&
+        !(isa<PHINode>(Ptr) && Inductions.count(cast<PHINode>(Ptr)))) {
+      DEBUG(dbgs() << "LV: Unsupported address: " << *Ptr);
+      return false;
+    }
+  }
+
+  // Widened users of an induction variable need its vector form, which only
+  // exists for integers.
+  for (DenseMap<PHINode*, ConstantInt*>::iterator I = Inductions.begin(),
+       E = Inductions.end(); I != E; ++I) {
+    if (!I->first->getType()->isPointerTy())
+      continue;
+    for (Value::use_iterator UI = I->first->use_begin(),
+         UE = I->first->use_end(); UI != UE; ++UI) {
+      Instruction *U = cast<Instruction>(*UI);
+      if (!L->contains(U) || Uniforms.count(U) || isa<PHINode>(U) ||
+          isa<BranchInst>(U))
+        continue;
+      if (isa<LoadInst>(U) ||
+          (isa<StoreInst>(U) && U->getOperand(0) != I->first))
+        continue;
+      return false;
+    }
+  }
+
+  return checkDependences();
+}
+
+/// isInduction - Return true and record PN if it is an affine recurrence with
+/// a constant step.
+bool LoopVectorizer::isInduction(PHINode *PN) {
+  const Type *Ty = PN->getType();
+  if (!Ty->isIntegerTy() && !Ty->isPointerTy())
+    return false;
+  const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(PN));
+  if (!AR || AR->getLoop() != L || !AR->isAffine())
+    return false;
+  const SCEVConstant *Step = dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+  if (!Step)
+    return false;
+  Inductions[PN] = Step->getValue();
+  return true;
+}
+
+/// isReduction - Return true and record PN if it accumulates a chain of
+/// integer operations with the same associative and commutative opcode, and
+/// nothing else in the loop uses the partial results.
+bool LoopVectorizer::isReduction(PHINode *PN) {
+  if (!PN->getType()->isIntegerTy())
+    return false;
+  BinaryOperator *LoopValue =
+    dyn_cast<BinaryOperator>(PN->getIncomingValueForBlock(Header));
+  if (!LoopValue || !L->contains(LoopValue))
+    return false;
+
+  Instruction::BinaryOps Opcode = LoopValue->getOpcode();
+  switch (Opcode) {
+  case Instruction::Add: case Instruction::Mul:
+  case Instruction::And: case Instruction::Or: case Instruction::Xor:
+    break;
+  default:
+    return false;
+  }
+
+  // The final value may be used after the loop, but only the phi may use it
+  // inside the loop.
+  for (Value::use_iterator UI = LoopValue->use_begin(),
+       UE = LoopValue->use_end(); UI != UE; ++UI)
+    if (*UI != PN && L->contains(cast<Instruction>(*UI)))
+      return false;
+
+  // Walk the chain back to the phi.  Each link but the last must have exactly
+  // one use, the next link.
+  BinaryOperator *Link = LoopValue;
+  for (;;) {
+    Value *Op0 = Link->getOperand(0), *Op1 = Link->getOperand(1);
+    if (Op0 == PN || Op1 == PN) {
+      if (Op0 == Op1)
+        return false;
+      break;
+    }
+    BinaryOperator *Next = 0;
+    for (unsigned i = 0; i != 2; ++i) {
+      BinaryOperator *Op = dyn_cast<BinaryOperator>(Link->getOperand(i));
+      if (!Op || Op->getOpcode() != Opcode || !L->contains(Op) ||
+          !Op->hasOneUse())
+        continue;
+      if (Next)
+        return false;   // Ambiguous.
+      Next = Op;
+    }
+    if (!Next)
+      return false;
+    Link = Next;
+  }
+  // Besides the first link, the phi may only be used after the loop.
+  for (Value::use_iterator UI = PN->use_begin(), UE = PN->use_end();
+       UI != UE; ++UI)
+    if (*UI != Link && L->contains(cast<Instruction>(*UI)))
+      return false;
+
+  Reduction R = { PN, Opcode, LoopValue };
+  Reductions.push_back(R);
+  return true;
+}
+
+/// findUniforms - Find the instructions whose only users in the loop compute
+/// addresses, control the loop, or step an induction variable.
+void LoopVectorizer::findUniforms() {
+  Instruction *Term = Header->getTerminator();
+  for (BasicBlock::iterator I = Header->getFirstNonPHI(); &*I != Term; ++I)
+    if (isa<BinaryOperator>(I) || isa<CastInst>(I) ||
+        isa<GetElementPtrInst>(I) || isa<CmpInst>(I))
+      Uniforms.insert(I);
+
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (BasicBlock::iterator I = Header->getFirstNonPHI(); &*I != Term; ++I) {
+      if (!Uniforms.count(I))
+        continue;
+      for (Value::use_iterator UI = I->use_begin(), UE = I->use_end();
+           UI != UE; ++UI) {
+        Instruction *U = cast<Instruction>(*UI);
+        if (!L->contains(U) || U == Term || Uniforms.count(U))
+          continue;
+        if (PHINode *PN = dyn_cast<PHINode>(U))
+          if (Inductions.count(PN))
+            continue;
+        if (isa<LoadInst>(U))
+          continue;
+        if (isa<StoreInst>(U) && U->getOperand(0) != &*I)
+          continue;
+        Uniforms.erase(I);
+        Changed = true;
+        break;
+      }
+    }
+  }
+}
+
+bool LoopVectorizer::isWidenableType(const Type *Ty) const {
+  if (!Ty->isIntegerTy() && !Ty->isFloatingPointTy())
+    return false;
+  // Vectors of types with padding, like x86_fp80, are not laid out like
+  // arrays of them.
+  return TD->getTypeAllocSizeInBits(Ty) == TD->getTypeSizeInBits(Ty);
+}
+
+/// addAccess - Record a load or store, and return false if its address is
+/// neither consecutive nor, for loads, invariant.
+bool LoopVectorizer::addAccess(Instruction *I, Value *Ptr, bool IsStore) {
+  const Type *Ty = cast<PointerType>(Ptr->getType())->getElementType();
+  if (!isWidenableType(Ty))
+    return false;
+
+  MemAccess A = { I, Ptr, TD->getTypeAllocSize(Ty), IsStore, false };
+  const SCEV *S = SE->getSCEV(Ptr);
+  if (S->isLoopInvariant(L)) {
+    if (IsStore) {
+      DEBUG(dbgs() << "LV: Store to an invariant address: " << *I);
+      return false;
+    }
+  } else {
+    const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(S);
+    const SCEVConstant *Step = AR && AR->getLoop() == L && AR->isAffine() ?
+      dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE)) : 0;
+    if (!Step || Step->getValue()->getValue() != A.Size) {
+      DEBUG(dbgs() << "LV: Non-consecutive access: " << *I);
+      return false;
+    }
+    A.Consecutive = true;
+  }
+  Accesses.push_back(A);
+  return true;
+}
+
+/// checkDependences - Look at each pair of accesses that includes a store.
+/// Pairs that alias analysis cannot separate are either a constant distance
+/// apart, which limits the vector width, or get a run-time overlap check.
+bool LoopVectorizer::checkDependences() {
+  for (unsigned i = 0, e = Accesses.size(); i != e; ++i)
+    for (unsigned j = i + 1; j != e; ++j) {
+      const MemAccess &A = Accesses[i], &B = Accesses[j];
+      if (!A.IsStore && !B.IsStore)
+        continue;
+      if (AA->alias(A.Ptr, AliasAnalysis::UnknownSize,
+                    B.Ptr, AliasAnalysis::UnknownSize) == AliasAnalysis::NoAlias)
+        continue;
+
+      if (A.Consecutive && B.Consecutive && A.Size == B.Size) {
+        const SCEV *Dist = SE->getMinusSCEV(SE->getSCEV(A.Ptr),
+                                            SE->getSCEV(B.Ptr));
+        if (const SCEVConstant *C = dyn_cast<SCEVConstant>(Dist)) {
+          // Accesses in the same iteration stay in the same lane, in program
+          // order.  Otherwise a vector must not span the distance.
+          uint64_t D = C->getValue()->getValue().abs().getLimitedValue();
+          if (D == 0)
+            continue;
+          unsigned Width = 1;
+          while (Width * 2 <= MaxSafeWidth && Width * 2 * A.Size <= D)
+            Width *= 2;
+          MaxSafeWidth = Width;
+          if (MaxSafeWidth < 2) {
+            DEBUG(dbgs() << "LV: Dependence distance too short: "
+                         << *A.Inst << *B.Inst);
+            return false;
+          }
+          continue;
+        }
+      }
+
+      if (Checks.size() == MaxRuntimeChecks) {
+        DEBUG(dbgs() << "LV: Too many run-time checks.\n");
+        return false;
+      }
+      Checks.push_back(std::make_pair(i, j));
+    }
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Cost model
+//===----------------------------------------------------------------------===//
+
+/// getISDOpcode - Return the SelectionDAG opcode that a binary operator of
+/// the given kind is lowered to.
+static unsigned getISDOpcode(Instruction::BinaryOps Opcode) {
+  switch (Opcode) {
+  default: llvm_unreachable("Unknown binary operator!");
+  case Instruction::Add:  return ISD::ADD;
+  case Instruction::FAdd: return ISD::FADD;
+  case Instruction::Sub:  return ISD::SUB;
+  case Instruction::FSub: return ISD::FSUB;
+  case Instruction::Mul:  return ISD::MUL;
+  case Instruction::FMul: return ISD::FMUL;
+  case Instruction::UDiv: return ISD::UDIV;
+  case Instruction::SDiv: return ISD::SDIV;
+  case Instruction::FDiv: return ISD::FDIV;
+  case Instruction::URem: return ISD::UREM;
+  case Instruction::SRem: return ISD::SREM;
+  case Instruction::FRem: return ISD::FREM;
+  case Instruction::Shl:  return ISD::SHL;
+  case Instruction::LShr: return ISD::SRL;
+  case Instruction::AShr: return ISD::SRA;
+  case Instruction::And:  return ISD::AND;
+  case Instruction::Or:   return ISD::OR;
+  case Instruction::Xor:  return ISD::XOR;
+  }
+}
+
+/// isLegalWidth - Return true if the target can hold every widened value in a
+/// vector register of the given width and has instructions for every widened
+/// operation on it, so that nothing is split up again into scalars.
+bool LoopVectorizer::isLegalWidth(unsigned Width) const {
+  LLVMContext &Ctx = Header->getContext();
+  for (unsigned i = 0, e = Widened.size(); i != e; ++i) {
+    Instruction *I = Widened[i];
+    const Type *Ty = isa<StoreInst>(I) ? I->getOperand(0)->getType()
+                                       : I->getType();
+    EVT VT = EVT::getVectorVT(Ctx, EVT::getEVT(Ty), Width);
+    if (!TLI->isTypeLegal(VT))
+      return false;
+    if (BinaryOperator *BO = dyn_cast<BinaryOperator>(I)) {
+      if (!TLI->isOperationLegalOrCustom(getISDOpcode(BO->getOpcode()), VT))
+        return false;
+    } else if (isa<CastInst>(I)) {
+      EVT SrcVT = EVT::getVectorVT(Ctx, EVT::getEVT(I->getOperand(0)->getType()),
+                                   Width);
+      if (!TLI->isTypeLegal(SrcVT))
+        return false;
+    }
+  }
+  return true;
+}
+
+/// chooseWidth - Pick the number of lanes, or return 0 or 1 if the loop is
+/// not worth vectorizing.
+unsigned LoopVectorizer::chooseWidth() {
+  // A forced width still has to be a power of two, and must not span a
+  // dependence distance, so round it down to the nearest width that is safe.
+  if (ForceVectorWidth) {
+    unsigned Width = 1;
+    while (Width * 2 <= ForceVectorWidth && Width * 2 <= MaxSafeWidth)
+      Width *= 2;
+    if (Width != ForceVectorWidth)
+      DEBUG(dbgs() << "LV: Forced width " << ForceVectorWidth
+                   << " reduced to " << Width << ".\n");
+    return Width;
+  }
+
+  if (TLI) {
+    for (unsigned Width = MaxSafeWidth; Width >= 2; Width /= 2)
+      if (isLegalWidth(Width))
+        return Width;
+    return 0;
+  }
+
+  uint64_t WidestBits = 8;
+  for (unsigned i = 0, e = Widened.size(); i != e; ++i) {
+    Instruction *I = Widened[i];
+    const Type *Ty = isa<StoreInst>(I) ? I->getOperand(0)->getType()
+                                       : I->getType();
+    WidestBits = std::max(WidestBits, TD->getTypeSizeInBits(Ty));
+    if (isa<CastInst>(I))
+      WidestBits = std::max(WidestBits,
+                            TD->getTypeSizeInBits(I->getOperand(0)->getType()));
+  }
+  unsigned Width = 1;
+  while (Width * 2 <= MaxSafeWidth &&
+         Width * 2 * WidestBits <= VectorRegisterBits)
+    Width *= 2;
+  return Width;
+}
+
+//===----------------------------------------------------------------------===//
+// Code generation
+//===----------------------------------------------------------------------===//
+
+unsigned LoopVectorizer::getAlignment(Instruction *I, const Type *Ty) const {
+  unsigned Align = isa<LoadInst>(I) ? cast<LoadInst>(I)->getAlignment()
+                                    : cast<StoreInst>(I)->getAlignment();
+  // A vector access without an alignment would assume that of the vector.
+  return Align ? Align : TD->getABITypeAlignment(Ty);
+}
+
+/// getSplat - Return a vector with V in every lane.  Values available in the
+/// preheader are splatted there; anything the vector loop computes itself is
+/// splatted at the current insertion point, after its definition.
+Value *LoopVectorizer::getSplat(Value *V) {
+  const VectorType *VTy = VectorType::get(V->getType(), VF);
+  if (Constant *C = dyn_cast<Constant>(V))
+    return ConstantVector::get(std::vector<Constant*>(VF, C));
+
+  Value *&Splat = SplatValues[V];
+  if (Splat)
+    return Splat;
+
+  IRBuilder<>::InsertPoint IP = Builder.saveIP();
+  // The vector body is not in the dominator tree yet, so its values never
+  // dominate the preheader.
+  Instruction *I = dyn_cast<Instruction>(V);
+  if (!I || DT->dominates(I->getParent(), Preheader))
+    Builder.SetInsertPoint(Preheader, Preheader->getTerminator());
+  const Type *Int32Ty = Builder.getInt32Ty();
+  Value *Ins = Builder.CreateInsertElement(UndefValue::get(VTy), V,
+                                           ConstantInt::get(Int32Ty, 0));
+  Splat = Builder.CreateShuffleVector(Ins, UndefValue::get(VTy),
+                   ConstantAggregateZero::get(VectorType::get(Int32Ty, VF)),
+                   V->getName() + ".splat");
+  Builder.restoreIP(IP);
+  return Splat;
+}
+
+/// getLane0Value - Return the value V has in the first lane of the current
+/// vector iteration, that is, in the scalar iteration numbered Index.
+Value *LoopVectorizer::getLane0Value(Value *V) {
+  Instruction *I = dyn_cast<Instruction>(V);
+  if (!I || !L->contains(I))
+    return V;
+
+  Value *&Lane0 = Lane0Values[V];
+  if (Lane0)
+    return Lane0;
+
+  if (PHINode *PN = dyn_cast<PHINode>(I)) {
+    assert(Inductions.count(PN) && "Only inductions have a lane 0 value!");
+    ConstantInt *Step = Inductions[PN];
+    Value *Start = PN->getIncomingValueForBlock(Preheader);
+    Value *Offset = Builder.CreateMul(
+      Builder.CreateIntCast(Index, Step->getType(), false), Step);
+    Value *Result;
+    if (PN->getType()->isPointerTy()) {
+      Value *Base = Builder.CreateBitCast(Start, Builder.getInt8PtrTy());
+      Result = Builder.CreateBitCast(Builder.CreateGEP(Base, Offset),
+                                     PN->getType());
+    } else {
+      Result = Builder.CreateAdd(Start, Offset);
+    }
+    Result->setName(PN->getName() + ".lane0");
+    return Lane0Values[V] = Result;
+  }
+
+  Instruction *C = I->clone();
+  for (unsigned i = 0, e = C->getNumOperands(); i != e; ++i)
+    C->setOperand(i, getLane0Value(I->getOperand(i)));
+  Builder.Insert(C, I->getName() + ".lane0");
+  return Lane0Values[V] = C;
+}
+
+/// getVectorValue - Return the vector of the values V has in each lane of the
+/// current vector iteration.
+Value *LoopVectorizer::getVectorValue(Value *V) {
+  if (Value *Vec = VectorValues.lookup(V))
+    return Vec;
+
+  Instruction *I = dyn_cast<Instruction>(V);
+  if (!I || !L->contains(I))
+    return getSplat(V);
+
+  // Widened instructions are emitted in order, so the only values not yet
+  // mapped are integer induction variables: lane K holds Start+(Index+K)*Step.
+  PHINode *PN = cast<PHINode>(I);
+  assert(Inductions.count(PN) && PN->getType()->isIntegerTy() &&
+         "Widened value used before it was defined!");
+  ConstantInt *Step = Inductions[PN];
+  std::vector<Constant*> Offsets;
+  for (unsigned i = 0; i != VF; ++i)
+    Offsets.push_back(ConstantInt::get(PN->getType(),
+                                       Step->getValue() * APInt(
+                                         Step->getBitWidth(), i)));
+  Value *Vec = Builder.CreateAdd(getSplat(getLane0Value(PN)),
+                                 ConstantVector::get(Offsets),
+                                 PN->getName() + ".vec");
+  return VectorValues[V] = Vec;
+}
+
+void LoopVectorizer::widen(Instruction *I) {
+  Value *Result = 0;
+  if (LoadInst *LD = dyn_cast<LoadInst>(I)) {
+    const Type *Ty = LD->getType();
+    Value *Ptr = getLane0Value(LD->getPointerOperand());
+    if (SE->getSCEV(LD->getPointerOperand())->isLoopInvariant(L)) {
+      LoadInst *Scalar = Builder.CreateLoad(Ptr, LD->getName());
+      Scalar->setAlignment(LD->getAlignment());
+      Result = getSplat(Scalar);
+    } else {
+      const Type *VecPtrTy =
+        PointerType::get(VectorType::get(Ty, VF),
+                         LD->getPointerAddressSpace());
+      LoadInst *NewLD = Builder.CreateLoad(Builder.CreateBitCast(Ptr, VecPtrTy),
+                                           LD->getName());
+      NewLD->setAlignment(getAlignment(LD, Ty));
+      Result = NewLD;
+    }
+  } else if (StoreInst *ST = dyn_cast<StoreInst>(I)) {
+    Value *Val = ST->getOperand(0);
+    const Type *VecPtrTy =
+      PointerType::get(VectorType::get(Val->getType(), VF),
+                       ST->getPointerAddressSpace());
+    Value *Ptr = Builder.CreateBitCast(getLane0Value(ST->getPointerOperand()),
+                                       VecPtrTy);
+    StoreInst *NewST = Builder.CreateStore(getVectorValue(Val), Ptr);
+    NewST->setAlignment(getAlignment(ST, Val->getType()));
+    return;
+  } else if (BinaryOperator *BO = dyn_cast<BinaryOperator>(I)) {
+    Result = Builder.CreateBinOp(BO->getOpcode(),
+                                 getVectorValue(BO->getOperand(0)),
+                                 getVectorValue(BO->getOperand(1)),
+                                 BO->getName());
+  } else {
+    CastInst *CI = cast<CastInst>(I);
+    Result = Builder.CreateCast(CI->getOpcode(),
+                                getVectorValue(CI->getOperand(0)),
+                                VectorType::get(CI->getType(), VF),
+                                CI->getName());
+  }
+  VectorValues[I] = Result;
+}
+
+/// getRangeStart - Return the lowest address A accesses, as an i8*, expanded
+/// in the preheader.
+Value *LoopVectorizer::getRangeStart(const MemAccess &A,
+                                     DenseMap<Value*, Value*> &Cache,
+                                     SCEVExpander &Exp) {
+  Value *&Start = Cache[A.Ptr];
+  if (Start)
+    return Start;
+  const SCEV *S = SE->getSCEV(A.Ptr);
+  if (A.Consecutive)
+    S = cast<SCEVAddRecExpr>(S)->getStart();
+  Value *V = Exp.expandCodeFor(S, A.Ptr->getType(), Preheader->getTerminator());
+  return Start = Builder.CreateBitCast(V, Builder.getInt8PtrTy());
+}
+
+void LoopVectorizer::vectorize() {
+  LLVMContext &Ctx = Header->getContext();
+  Function *F = Header->getParent();
+  const Type *CountTy = BackedgeTakenCount->getType();
+  const Type *IntPtrTy = TD->getIntPtrType(Ctx);
+
+  // Everything the vector loop and the run-time checks need is computed in the
+  // preheader.  Round the iteration count down to whole vectors, leaving at
+  // least one iteration to the scalar loop so that values used after the loop
+  // still come from it.
+  SCEVExpander Exp(*SE);
+  Instruction *PreheaderTerm = Preheader->getTerminator();
+  Value *Count = Exp.expandCodeFor(BackedgeTakenCount, CountTy, PreheaderTerm);
+  Builder.SetInsertPoint(Preheader, PreheaderTerm);
+  Value *VectorCount =
+    Builder.CreateAnd(Count, ConstantInt::get(CountTy, ~uint64_t(VF - 1)),
+                      "n.vec");
+  Value *Bypass = Builder.CreateICmpEQ(VectorCount,
+                                       Constant::getNullValue(CountTy),
+                                       "vec.skip");
+
+  // The scalar loop runs all iterations if any pair of ranges overlaps.
+  DenseMap<Value*, Value*> Starts;
+  Value *Bytes = Builder.CreateAdd(Builder.CreateIntCast(Count, IntPtrTy, false),
+                                   ConstantInt::get(IntPtrTy, 1));
+  for (unsigned i = 0, e = Checks.size(); i != e; ++i) {
+    const MemAccess &A = Accesses[Checks[i].first];
+    const MemAccess &B = Accesses[Checks[i].second];
+    Value *StartA = getRangeStart(A, Starts, Exp);
+    Value *StartB = getRangeStart(B, Starts, Exp);
+    Value *EndA = Builder.CreateGEP(StartA,
+      A.Consecutive ? Builder.CreateMul(Bytes, ConstantInt::get(IntPtrTy, A.Size))
+                    : ConstantInt::get(IntPtrTy, A.Size));
+    Value *EndB = Builder.CreateGEP(StartB,
+      B.Consecutive ? Builder.CreateMul(Bytes, ConstantInt::get(IntPtrTy, B.Size))
+                    : ConstantInt::get(IntPtrTy, B.Size));
+    Value *Overlap = Builder.CreateAnd(Builder.CreateICmpULT(StartA, EndB),
+                                       Builder.CreateICmpULT(StartB, EndA),
+                                       "overlap");
+    Bypass = Builder.CreateOr(Bypass, Overlap);
+    ++NumRuntimeChecks;
+  }
+
+  // Where each induction variable resumes in the scalar loop.
+  DenseMap<PHINode*, Value*> ResumeValues;
+  for (DenseMap<PHINode*, ConstantInt*>::iterator I = Inductions.begin(),
+       E = Inductions.end(); I != E; ++I) {
+    PHINode *PN = I->first;
+    Value *Start = PN->getIncomingValueForBlock(Preheader);
+    Value *Offset = Builder.CreateMul(
+      Builder.CreateIntCast(VectorCount, I->second->getType(), false),
+      I->second);
+    if (PN->getType()->isPointerTy())
+      ResumeValues[PN] = Builder.CreateBitCast(
+        Builder.CreateGEP(Builder.CreateBitCast(Start, Builder.getInt8PtrTy()),
+                          Offset),
+        PN->getType());
+    else
+      ResumeValues[PN] = Builder.CreateAdd(Start, Offset);
+  }
+
+  // Each reduction starts with its initial value in lane 0 and the identity of
+  // its operator in the others.
+  SmallVector<Value*, 4> ReductionStarts;
+  for (unsigned i = 0, e = Reductions.size(); i != e; ++i) {
+    const Reduction &R = Reductions[i];
+    const Type *Ty = R.Phi->getType();
+    Constant *Identity;
+    switch (R.Opcode) {
+    default: llvm_unreachable("Unknown reduction!");
+    case Instruction::Add: case Instruction::Or: case Instruction::Xor:
+      Identity = Constant::getNullValue(Ty);
+      break;
+    case Instruction::Mul:
+      Identity = ConstantInt::get(Ty, 1);
+      break;
+    case Instruction::And:
+      Identity = Constant::getAllOnesValue(Ty);
+      break;
+    }
+    Constant *Identities = ConstantVector::get(
+      std::vector<Constant*>(VF, Identity));
+    ReductionStarts.push_back(Builder.CreateInsertElement(Identities,
+      R.Phi->getIncomingValueForBlock(Preheader), Builder.getInt32(0)));
+  }
+
+  SE->forgetLoop(L);
+
+  BasicBlock *VectorBody = BasicBlock::Create(Ctx, "vector.body", F, Header);
+  BasicBlock *Middle = BasicBlock::Create(Ctx, "middle.block", F, Header);
+  BasicBlock *ScalarPH = BasicBlock::Create(Ctx, "scalar.ph", F, Header);
+  PreheaderTerm->eraseFromParent();
+  BranchInst::Create(ScalarPH, VectorBody, Bypass, Preheader);
+
+  // The vector loop.
+  Builder.SetInsertPoint(VectorBody);
+  Index = Builder.CreatePHI(CountTy, "index");
+  Index->addIncoming(Constant::getNullValue(CountTy), Preheader);
+  SmallVector<PHINode*, 4> ReductionPhis;
+  for (unsigned i = 0, e = Reductions.size(); i != e; ++i) {
+    PHINode *VecPhi = Builder.CreatePHI(ReductionStarts[i]->getType(),
+                                        Reductions[i].Phi->getName() + ".vec");
+    VecPhi->addIncoming(ReductionStarts[i], Preheader);
+    VectorValues[Reductions[i].Phi] = VecPhi;
+    ReductionPhis.push_back(VecPhi);
+  }
+
+  for (unsigned i = 0, e = Widened.size(); i != e; ++i)
+    widen(Widened[i]);
+
+  Value *NextIndex = Builder.CreateAdd(Index, ConstantInt::get(CountTy, VF),
+                                       "index.next");
+  Index->addIncoming(NextIndex, VectorBody);
+  for (unsigned i = 0, e = Reductions.size(); i != e; ++i)
+    ReductionPhis[i]->addIncoming(getVectorValue(Reductions[i].LoopValue),
+                                  VectorBody);
+  Builder.CreateCondBr(Builder.CreateICmpEQ(NextIndex, VectorCount),
+                       Middle, VectorBody);
+
+  // Combine the lanes of each reduction.
+  Builder.SetInsertPoint(Middle);
+  for (unsigned i = 0, e = Reductions.size(); i != e; ++i) {
+    const Reduction &R = Reductions[i];
+    Value *Vec = getVectorValue(R.LoopValue);
+    Value *Result = Builder.CreateExtractElement(Vec, Builder.getInt32(0));
+    for (unsigned Lane = 1; Lane != VF; ++Lane)
+      Result = Builder.CreateBinOp(R.Opcode, Result,
+        Builder.CreateExtractElement(Vec, Builder.getInt32(Lane)));
+    ResumeValues[R.Phi] = Result;
+  }
+  Builder.CreateBr(ScalarPH);
+
+  // The scalar loop picks up where the vector loop stopped, or at the start if
+  // it was bypassed.
+  Builder.SetInsertPoint(ScalarPH);
+  for (BasicBlock::iterator I = Header->begin(); isa<PHINode>(I); ++I) {
+    PHINode *PN = cast<PHINode>(I);
+    int Idx = PN->getBasicBlockIndex(Preheader);
+    PHINode *Resume = Builder.CreatePHI(PN->getType(),
+                                        PN->getName() + ".resume");
+    Resume->addIncoming(PN->getIncomingValue(Idx), Preheader);
+    Resume->addIncoming(ResumeValues[PN], Middle);
+    PN->setIncomingValue(Idx, Resume);
+    PN->setIncomingBlock(Idx, ScalarPH);
+  }
+  Builder.CreateBr(Header);
+
+  // Update the analyses we preserve.
+  DT->addNewBlock(VectorBody, Preheader);
+  DT->addNewBlock(Middle, VectorBody);
+  DT->addNewBlock(ScalarPH, Preheader);
+  DT->changeImmediateDominator(Header, ScalarPH);
+
+  Loop *VectorLoop = new Loop();
+  if (Loop *Parent = L->getParentLoop()) {
+    Parent->addChildLoop(VectorLoop);
+    Parent->addBasicBlockToLoop(Middle, LI->getBase());
+    Parent->addBasicBlockToLoop(ScalarPH, LI->getBase());
+  } else {
+    LI->addTopLevelLoop(VectorLoop);
+  }
+  VectorLoop->addBasicBlockToLoop(VectorBody, LI->getBase());
+}
+
+//===----------------------------------------------------------------------===//
+// LoopVectorize pass
+//===----------------------------------------------------------------------===//
+
+namespace {
+  class LoopVectorize : public FunctionPass {
+    /// TLI - Keep a pointer of a TargetLowering to consult for the cost model.
+    const TargetLowering *TLI;
+
+  public:
+    static char ID; // Pass ID, replacement for typeid
+    explicit LoopVectorize(const TargetLowering *tli = 0)
+      : FunctionPass(ID), TLI(tli) {}
+
+    virtual bool runOnFunction(Function &F);
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequired<AliasAnalysis>();
+      AU.addRequired<DominatorTree>();
+      AU.addRequired<LoopInfo>();
+      AU.addRequired<ScalarEvolution>();
+      AU.addPreserved<DominatorTree>();
+      AU.addPreserved<LoopInfo>();
+    }
+  };
+}
+
+char LoopVectorize::ID = 0;
+INITIALIZE_PASS_BEGIN(LoopVectorize, "loop-vectorize",
+                      "Vectorize innermost loops", false, false)
+INITIALIZE_AG_DEPENDENCY(AliasAnalysis)
+INITIALIZE_PASS_DEPENDENCY(DominatorTree)
+INITIALIZE_PASS_DEPENDENCY(LoopInfo)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolution)
+INITIALIZE_PASS_END(LoopVectorize, "loop-vectorize",
+                    "Vectorize innermost loops", false, false)
+
+Pass *llvm::createLoopVectorizePass(const TargetLowering *TLI) {
+  return new LoopVectorize(TLI);
+}
+
+/// collectInnermostLoops - Append the loops in L's nest that have no subloops.
+static void collectInnermostLoops(Loop *L, SmallVectorImpl<Loop*> &Loops) {
+  if (L->empty()) {
+    Loops.push_back(L);
+    return;
+  }
+  for (Loop::iterator I = L->begin(), E = L->end(); I != E; ++I)
+    collectInnermostLoops(*I, Loops);
+}
+
+bool LoopVectorize::runOnFunction(Function &F) {
+  LoopInfo &LI = getAnalysis<LoopInfo>();
+
+  // Vectorizing a loop adds a loop, so collect the candidates first.
+  SmallVector<Loop*, 8> Loops;
+  for (LoopInfo::iterator I = LI.begin(), E = LI.end(); I != E; ++I)
+    collectInnermostLoops(*I, Loops);
+
+  bool Changed = false;
+  for (unsigned i = 0, e = Loops.size(); i != e; ++i)
+    Changed |= LoopVectorizer(Loops[i], this, TLI).run();
+  return Changed;
+}
@@ -0,0 +1,729 @@
+//===- SLPVectorize.cpp - Pack isomorphic scalar operations into vectors --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass looks for groups of stores to consecutive memory within a basic
+// block and tries to replace each group, together with the computation of the
+// stored values, by vector instructions.  For example,
+//
+//   a[0] = b[0] + c[0];
+//   a[1] = b[1] + c[1];
+//   a[2] = b[2] + c[2];
+//   a[3] = b[3] + c[3];
+//
+// becomes two <4 x i32> loads, an add and a store.  This is superword level
+// parallelism (SLP) vectorization: starting from the stores, the pass builds a
+// tree of bundles, one scalar per lane, by following the operands as long as
+// the scalars in a bundle are isomorphic, that is, binary operators or casts
+// of the same kind, or loads from consecutive addresses.  Bundles that do not
+// match are gathered into a vector with insertelement.  Scalars of the tree
+// that are also used outside of it are extracted again.
+//
+// The vector code replaces the last store of the group, so loads and stores
+// of the tree move down to it; alias analysis has to show that this does not
+// reorder them with any conflicting memory access.
+//
+// A cost model compares the number of instructions before and after.  It
+// asks the target which vector types and operations are legal, if the pass
+// was given a TargetLowering, and otherwise assumes vector registers of
+// -slp-vector-bits bits.  Straight-line code like this is what the loop
+// unroller leaves behind, so the pass is meant to run after it.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "slp-vectorize"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Constants.h"
+#include "llvm/Instructions.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Target/TargetData.h"
+#include "llvm/Target/TargetLowering.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/IRBuilder.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+using namespace llvm;
+
+STATISTIC(NumVectorized,    "Number of store groups vectorized");
+STATISTIC(NumScalarsPacked, "Number of scalar instructions packed");
+
+static cl::opt<unsigned>
+SLPVectorBits("slp-vector-bits", cl::init(128), cl::Hidden,
+              cl::desc("Size of the vector registers the SLP vectorizer "
+                       "assumes when it has no target information"));
+
+static cl::opt<int>
+SLPCostThreshold("slp-threshold", cl::init(0), cl::Hidden,
+                 cl::desc("Only vectorize if this many instructions or more "
+                          "are saved"));
+
+/// MaxVectorWidth - The widest vector the cost model considers.
+static const unsigned MaxVectorWidth = 16;
+
+/// MaxTreeDepth - Stop following operands beyond this depth.
+static const unsigned MaxTreeDepth = 12;
+
+/// MaxStoreSearch - How many stores after a store to look at for the one that
+/// writes the next element.  This keeps huge blocks from being quadratic.
+static const unsigned MaxStoreSearch = 32;
+
+namespace {
+  /// Bundle - One node of the tree: a scalar for each lane, and what to turn
+  /// them into.
+  struct Bundle {
+    enum KindTy { Gather, Load, Store, BinOp, Cast };
+    KindTy Kind;
+    SmallVector<Value*, 8> Scalars;
+    SmallVector<unsigned, 2> Operands;  // Indices of the operand bundles.
+    Value *VectorValue;
+  };
+
+  /// SLPVectorizer - Find groups of consecutive stores in one basic block and
+  /// vectorize the trees that compute them.
+  class SLPVectorizer {
+    BasicBlock *BB;
+    ScalarEvolution *SE;
+    AliasAnalysis *AA;
+    const TargetData *TD;
+    const TargetLowering *TLI;
+
+    /// Order - The position of each instruction in the block.
+    DenseMap<Instruction*, unsigned> Order;
+
+    // The tree being built for the current group of stores.
+    SmallVector<Bundle, 16> Tree;
+    SmallPtrSet<Value*, 32> InTree;
+    unsigned VF;
+    Instruction *InsertPt;
+
+    IRBuilder<> Builder;
+
+  public:
+    SLPVectorizer(BasicBlock *bb, Pass *P, const TargetLowering *tli)
+      : BB(bb), SE(&P->getAnalysis<ScalarEvolution>()),
+        AA(&P->getAnalysis<AliasAnalysis>()),
+        TD(P->getAnalysisIfAvailable<TargetData>()), TLI(tli), VF(0),
+        InsertPt(0), Builder(bb->getContext()) {}
+
+    /// run - Vectorize the groups of stores in the block that the cost model
+    /// finds profitable.  Return true if the block was changed.
+    bool run();
+
+  private:
+    bool isPackableType(const Type *Ty) const;
+    bool isConsecutive(Value *PtrA, Value *PtrB) const;
+    bool isOperandMatch(Value *Prev, Value *V) const;
+    unsigned getMaxWidth(const Type *Ty) const;
+    void numberInstructions();
+
+    bool tryVectorize(StoreInst *const *Stores, unsigned Width);
+    unsigned buildTree(const SmallVectorImpl<Value*> &Scalars, unsigned Depth);
+    unsigned addGather(const SmallVectorImpl<Value*> &Scalars);
+    bool isSafeToMove() const;
+    int getTreeCost() const;
+    unsigned getVectorCost(const Bundle &B) const;
+
+    Value *vectorizeBundle(unsigned Idx);
+    void replaceTree();
+    unsigned getAlignment(Instruction *I, const Type *Ty) const;
+  };
+}
+
+//===----------------------------------------------------------------------===//
+// Finding groups of stores
+//===----------------------------------------------------------------------===//
+
+/// isPackableType - Return true if Ty can be the element type of a vector and
+/// its values are laid out without padding when packed.
+bool SLPVectorizer::isPackableType(const Type *Ty) const {
+  if (!Ty->isIntegerTy() && !Ty->isFloatingPointTy())
+    return false;
+  if (Ty->isIntegerTy(1) || Ty->isX86_FP80Ty() || Ty->isPPC_FP128Ty())
+    return false;
+  return TD->getTypeAllocSizeInBits(Ty) == TD->getTypeSizeInBits(Ty);
+}
+
+/// isConsecutive - Return true if PtrB points just past the element PtrA
+/// points to.
+bool SLPVectorizer::isConsecutive(Value *PtrA, Value *PtrB) const {
+  const Type *Ty = cast<PointerType>(PtrA->getType())->getElementType();
+  if (PtrB->getType() != PtrA->getType())
+    return false;
+  const SCEV *Dist = SE->getMinusSCEV(SE->getSCEV(PtrB), SE->getSCEV(PtrA));
+  const SCEVConstant *C = dyn_cast<SCEVConstant>(Dist);
+  return C && C->getValue()->getValue() == TD->getTypeAllocSize(Ty);
+}
+
+void SLPVectorizer::numberInstructions() {
+  Order.clear();
+  unsigned N = 0;
+  for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I)
+    Order[I] = N++;
+}
+
+bool SLPVectorizer::run() {
+  // Bucket the stores by the object they write to and the stored type, so
+  // that consecutive stores are looked for only among likely candidates.
+  typedef std::pair<const Value*, const Type*> BucketKey;
+  DenseMap<BucketKey, SmallVector<StoreInst*, 8> > Buckets;
+  SmallVector<BucketKey, 8> BucketOrder;
+  for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I) {
+    StoreInst *SI = dyn_cast<StoreInst>(I);
+    if (!SI || SI->isVolatile())
+      continue;
+    const Type *Ty = SI->getOperand(0)->getType();
+    if (!isPackableType(Ty))
+      continue;
+    BucketKey Key(SI->getPointerOperand()->getUnderlyingObject(), Ty);
+    SmallVector<StoreInst*, 8> &Bucket = Buckets[Key];
+    if (Bucket.empty())
+      BucketOrder.push_back(Key);
+    Bucket.push_back(SI);
+  }
+
+  bool Changed = false;
+  numberInstructions();
+  for (unsigned b = 0, be = BucketOrder.size(); b != be; ++b) {
+    SmallVector<StoreInst*, 8> &Stores = Buckets[BucketOrder[b]];
+    if (Stores.size() < 2)
+      continue;
+
+    // Link each store to the one writing the next element, if any.
+    DenseMap<StoreInst*, StoreInst*> Next;
+    SmallPtrSet<StoreInst*, 16> HasPrev;
+    for (unsigned i = 0, e = Stores.size(); i != e; ++i)
+      for (unsigned j = 0; j != e && j <= i + MaxStoreSearch; ++j) {
+        if (i == j || HasPrev.count(Stores[j]))
+          continue;
+        if (isConsecutive(Stores[i]->getPointerOperand(),
+                          Stores[j]->getPointerOperand())) {
+          Next[Stores[i]] = Stores[j];
+          HasPrev.insert(Stores[j]);
+          break;
+        }
+      }
+
+    // Walk each chain from its head, and vectorize the widest groups the
+    // cost model likes.
+    for (unsigned i = 0, e = Stores.size(); i != e; ++i) {
+      if (HasPrev.count(Stores[i]) || !Next.count(Stores[i]))
+        continue;
+      SmallVector<StoreInst*, 16> Chain;
+      for (StoreInst *SI = Stores[i]; SI; SI = Next.lookup(SI))
+        Chain.push_back(SI);
+
+      unsigned MaxWidth = getMaxWidth(BucketOrder[b].second);
+      for (unsigned Pos = 0; Pos + 1 < Chain.size(); ) {
+        unsigned Width = MaxWidth;
+        while (Width >= 2 && (Pos + Width > Chain.size() ||
+               !tryVectorize(&Chain[Pos], Width)))
+          Width /= 2;
+        if (Width >= 2) {
+          Changed = true;
+          Pos += Width;
+        } else {
+          ++Pos;
+        }
+      }
+    }
+  }
+  return Changed;
+}
+
+//===----------------------------------------------------------------------===//
+// Building the tree
+//===----------------------------------------------------------------------===//
+
+/// addGather - Add a bundle of scalars that are packed with insertelement.
+unsigned SLPVectorizer::addGather(const SmallVectorImpl<Value*> &Scalars) {
+  Tree.push_back(Bundle());
+  Bundle &B = Tree.back();
+  B.Kind = Bundle::Gather;
+  B.Scalars.append(Scalars.begin(), Scalars.end());
+  B.VectorValue = 0;
+  return Tree.size() - 1;
+}
+
+/// isOperandMatch - Return true if V fits into the same bundle as Prev, the
+/// operand of the previous lane.  This lines up the operands of commutative
+/// operators.
+bool SLPVectorizer::isOperandMatch(Value *Prev, Value *V) const {
+  if (isa<Constant>(Prev))
+    return isa<Constant>(V);
+  Instruction *PrevI = dyn_cast<Instruction>(Prev);
+  Instruction *I = dyn_cast<Instruction>(V);
+  if (!PrevI || !I || PrevI->getOpcode() != I->getOpcode())
+    return false;
+  if (LoadInst *PrevLI = dyn_cast<LoadInst>(PrevI))
+    return isConsecutive(PrevLI->getPointerOperand(),
+                         cast<LoadInst>(I)->getPointerOperand());
+  return true;
+}
+
+/// buildTree - Add a bundle for the given scalars, and for their operands if
+/// they are isomorphic.  Return the index of the new bundle.
+unsigned SLPVectorizer::buildTree(const SmallVectorImpl<Value*> &Scalars,
+                                  unsigned Depth) {
+  Instruction *I0 = dyn_cast<Instruction>(Scalars[0]);
+  if (!I0 || Depth > MaxTreeDepth)
+    return addGather(Scalars);
+
+  for (unsigned i = 0; i != VF; ++i) {
+    Instruction *I = dyn_cast<Instruction>(Scalars[i]);
+    if (!I || I->getOpcode() != I0->getOpcode() ||
+        I->getType() != I0->getType() || I->getParent() != BB ||
+        InTree.count(I))
+      return addGather(Scalars);
+    for (unsigned j = 0; j != i; ++j)
+      if (Scalars[j] == I)
+        return addGather(Scalars);
+  }
+
+  Bundle::KindTy Kind;
+  if (LoadInst *LI = dyn_cast<LoadInst>(I0)) {
+    if (!isPackableType(LI->getType()))
+      return addGather(Scalars);
+    for (unsigned i = 0; i != VF; ++i)
+      if (cast<LoadInst>(Scalars[i])->isVolatile() ||
+          (i && !isConsecutive(
+                  cast<LoadInst>(Scalars[i-1])->getPointerOperand(),
+                  cast<LoadInst>(Scalars[i])->getPointerOperand())))
+        return addGather(Scalars);
+    Kind = Bundle::Load;
+  } else if (BinaryOperator *BO = dyn_cast<BinaryOperator>(I0)) {
+    // Division may trap, and there are no vector divide instructions for
+    // integers anyway.
+    switch (BO->getOpcode()) {
+    case Instruction::UDiv: case Instruction::SDiv:
+    case Instruction::URem: case Instruction::SRem:
+    case Instruction::FRem:
+      return addGather(Scalars);
+    default:
+      break;
+    }
+    if (!isPackableType(BO->getType()))
+      return addGather(Scalars);
+    Kind = Bundle::BinOp;
+  } else if (CastInst *CI = dyn_cast<CastInst>(I0)) {
+    const Type *SrcTy = CI->getOperand(0)->getType();
+    if (!isPackableType(SrcTy) || !isPackableType(CI->getType()))
+      return addGather(Scalars);
+    for (unsigned i = 0; i != VF; ++i)
+      if (cast<CastInst>(Scalars[i])->getOperand(0)->getType() != SrcTy)
+        return addGather(Scalars);
+    Kind = Bundle::Cast;
+  } else {
+    return addGather(Scalars);
+  }
+
+  for (unsigned i = 0; i != VF; ++i)
+    InTree.insert(Scalars[i]);
+  unsigned Idx = Tree.size();
+  Tree.push_back(Bundle());
+  Tree[Idx].Kind = Kind;
+  Tree[Idx].Scalars.append(Scalars.begin(), Scalars.end());
+  Tree[Idx].VectorValue = 0;
+  if (Kind == Bundle::Load)
+    return Idx;
+
+  SmallVector<Value*, 8> Ops[2];
+  unsigned NumOps = Kind == Bundle::BinOp ? 2 : 1;
+  for (unsigned i = 0; i != VF; ++i) {
+    Instruction *I = cast<Instruction>(Scalars[i]);
+    Value *Op0 = I->getOperand(0);
+    Value *Op1 = NumOps == 2 ? I->getOperand(1) : 0;
+    // Swap the operands of commutative operators that are the other way
+    // around than in the first lane.
+    if (i && NumOps == 2 && I->isCommutative() &&
+        !isOperandMatch(Ops[0][i-1], Op0) && isOperandMatch(Ops[0][i-1], Op1))
+      std::swap(Op0, Op1);
+    Ops[0].push_back(Op0);
+    if (NumOps == 2)
+      Ops[1].push_back(Op1);
+  }
+  for (unsigned o = 0; o != NumOps; ++o) {
+    unsigned OpIdx = buildTree(Ops[o], Depth + 1);
+    Tree[Idx].Operands.push_back(OpIdx);
+  }
+  return Idx;
+}
+
+/// isSafeToMove - Return true if moving the loads and stores of the tree to
+/// InsertPt does not reorder them with a conflicting memory access, and if
+/// the scalars used outside of the tree are only used after InsertPt.
+bool SLPVectorizer::isSafeToMove() const {
+  unsigned InsertPos = Order.lookup(InsertPt);
+  for (unsigned b = 0, be = Tree.size(); b != be; ++b) {
+    const Bundle &B = Tree[b];
+    if (B.Kind == Bundle::Gather) {
+      // The gathered scalars are inserted at InsertPt, so they must not be
+      // replaced by lanes of the tree.
+      for (unsigned i = 0; i != VF; ++i)
+        if (InTree.count(B.Scalars[i]))
+          return false;
+      continue;
+    }
+
+    for (unsigned i = 0; i != VF; ++i) {
+      Instruction *I = cast<Instruction>(B.Scalars[i]);
+      for (Value::use_iterator UI = I->use_begin(), UE = I->use_end();
+           UI != UE; ++UI) {
+        Instruction *User = cast<Instruction>(*UI);
+        if (!InTree.count(User) && User->getParent() == BB &&
+            Order.lookup(User) <= InsertPos)
+          return false;
+      }
+
+      if (B.Kind != Bundle::Load && B.Kind != Bundle::Store)
+        continue;
+      Value *Ptr = I->getOperand(B.Kind == Bundle::Store ? 1 : 0);
+      unsigned Size = TD->getTypeStoreSize(
+        cast<PointerType>(Ptr->getType())->getElementType());
+      // The last store of the group is InsertPt itself, and does not move.
+      if (I == InsertPt)
+        continue;
+      BasicBlock::iterator It = I;
+      for (++It; &*It != InsertPt; ++It) {
+        // The stores of the group write different elements.
+        if (B.Kind == Bundle::Store && isa<StoreInst>(It) &&
+            InTree.count(&*It))
+          continue;
+        if (!It->mayReadFromMemory() && !It->mayWriteToMemory())
+          continue;
+        AliasAnalysis::ModRefResult MR = AA->getModRefInfo(&*It, Ptr, Size);
+        if (B.Kind == Bundle::Load ? (MR & AliasAnalysis::Mod)
+                                   : MR != AliasAnalysis::NoModRef) {
+          DEBUG(dbgs() << "SLP: Cannot move " << *I << " past " << *It
+                       << "\n");
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Cost model
+//===----------------------------------------------------------------------===//
+
+/// getISDOpcode - Return the SelectionDAG opcode that a binary operator of
+/// the given kind is lowered to.
+static unsigned getISDOpcode(unsigned Opcode) {
+  switch (Opcode) {
+  default: llvm_unreachable("Unexpected binary operator!");
+  case Instruction::Add:  return ISD::ADD;
+  case Instruction::FAdd: return ISD::FADD;
+  case Instruction::Sub:  return ISD::SUB;
+  case Instruction::FSub: return ISD::FSUB;
+  case Instruction::Mul:  return ISD::MUL;
+  case Instruction::FMul: return ISD::FMUL;
+  case Instruction::FDiv: return ISD::FDIV;
+  case Instruction::Shl:  return ISD::SHL;
+  case Instruction::LShr: return ISD::SRL;
+  case Instruction::AShr: return ISD::SRA;
+  case Instruction::And:  return ISD::AND;
+  case Instruction::Or:   return ISD::OR;
+  case Instruction::Xor:  return ISD::XOR;
+  }
+}
+
+/// getMaxWidth - Return the most lanes of type Ty that fit a vector register.
+unsigned SLPVectorizer::getMaxWidth(const Type *Ty) const {
+  if (TLI) {
+    for (unsigned Width = MaxVectorWidth; Width >= 2; Width /= 2)
+      if (TLI->isTypeLegal(EVT::getVectorVT(BB->getContext(),
+                                            EVT::getEVT(Ty), Width)))
+        return Width;
+    return 0;
+  }
+  uint64_t Bits = TD->getTypeSizeInBits(Ty);
+  unsigned Width = 1;
+  while (Width * 2 <= MaxVectorWidth && Width * 2 * Bits <= SLPVectorBits)
+    Width *= 2;
+  return Width;
+}
+
+/// getVectorCost - Return the number of instructions the vector form of a
+/// bundle costs.  This is the per-target hook of the cost model: vector types
+/// or operations the target does not have are split up into scalars again.
+unsigned SLPVectorizer::getVectorCost(const Bundle &B) const {
+  const Type *ScalarTy = B.Kind == Bundle::Store ?
+    cast<StoreInst>(B.Scalars[0])->getOperand(0)->getType() :
+    B.Scalars[0]->getType();
+  const VectorType *VTy = VectorType::get(ScalarTy, VF);
+
+  if (B.Kind == Bundle::Gather) {
+    bool AllConstant = true, Splat = true;
+    for (unsigned i = 0; i != VF; ++i) {
+      AllConstant &= isa<Constant>(B.Scalars[i]);
+      Splat &= B.Scalars[i] == B.Scalars[0];
+    }
+    if (AllConstant)
+      return 0;
+    return Splat ? 2 : VF;
+  }
+
+  if (!TLI) {
+    uint64_t Bits = TD->getTypeSizeInBits(VTy);
+    return (Bits + SLPVectorBits - 1) / SLPVectorBits;
+  }
+
+  EVT VT = EVT::getEVT(VTy);
+  // Scalarizing costs an extract and an insert per lane on top of the
+  // scalar operations.
+  unsigned Scalarized = 3 * VF;
+  if (!TLI->isTypeLegal(VT))
+    return Scalarized;
+  if (B.Kind == Bundle::BinOp &&
+      !TLI->isOperationLegalOrCustom(
+         getISDOpcode(cast<Instruction>(B.Scalars[0])->getOpcode()), VT))
+    return Scalarized;
+  if (B.Kind == Bundle::Cast) {
+    const Type *SrcTy = cast<CastInst>(B.Scalars[0])->getOperand(0)->getType();
+    if (!TLI->isTypeLegal(EVT::getEVT(VectorType::get(SrcTy, VF))))
+      return Scalarized;
+  }
+  return 1;
+}
+
+/// getTreeCost - Return how many more instructions the vector form of the
+/// tree takes than the scalar one.
+int SLPVectorizer::getTreeCost() const {
+  int Cost = 0;
+  for (unsigned b = 0, be = Tree.size(); b != be; ++b) {
+    const Bundle &B = Tree[b];
+    Cost += getVectorCost(B);
+    if (B.Kind == Bundle::Gather)
+      continue;
+    Cost -= VF;
+
+    // Scalars that are still needed are extracted.
+    for (unsigned i = 0; i != VF; ++i)
+      for (Value::use_iterator UI = B.Scalars[i]->use_begin(),
+           UE = B.Scalars[i]->use_end(); UI != UE; ++UI)
+        if (!InTree.count(*UI)) {
+          ++Cost;
+          break;
+        }
+  }
+  return Cost;
+}
+
+//===----------------------------------------------------------------------===//
+// Code generation
+//===----------------------------------------------------------------------===//
+
+unsigned SLPVectorizer::getAlignment(Instruction *I, const Type *Ty) const {
+  unsigned Align = isa<LoadInst>(I) ? cast<LoadInst>(I)->getAlignment()
+                                    : cast<StoreInst>(I)->getAlignment();
+  // A vector access without an alignment would assume that of the vector.
+  return Align ? Align : TD->getABITypeAlignment(Ty);
+}
+
+Value *SLPVectorizer::vectorizeBundle(unsigned Idx) {
+  Bundle &B = Tree[Idx];
+  if (B.VectorValue)
+    return B.VectorValue;
+
+  Instruction *I0 = dyn_cast<Instruction>(B.Scalars[0]);
+  Value *Result = 0;
+  switch (B.Kind) {
+  case Bundle::Gather: {
+    const VectorType *VTy = VectorType::get(B.Scalars[0]->getType(), VF);
+    std::vector<Constant*> Elts;
+    for (unsigned i = 0; i != VF; ++i)
+      if (Constant *C = dyn_cast<Constant>(B.Scalars[i]))
+        Elts.push_back(C);
+      else
+        Elts.push_back(UndefValue::get(VTy->getElementType()));
+    Result = ConstantVector::get(Elts);
+    for (unsigned i = 0; i != VF; ++i)
+      if (!isa<Constant>(B.Scalars[i]))
+        Result = Builder.CreateInsertElement(Result, B.Scalars[i],
+                                             Builder.getInt32(i));
+    break;
+  }
+  case Bundle::Load: {
+    LoadInst *LI = cast<LoadInst>(I0);
+    const Type *VTy = VectorType::get(LI->getType(), VF);
+    Value *Ptr = Builder.CreateBitCast(LI->getPointerOperand(),
+                       PointerType::get(VTy, LI->getPointerAddressSpace()));
+    LoadInst *NewLI = Builder.CreateLoad(Ptr, LI->getName());
+    NewLI->setAlignment(getAlignment(LI, LI->getType()));
+    Result = NewLI;
+    break;
+  }
+  case Bundle::Store: {
+    StoreInst *SI = cast<StoreInst>(I0);
+    Value *Val = vectorizeBundle(B.Operands[0]);
+    Value *Ptr = Builder.CreateBitCast(SI->getPointerOperand(),
+                       PointerType::get(Val->getType(),
+                                        SI->getPointerAddressSpace()));
+    StoreInst *NewSI = Builder.CreateStore(Val, Ptr);
+    NewSI->setAlignment(getAlignment(SI, SI->getOperand(0)->getType()));
+    Result = NewSI;
+    break;
+  }
+  case Bundle::BinOp: {
+    Value *LHS = vectorizeBundle(B.Operands[0]);
+    Value *RHS = vectorizeBundle(B.Operands[1]);
+    Result = Builder.CreateBinOp(cast<BinaryOperator>(I0)->getOpcode(),
+                                 LHS, RHS, I0->getName());
+    break;
+  }
+  case Bundle::Cast:
+    Result = Builder.CreateCast(cast<CastInst>(I0)->getOpcode(),
+                                vectorizeBundle(B.Operands[0]),
+                                VectorType::get(I0->getType(), VF),
+                                I0->getName());
+    break;
+  }
+  return B.VectorValue = Result;
+}
+
+/// replaceTree - Emit the vector code before InsertPt, and remove the
+/// scalars it replaces.
+void SLPVectorizer::replaceTree() {
+  Builder.SetInsertPoint(BB, InsertPt);
+  vectorizeBundle(0);
+
+  // Lanes still used outside of the tree are extracted after all vector
+  // code, which is before each of their remaining users.
+  for (unsigned b = 1, be = Tree.size(); b != be; ++b) {
+    Bundle &B = Tree[b];
+    if (B.Kind == Bundle::Gather)
+      continue;
+    for (unsigned i = 0; i != VF; ++i) {
+      Value *Scalar = B.Scalars[i];
+      Value *Extract = 0;
+      for (Value::use_iterator UI = Scalar->use_begin();
+           UI != Scalar->use_end(); ) {
+        Use &U = UI.getUse();
+        ++UI;
+        if (InTree.count(U.getUser()))
+          continue;
+        if (!Extract)
+          Extract = Builder.CreateExtractElement(B.VectorValue,
+                                                 Builder.getInt32(i));
+        U.set(Extract);
+      }
+    }
+  }
+
+  // Now the scalars are only used by each other.
+  for (unsigned b = 0, be = Tree.size(); b != be; ++b)
+    if (Tree[b].Kind != Bundle::Gather)
+      for (unsigned i = 0; i != VF; ++i)
+        cast<Instruction>(Tree[b].Scalars[i])->dropAllReferences();
+  for (unsigned b = 0, be = Tree.size(); b != be; ++b)
+    if (Tree[b].Kind != Bundle::Gather)
+      for (unsigned i = 0; i != VF; ++i) {
+        Instruction *I = cast<Instruction>(Tree[b].Scalars[i]);
+        SE->forgetValue(I);
+        I->eraseFromParent();
+      }
+}
+
+/// tryVectorize - Vectorize the tree computing a group of stores to
+/// consecutive memory, if that is legal and profitable.
+bool SLPVectorizer::tryVectorize(StoreInst *const *Stores, unsigned Width) {
+  VF = Width;
+  Tree.clear();
+  InTree.clear();
+
+  // The stores become the root bundle, and the vector code replaces the last
+  // of them.
+  InsertPt = Stores[0];
+  SmallVector<Value*, 8> Values;
+  for (unsigned i = 0; i != VF; ++i) {
+    InTree.insert(Stores[i]);
+    Values.push_back(Stores[i]->getOperand(0));
+    if (Order[Stores[i]] > Order[InsertPt])
+      InsertPt = Stores[i];
+  }
+  Tree.push_back(Bundle());
+  Tree[0].Kind = Bundle::Store;
+  Tree[0].Scalars.append(Stores, Stores + VF);
+  Tree[0].VectorValue = 0;
+  unsigned OpIdx = buildTree(Values, 1);
+  Tree[0].Operands.push_back(OpIdx);
+
+  if (!isSafeToMove())
+    return false;
+
+  int Cost = getTreeCost();
+  DEBUG(dbgs() << "SLP: Found " << VF << " stores to vectorize at "
+               << *InsertPt << "SLP: Cost " << Cost << " over "
+               << Tree.size() << " bundles.\n");
+  if (Cost + SLPCostThreshold >= 0)
+    return false;
+
+  unsigned NumScalars = 0;
+  for (unsigned b = 0, be = Tree.size(); b != be; ++b)
+    if (Tree[b].Kind != Bundle::Gather)
+      NumScalars += VF;
+  replaceTree();
+  numberInstructions();
+  ++NumVectorized;
+  NumScalarsPacked += NumScalars;
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// SLPVectorize pass
+//===----------------------------------------------------------------------===//
+
+namespace {
+  class SLPVectorize : public FunctionPass {
+    /// TLI - Keep a pointer of a TargetLowering to consult for the cost model.
+    const TargetLowering *TLI;
+
+  public:
+    static char ID; // Pass ID, replacement for typeid
+    explicit SLPVectorize(const TargetLowering *tli = 0)
+      : FunctionPass(ID), TLI(tli) {}
+
+    virtual bool runOnFunction(Function &F);
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequired<AliasAnalysis>();
+      AU.addRequired<ScalarEvolution>();
+      AU.setPreservesCFG();
+    }
+  };
+}
+
+char SLPVectorize::ID = 0;
+INITIALIZE_PASS_BEGIN(SLPVectorize, "slp-vectorize",
+                      "Vectorize straight-line code", false, false)
+INITIALIZE_AG_DEPENDENCY(AliasAnalysis)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolution)
+INITIALIZE_PASS_END(SLPVectorize, "slp-vectorize",
+                    "Vectorize straight-line code", false, false)
+
+Pass *llvm::createSLPVectorizePass(const TargetLowering *TLI) {
+  return new SLPVectorize(TLI);
+}
+
+bool SLPVectorize::runOnFunction(Function &F) {
+  // Without the layout of the types, consecutive addresses cannot be told.
+  if (!getAnalysisIfAvailable<TargetData>())
+    return false;
+
+  bool Changed = false;
+  for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+    Changed |= SLPVectorizer(BB, this, TLI).run();
+  return Changed;
+}
@@ -44,6 +44,7 @@ void llvm::initializeScalarOpts(PassRegistry &Registry) {
   initializeLoopStrengthReducePass(Registry);
   initializeLoopUnrollPass(Registry);
   initializeLoopUnswitchPass(Registry);
+  initializeLoopVectorizePass(Registry);
   initializeLowerAtomicPass(Registry);
   initializeMemCpyOptPass(Registry);
   initializeReassociatePass(Registry);
@@ -55,6 +56,7 @@ void llvm::initializeScalarOpts(PassRegistry &Registry) {
   initializeSimplifyHalfPowrLibCallsPass(Registry);
   initializeSimplifyLibCallsPass(Registry);
   initializeSinkingPass(Registry);
+  initializeSLPVectorizePass(Registry);
   initializeTailDupPass(Registry);
   initializeTailCallElimPass(Registry);
 }
@@ -292,7 +292,11 @@ ConstantInt *ConstantInt::get(LLVMContext &Context, const APInt& V) {
   const IntegerType *ITy = IntegerType::get(Context, V.getBitWidth());
   // get an existing value or the insertion position
   DenseMapAPIntKeyInfo::KeyTy Key(V, ITy);
-  ConstantInt *&Slot = Context.pImpl->IntConstants[Key]; 
+  LLVMContextImpl *pImpl = Context.pImpl;
+  unsigned Shard =
+    LLVMContextImpl::getLeafShard(DenseMapAPIntKeyInfo::getHashValue(Key));
+  sys::SmartScopedLock<true> Lock(pImpl->IntConstantsLock[Shard]);
+  ConstantInt *&Slot = pImpl->IntConstants[Shard][Key]; 
   if (!Slot) Slot = new ConstantInt(ITy, V);
   return Slot;
 }
@@ -422,8 +426,11 @@ ConstantFP* ConstantFP::get(LLVMContext &Context, const APFloat& V) {
   DenseMapAPFloatKeyInfo::KeyTy Key(V);
   
   LLVMContextImpl* pImpl = Context.pImpl;
+  unsigned Shard =
+    LLVMContextImpl::getLeafShard(DenseMapAPFloatKeyInfo::getHashValue(Key));
+  sys::SmartScopedLock<true> Lock(pImpl->FPConstantsLock[Shard]);
   
-  ConstantFP *&Slot = pImpl->FPConstants[Key];
+  ConstantFP *&Slot = pImpl->FPConstants[Shard][Key];
     
   if (!Slot) {
     const Type *Ty;
@@ -78,13 +78,13 @@ LLVMContextImpl::~LLVMContextImpl() {
   NullPtrConstants.freeConstants();
   UndefValueConstants.freeConstants();
   InlineAsms.freeConstants();
-  for (IntMapTy::iterator I = IntConstants.begin(), E = IntConstants.end(); 
-       I != E; ++I) {
-    delete I->second;
-  }
-  for (FPMapTy::iterator I = FPConstants.begin(), E = FPConstants.end(); 
-       I != E; ++I) {
-    delete I->second;
+  for (unsigned i = 0; i != NumLeafShards; ++i) {
+    for (IntMapTy::iterator I = IntConstants[i].begin(),
+         E = IntConstants[i].end(); I != E; ++I)
+      delete I->second;
+    for (FPMapTy::iterator I = FPConstants[i].begin(),
+         E = FPConstants[i].end(); I != E; ++I)
+      delete I->second;
   }
   AlwaysOpaqueTy->dropRef();
   for (OpaqueTypesTy::iterator I = OpaqueTypes.begin(), E = OpaqueTypes.end();
@@ -108,8 +108,8 @@ LLVMContextImpl::~LLVMContextImpl() {
   assert(MDNodeSet.empty() && NonUniquedMDNodes.empty() &&
          "Destroying all MDNodes didn't empty the Context's sets.");
   // Destroy MDStrings.
-  for (StringMap<MDString*>::iterator I = MDStringCache.begin(),
-         E = MDStringCache.end(); I != E; ++I) {
-    delete I->second;
-  }
+  for (unsigned i = 0; i != NumLeafShards; ++i)
+    for (StringMap<MDString*>::iterator I = MDStringCache[i].begin(),
+           E = MDStringCache[i].end(); I != E; ++I)
+      delete I->second;
 }
@@ -24,6 +24,7 @@
 #include "llvm/Metadata.h"
 #include "llvm/Assembly/Writer.h"
 #include "llvm/Support/ValueHandle.h"
+#include "llvm/System/Mutex.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/DenseMap.h"
@@ -121,15 +122,34 @@ public:
   
   void *InlineAsmDiagHandler, *InlineAsmDiagContext;
   
+  /// The uniquing tables for ConstantInt, ConstantFP and MDString are split
+  /// into NumLeafShards independently locked shards.  None of these values
+  /// have operands, so creating one touches nothing but its own shard, which
+  /// lets several threads build them in the same context once
+  /// llvm_start_multithreaded() has been called.  The remaining tables below
+  /// are still only safe to use from one thread at a time.
+  static const unsigned LogNumLeafShards = 4;
+  static const unsigned NumLeafShards = 1 << LogNumLeafShards;
+
+  /// getLeafShard - Return the shard for a key whose hash value is Hash.  The
+  /// shard comes from the high bits of a multiplicative hash, so the keys
+  /// within one shard still spread over the low bits the maps bucket on.
+  static unsigned getLeafShard(unsigned Hash) {
+    return (uint32_t)(Hash * 0x9E3779B9U) >> (32 - LogNumLeafShards);
+  }
+
   typedef DenseMap<DenseMapAPIntKeyInfo::KeyTy, ConstantInt*, 
                          DenseMapAPIntKeyInfo> IntMapTy;
-  IntMapTy IntConstants;
+  IntMapTy IntConstants[NumLeafShards];
+  sys::SmartMutex<true> IntConstantsLock[NumLeafShards];
   
   typedef DenseMap<DenseMapAPFloatKeyInfo::KeyTy, ConstantFP*, 
                          DenseMapAPFloatKeyInfo> FPMapTy;
-  FPMapTy FPConstants;
+  FPMapTy FPConstants[NumLeafShards];
+  sys::SmartMutex<true> FPConstantsLock[NumLeafShards];
   
-  StringMap<MDString*> MDStringCache;
+  StringMap<MDString*> MDStringCache[NumLeafShards];
+  sys::SmartMutex<true> MDStringCacheLock[NumLeafShards];
   
   FoldingSet<MDNode> MDNodeSet;
   // MDNodes may be uniqued or not uniqued.  When they're not uniqued, they
@@ -194,6 +214,9 @@ public:
   TypeMap<FunctionValType, FunctionType> FunctionTypes;
   TypeMap<StructValType, StructType> StructTypes;
   TypeMap<IntegerValType, IntegerType> IntegerTypes;
+  /// IntegerTypesLock - Guards IntegerTypes, which ConstantInt::get reaches
+  /// for bit widths that have no built-in type.
+  sys::SmartMutex<true> IntegerTypesLock;
 
   // Opaque types are not structurally uniqued, so don't use TypeMap.
   typedef SmallPtrSet<const OpaqueType*, 8> OpaqueTypesTy;
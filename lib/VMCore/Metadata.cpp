@@ -19,6 +19,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
 #include "SymbolTableListTraitsImpl.h"
 #include "llvm/Support/LeakDetector.h"
 #include "llvm/Support/ValueHandle.h"
@@ -33,8 +34,10 @@ MDString::MDString(LLVMContext &C, StringRef S)
 
 MDString *MDString::get(LLVMContext &Context, StringRef Str) {
   LLVMContextImpl *pImpl = Context.pImpl;
+  unsigned Shard = LLVMContextImpl::getLeafShard(HashString(Str));
+  sys::SmartScopedLock<true> Lock(pImpl->MDStringCacheLock[Shard]);
   StringMapEntry<MDString *> &Entry =
-    pImpl->MDStringCache.GetOrCreateValue(Str);
+    pImpl->MDStringCache[Shard].GetOrCreateValue(Str);
   MDString *&S = Entry.getValue();
   if (!S) S = new MDString(Context, Entry.getKey());
   return S;
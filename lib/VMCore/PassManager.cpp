@@ -21,10 +21,12 @@
 #include "llvm/Support/Timer.h"
 #include "llvm/Module.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/PassNameParser.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/System/Mutex.h"
+#include "llvm/System/Process.h"
 #include <algorithm>
 #include <cstdio>
 #include <map>
@@ -486,6 +488,101 @@ public:
 
 static TimingInfo *TheTimeInfo;
 
+namespace {
+
+//===----------------------------------------------------------------------===//
+/// PassTrace Class - This class records the wall time, instruction count change
+/// and memory change of every function pass on every function, and of every
+/// module pass, and writes them out as a Chrome trace-event file on exit.
+/// This only happens when -pass-trace is given on the command line.
+///
+
+static ManagedStatic<sys::SmartMutex<true> > PassTraceMutex;
+
+class PassTrace {
+  struct Event {
+    std::string PassName;
+    std::string FunctionName;
+    double Start, Duration;     // In microseconds since the trace began.
+    long InstDelta;
+    long long MemDelta;
+  };
+  std::vector<Event> Events;
+  double Epoch;
+public:
+  // Use 'create' member to get this.
+  PassTrace() : Epoch(now()) {}
+
+  // ~PassTrace - Write out the trace file.
+  ~PassTrace();
+
+  // createThePassTrace - This method either initializes the ThePassTrace
+  // pointer to a non null value (if the -pass-trace option is given) or it
+  // leaves it null.  It may be called multiple times.
+  static void createThePassTrace();
+
+  /// now - Return the current wall time in microseconds.
+  static double now() {
+    sys::TimeValue T = sys::TimeValue::now();
+    return T.seconds() * 1000000.0 + T.microseconds();
+  }
+
+  void record(Pass *P, const Function *F, double Start, double End,
+              long InstDelta, long long MemDelta) {
+    sys::SmartScopedLock<true> Lock(*PassTraceMutex);
+    Events.push_back(Event());
+    Event &E = Events.back();
+    E.PassName = P->getPassName();
+    if (F)
+      E.FunctionName = F->getName();
+    E.Start = Start - Epoch;
+    E.Duration = End - Start;
+    E.InstDelta = InstDelta;
+    E.MemDelta = MemDelta;
+  }
+};
+
+} // End of anon namespace
+
+static PassTrace *ThePassTrace;
+
+namespace {
+
+/// PassTraceRegion - Record one run of a pass with the PassTrace, if there is
+/// one, from construction to destruction.  Module passes have no function.
+class PassTraceRegion {
+  Pass *P;
+  const Function *F;
+  double Start;
+  size_t Insts, Mem;
+  PassTraceRegion(const PassTraceRegion &); // DO NOT IMPLEMENT
+
+  static size_t countInstructions(const Function *F) {
+    size_t N = 0;
+    if (F)
+      for (Function::const_iterator I = F->begin(), E = F->end(); I != E; ++I)
+        N += I->size();
+    return N;
+  }
+public:
+  PassTraceRegion(Pass *p, const Function *f) : P(p), F(f) {
+    if (!ThePassTrace || !P) return;
+    Insts = countInstructions(F);
+    Mem = sys::Process::GetMallocUsage();
+    Start = PassTrace::now();
+  }
+  ~PassTraceRegion() {
+    if (!ThePassTrace || !P) return;
+    double End = PassTrace::now();
+    ThePassTrace->record(P, F, Start, End,
+                         long(countInstructions(F)) - long(Insts),
+                         (long long)sys::Process::GetMallocUsage() -
+                           (long long)Mem);
+  }
+};
+
+} // End of anon namespace
+
 //===----------------------------------------------------------------------===//
 // PMTopLevelManager implementation
 
@@ -1388,6 +1485,7 @@ void FunctionPassManagerImpl::releaseMemoryOnTheFly() {
 bool FunctionPassManagerImpl::run(Function &F) {
   bool Changed = false;
   TimingInfo::createTheTimeInfo();
+  PassTrace::createThePassTrace();
 
   initializeAllAnalysisInfo();
   for (unsigned Index = 0; Index < getNumContainedManagers(); ++Index)
@@ -1439,6 +1537,7 @@ bool FPPassManager::runOnFunction(Function &F) {
     {
       PassManagerPrettyStackEntry X(FP, F);
       TimeRegion PassTimer(getPassTimer(FP));
+      PassTraceRegion PassTraced(FP, &F);
 
       LocalChanged |= FP->runOnFunction(F);
     }
@@ -1513,6 +1612,7 @@ MPPassManager::runOnModule(Module &M) {
     {
       PassManagerPrettyStackEntry X(MP, M);
       TimeRegion PassTimer(getPassTimer(MP));
+      PassTraceRegion PassTraced(MP->getAsPMDataManager() ? 0 : MP, 0);
 
       LocalChanged |= MP->runOnModule(M);
     }
@@ -1589,6 +1689,7 @@ Pass* MPPassManager::getOnTheFlyPass(Pass *MP, AnalysisID PI, Function &F){
 bool PassManagerImpl::run(Module &M) {
   bool Changed = false;
   TimingInfo::createTheTimeInfo();
+  PassTrace::createThePassTrace();
 
   dumpArguments();
   dumpPasses();
@@ -1672,6 +1773,59 @@ Timer *llvm::getPassTimer(Pass *P) {
   return 0;
 }
 
+// PrintJSONString - Print a quoted JSON string, defined in Timer.cpp.
+namespace llvm { extern void PrintJSONString(StringRef S, raw_ostream &OS); }
+
+//===----------------------------------------------------------------------===//
+// PassTrace Class - This class records every pass run on every function in a
+// Chrome trace-event file.  This only happens when -pass-trace is given on the
+// command line.
+//
+static cl::opt<std::string>
+PassTraceFile("pass-trace", cl::value_desc("filename"),
+              cl::desc("Write the time, instruction count change and memory "
+                       "change of each pass on each function to a Chrome "
+                       "trace-event file"));
+
+void PassTrace::createThePassTrace() {
+  if (PassTraceFile.empty() || ThePassTrace) return;
+
+  // Constructed the first time this is called, iff -pass-trace is given, so
+  // that the trace is written out by llvm_shutdown.
+  static ManagedStatic<PassTrace> TPT;
+  ThePassTrace = &*TPT;
+}
+
+PassTrace::~PassTrace() {
+  std::string Error;
+  raw_fd_ostream OS(PassTraceFile.c_str(), Error);
+  if (!Error.empty()) {
+    errs() << "Error opening pass trace file '" << PassTraceFile << "': "
+           << Error << '\n';
+    return;
+  }
+
+  OS << "{\"traceEvents\":[";
+  for (unsigned i = 0, e = Events.size(); i != e; ++i) {
+    const Event &E = Events[i];
+    OS << (i ? ",\n" : "\n") << "{\"name\":";
+    PrintJSONString(E.PassName, OS);
+    OS << ",\"cat\":\"" << (E.FunctionName.empty() ? "module" : "function")
+       << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+       << ",\"ts\":" << format("%.0f", E.Start)
+       << ",\"dur\":" << format("%.0f", E.Duration)
+       << ",\"args\":{";
+    if (!E.FunctionName.empty()) {
+      OS << "\"function\":";
+      PrintJSONString(E.FunctionName, OS);
+      OS << ',';
+    }
+    OS << "\"instructions\":" << E.InstDelta
+       << ",\"memory\":" << E.MemDelta << "}}";
+  }
+  OS << "\n]}\n";
+}
+
 //===----------------------------------------------------------------------===//
 // PMStack implementation
 //
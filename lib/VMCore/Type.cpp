@@ -801,9 +801,9 @@ const IntegerType *IntegerType::get(LLVMContext &C, unsigned NumBits) {
   
   IntegerValType IVT(NumBits);
   IntegerType *ITy = 0;
+  sys::SmartScopedLock<true> Lock(pImpl->IntegerTypesLock);
   
-  // First, see if the type is already in the table, for which
-  // a reader lock suffices.
+  // First, see if the type is already in the table.
   ITy = pImpl->IntegerTypes.get(IVT);
     
   if (!ITy) {
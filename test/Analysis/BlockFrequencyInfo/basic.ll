@@ -0,0 +1,83 @@
+; RUN: opt < %s -analyze -block-freq | FileCheck %s
+
+define i32 @test1(i32 %i, i32* %a) {
+; CHECK: Printing analysis {{.*}} for function 'test1'
+; CHECK: entry = 1024
+entry:
+  br label %body
+
+; The back edge is taken 124 times out of 128, so the loop runs 32 times per
+; entry.
+; CHECK: body = 32768
+; CHECK: body -> exit = 1024
+; CHECK: body -> body = 31744
+body:
+  %iv = phi i32 [ 0, %entry ], [ %next, %body ]
+  %base = phi i32 [ 0, %entry ], [ %sum, %body ]
+  %arrayidx = getelementptr inbounds i32* %a, i32 %iv
+  %0 = load i32* %arrayidx
+  %sum = add nsw i32 %0, %base
+  %next = add i32 %iv, 1
+  %exitcond = icmp eq i32 %next, %i
+  br i1 %exitcond, label %exit, label %body
+
+; CHECK: exit = 1024
+exit:
+  ret i32 %sum
+}
+
+define i32 @test2(i32* %p, i32 %x) {
+; CHECK: Printing analysis {{.*}} for function 'test2'
+; CHECK: entry = 1024
+; CHECK: entry -> null = 384
+; CHECK: entry -> nonnull = 640
+entry:
+  %isnull = icmp eq i32* %p, null
+  br i1 %isnull, label %null, label %nonnull
+
+; CHECK: null = 384
+null:
+  br label %join
+
+; CHECK: nonnull = 640
+nonnull:
+  %v = load i32* %p
+  br label %join
+
+; CHECK: join = 1024
+join:
+  %r = phi i32 [ 0, %null ], [ %v, %nonnull ]
+  ret i32 %r
+}
+
+define void @test3(i32 %n, i32 %m) {
+; CHECK: Printing analysis {{.*}} for function 'test3'
+; CHECK: entry = 1024
+entry:
+  br label %outer
+
+; Each loop runs 32 times per entry, so the inner body runs 32 * 32 times.
+; CHECK: outer = 32768
+outer:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %outer.latch ]
+  br label %inner
+
+; CHECK: inner = 1048576
+; CHECK: inner -> outer.latch = 32768
+; CHECK: inner -> inner = 1015808
+inner:
+  %j = phi i32 [ 0, %outer ], [ %j.next, %inner ]
+  %j.next = add i32 %j, 1
+  %inner.cond = icmp eq i32 %j.next, %m
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+; CHECK: outer.latch = 32768
+outer.latch:
+  %i.next = add i32 %i, 1
+  %outer.cond = icmp eq i32 %i.next, %n
+  br i1 %outer.cond, label %exit, label %outer
+
+; CHECK: exit = 1024
+exit:
+  ret void
+}
@@ -0,0 +1,83 @@
+; RUN: opt < %s -analyze -branch-prob | FileCheck %s
+
+define i32 @test1(i32 %i, i32* %a) {
+; CHECK: Branch Probabilities of test1
+entry:
+  br label %body
+; CHECK: edge entry -> body probability is 16 / 16 = 100%
+
+body:
+  %iv = phi i32 [ 0, %entry ], [ %next, %body ]
+  %base = phi i32 [ 0, %entry ], [ %sum, %body ]
+  %arrayidx = getelementptr inbounds i32* %a, i32 %iv
+  %0 = load i32* %arrayidx
+  %sum = add nsw i32 %0, %base
+  %next = add i32 %iv, 1
+  %exitcond = icmp eq i32 %next, %i
+  br i1 %exitcond, label %exit, label %body
+; CHECK: edge body -> exit probability is 4 / 128 = 3.125%
+; CHECK: edge body -> body probability is 124 / 128 = 96.875% [HOT edge]
+
+exit:
+  ret i32 %sum
+}
+
+define i32 @test2(i32* %p, i32 %x) {
+; CHECK: Branch Probabilities of test2
+entry:
+  %isnull = icmp eq i32* %p, null
+  br i1 %isnull, label %null, label %nonnull
+; CHECK: edge entry -> null probability is 12 / 32 = 37.5%
+; CHECK: edge entry -> nonnull probability is 20 / 32 = 62.5%
+
+null:
+  ret i32 0
+
+nonnull:
+  %iszero = icmp eq i32 %x, 0
+  br i1 %iszero, label %fail, label %ok
+; CHECK: edge nonnull -> fail probability is 1 / 1024
+; CHECK: edge nonnull -> ok probability is 1023 / 1024 = 99.9023% [HOT edge]
+
+fail:
+  call void @abort() noreturn
+  unreachable
+
+ok:
+  %v = load i32* %p
+  %r = sdiv i32 %v, %x
+  ret i32 %r
+}
+
+declare void @abort() noreturn
+
+define i32 @test3(i32 %x) {
+; CHECK: Branch Probabilities of test3
+entry:
+  %ispos = icmp sgt i32 %x, 0
+  br i1 %ispos, label %pos, label %sw
+; CHECK: edge entry -> pos probability is 20 / 32 = 62.5%
+; CHECK: edge entry -> sw probability is 12 / 32 = 37.5%
+
+pos:
+  ret i32 1
+
+sw:
+  switch i32 %x, label %default [
+    i32 -1, label %case
+    i32 -2, label %case
+    i32 -3, label %other
+  ]
+; CHECK: edge sw -> default probability is 16 / 64 = 25%
+; CHECK: edge sw -> case probability is 32 / 64 = 50%
+; CHECK: edge sw -> other probability is 16 / 64 = 25%
+
+default:
+  ret i32 0
+
+case:
+  ret i32 2
+
+other:
+  ret i32 3
+}
@@ -0,0 +1,67 @@
+; RUN: opt < %s -analyze -lda | FileCheck %s
+
+@y = common global [16 x [16 x i32]] zeroinitializer, align 4
+@b = common global [16 x i8] zeroinitializer, align 1
+
+;; for (i = 0; i < 15; i++)
+;;   y[1][i] = y[0][i+17]
+;; The accesses overlap at distance 1, but the GEPs index different pointers,
+;; so their subscripts cannot be paired up.
+
+define void @different_base(...) nounwind {
+entry:
+  %row1 = getelementptr [16 x [16 x i32]]* @y, i64 0, i64 1
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %i.17 = add i64 %i, 17
+  %ld.addr = getelementptr [16 x [16 x i32]]* @y, i64 0, i64 0, i64 %i.17
+  %st.addr = getelementptr [16 x i32]* %row1, i64 0, i64 %i
+  %x = load i32* %ld.addr     ; 0
+  store i32 %x, i32* %st.addr ; 1
+; CHECK: 0,1: dependent [*]
+  %i.next = add i64 %i, 1
+  %exitcond = icmp eq i64 %i.next, 15
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+;; for (i = 0; i < 2^32-1; i++)
+;;   for (j = 0; j < 2^32-1; j++)
+;;     b[K*i + K*j + K] = b[K*i + K*j], with K = 2^31-1
+;; The Banerjee bounds do not fit in 64 bits.
+
+define void @overflow(...) nounwind {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %i.next = add i64 %i, 1
+  %ik = mul i64 %i, 2147483647
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %j.next = add i64 %j, 1
+  %jk = mul i64 %j, 2147483647
+  %ld.idx = add i64 %ik, %jk
+  %st.idx = add i64 %ld.idx, 2147483647
+  %ld.addr = getelementptr [16 x i8]* @b, i64 0, i64 %ld.idx
+  %st.addr = getelementptr [16 x i8]* @b, i64 0, i64 %st.idx
+  %x = load i8* %ld.addr      ; 0
+  store i8 %x, i8* %st.addr   ; 1
+; CHECK: 0,1: dependent [*,*]
+  %inner.cond = icmp eq i64 %j.next, 4294967295
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %outer.cond = icmp eq i64 %i.next, 4294967295
+  br i1 %outer.cond, label %exit, label %outer
+
+exit:
+  ret void
+}
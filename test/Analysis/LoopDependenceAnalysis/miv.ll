@@ -0,0 +1,141 @@
+; RUN: opt < %s -analyze -lda | FileCheck %s
+
+@x = common global [256 x i32] zeroinitializer, align 4
+@y = common global [16 x [16 x i32]] zeroinitializer, align 4
+
+;; for (i = 0; i < 15; i++)
+;;   for (j = 0; j < 15; j++)
+;;     y[i+1][j] = y[i][j+1]
+
+define void @f1(...) nounwind {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %i.next = add i64 %i, 1
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %j.next = add i64 %j, 1
+  %y.ld.addr = getelementptr [16 x [16 x i32]]* @y, i64 0, i64 %i, i64 %j.next
+  %y.st.addr = getelementptr [16 x [16 x i32]]* @y, i64 0, i64 %i.next, i64 %j
+  %y = load i32* %y.ld.addr     ; 0
+  store i32 %y, i32* %y.st.addr ; 1
+; CHECK: 0,1: dependent [>,<] [-1,1]
+  %inner.cond = icmp eq i64 %j.next, 15
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %outer.cond = icmp eq i64 %i.next, 15
+  br i1 %outer.cond, label %exit, label %outer
+
+exit:
+  ret void
+}
+
+;; for (i = 0; i < 16; i++)
+;;   for (j = 0; j < 16; j++)
+;;     x[2*i+4*j] = x[2*i+4*j+1]
+
+define void @f2(...) nounwind {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %i.2 = mul i64 %i, 2
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %j.4 = mul i64 %j, 4
+  %st.idx = add i64 %i.2, %j.4
+  %ld.idx = add i64 %st.idx, 1
+  %x.ld.addr = getelementptr [256 x i32]* @x, i64 0, i64 %ld.idx
+  %x.st.addr = getelementptr [256 x i32]* @x, i64 0, i64 %st.idx
+  %x = load i32* %x.ld.addr     ; 0
+  store i32 %x, i32* %x.st.addr ; 1
+; CHECK: 0,1: ind
+  %j.next = add i64 %j, 1
+  %inner.cond = icmp eq i64 %j.next, 16
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %i.next = add i64 %i, 1
+  %outer.cond = icmp eq i64 %i.next, 16
+  br i1 %outer.cond, label %exit, label %outer
+
+exit:
+  ret void
+}
+
+;; for (i = 0; i < 10; i++)
+;;   for (j = 0; j < 10; j++)
+;;     x[i+j] = x[i+j+100]
+
+define void @f3(...) nounwind {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %st.idx = add i64 %i, %j
+  %ld.idx = add i64 %st.idx, 100
+  %x.ld.addr = getelementptr [256 x i32]* @x, i64 0, i64 %ld.idx
+  %x.st.addr = getelementptr [256 x i32]* @x, i64 0, i64 %st.idx
+  %x = load i32* %x.ld.addr     ; 0
+  store i32 %x, i32* %x.st.addr ; 1
+; CHECK: 0,1: ind
+  %j.next = add i64 %j, 1
+  %inner.cond = icmp eq i64 %j.next, 10
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %i.next = add i64 %i, 1
+  %outer.cond = icmp eq i64 %i.next, 10
+  br i1 %outer.cond, label %exit, label %outer
+
+exit:
+  ret void
+}
+
+;; for (i = 0; i < 10; i++)
+;;   for (j = 0; j < 10; j++)
+;;     x[10*i+j] = x[10*i+j+10]
+
+define void @f4(...) nounwind {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %i.10 = mul i64 %i, 10
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %st.idx = add i64 %i.10, %j
+  %ld.idx = add i64 %st.idx, 10
+  %x.ld.addr = getelementptr [256 x i32]* @x, i64 0, i64 %ld.idx
+  %x.st.addr = getelementptr [256 x i32]* @x, i64 0, i64 %st.idx
+  %x = load i32* %x.ld.addr     ; 0
+  store i32 %x, i32* %x.st.addr ; 1
+; CHECK: 0,1: dependent [<,>=]
+  %j.next = add i64 %j, 1
+  %inner.cond = icmp eq i64 %j.next, 10
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %i.next = add i64 %i, 1
+  %outer.cond = icmp eq i64 %i.next, 10
+  br i1 %outer.cond, label %exit, label %outer
+
+exit:
+  ret void
+}
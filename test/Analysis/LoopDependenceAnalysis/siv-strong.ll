@@ -18,7 +18,7 @@ for.body:
   %y = load i32* %y.addr      ; 1
   %r = add i32 %y, %x
   store i32 %r, i32* %x.addr  ; 2
-; CHECK: 0,2: dep
+; CHECK: 0,2: dependent [=] [0]
 ; CHECK: 1,2: ind
   %i.next = add i64 %i, 1
   %exitcond = icmp eq i64 %i.next, 256
@@ -45,7 +45,7 @@ for.body:
   %y = load i32* %y.ld.addr     ; 1
   %r = add i32 %y, %x
   store i32 %r, i32* %x.st.addr ; 2
-; CHECK: 0,2: dep
+; CHECK: 0,2: dependent [>] [-1]
 ; CHECK: 1,2: ind
   %exitcond = icmp eq i64 %i.next, 256
   br i1 %exitcond, label %for.end, label %for.body
@@ -71,7 +71,7 @@ for.body:
   %y = load i32* %y.ld.addr     ; 1
   %r = add i32 %y, %x
   store i32 %r, i32* %x.st.addr ; 2
-; CHECK: 0,2: dep
+; CHECK: 0,2: ind
 ; CHECK: 1,2: ind
   %i.next = add i64 %i, 1
   %exitcond = icmp eq i64 %i.next, 10
@@ -99,7 +99,7 @@ for.body:
   %y = load i32* %y.ld.addr     ; 1
   %r = add i32 %y, %x
   store i32 %r, i32* %x.st.addr ; 2
-; CHECK: 0,2: dep
+; CHECK: 0,2: ind
 ; CHECK: 1,2: ind
   %i.next = add i64 %i, 1
   %exitcond = icmp eq i64 %i.next, 10
@@ -0,0 +1,79 @@
+; The writer emits an index of function bodies, which lazy reading uses to
+; find a body without skipping over the ones before it.
+; RUN: llvm-as < %s > %t.bc
+; RUN: llvm-bcanalyzer -dump %t.bc |& FileCheck %s -check-prefix=BC
+; RUN: llvm-dis < %t.bc | FileCheck %s
+; RUN: llvm-extract -func g %t.bc -S | FileCheck %s -check-prefix=LAZY
+; RUN: llvm-extract -delete -func g %t.bc -S | FileCheck %s -check-prefix=DELETE
+
+; Files written before the index was added have no FNINDEX record and must
+; still read, both eagerly and lazily.
+; RUN: llvm-bcanalyzer -dump %S/ssse3_palignr.ll.bc |& FileCheck %s -check-prefix=OLD
+; RUN: llvm-dis < %S/ssse3_palignr.ll.bc | FileCheck %s -check-prefix=OLDDIS
+; RUN: llvm-extract -func align5 %S/ssse3_palignr.ll.bc -S | FileCheck %s -check-prefix=OLDEXTRACT
+
+; BC: <FNINDEX
+; BC: <FUNCTION_BLOCK
+; BC: <FUNCTION_BLOCK
+; BC: <FUNCTION_BLOCK
+; BC: <FUNCTION_BLOCK
+; BC: <FUNCTION_INDEX_BLOCK
+; BC-NEXT: <ENTRY
+; BC-NEXT: <ENTRY
+; BC-NEXT: <ENTRY
+; BC-NEXT: <ENTRY
+; BC-NEXT: </FUNCTION_INDEX_BLOCK>
+
+; CHECK: define i32 @f(i32 %x)
+; CHECK-NEXT: add i32 %x, 1
+; CHECK: define i32 @g(i32 %x)
+; CHECK-NEXT: mul i32 %x, 2
+; CHECK: define i32 @h(i32 %x)
+; CHECK-NEXT: call i32 @g(i32 %x)
+; CHECK: define i32 @k(i32 %x)
+; CHECK-NEXT: sub i32 %x, 3
+
+; LAZY-NOT: define
+; LAZY: define i32 @g(i32 %x)
+; LAZY-NEXT: mul i32 %x, 2
+; LAZY-NEXT: ret i32
+
+; DELETE: define i32 @f(i32 %x)
+; DELETE-NEXT: add i32 %x, 1
+; DELETE: declare i32 @g(i32)
+; DELETE: define i32 @h(i32 %x)
+; DELETE-NEXT: call i32 @g(i32 %x)
+; DELETE: define i32 @k(i32 %x)
+; DELETE-NEXT: sub i32 %x, 3
+
+; OLD-NOT: FNINDEX
+; OLD: <FUNCTION_BLOCK
+; OLD-NOT: FUNCTION_INDEX_BLOCK
+; OLD: </MODULE_BLOCK>
+
+; OLDDIS: define <4 x i32> @align1
+; OLDDIS: define <4 x i32> @align2
+
+; OLDEXTRACT-NOT: define
+; OLDEXTRACT: define double @align5
+; OLDEXTRACT: shufflevector <8 x i8> %2, <8 x i8> %3
+
+define i32 @f(i32 %x) {
+  %a = add i32 %x, 1
+  ret i32 %a
+}
+
+define i32 @g(i32 %x) {
+  %a = mul i32 %x, 2
+  ret i32 %a
+}
+
+define i32 @h(i32 %x) {
+  %a = call i32 @g(i32 %x)
+  ret i32 %a
+}
+
+define i32 @k(i32 %x) {
+  %a = sub i32 %x, 3
+  ret i32 %a
+}
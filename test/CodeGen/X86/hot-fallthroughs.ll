@@ -0,0 +1,36 @@
+; RUN: llc < %s -mtriple=x86_64-linux-gnu | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-linux-gnu -enable-hot-fallthroughs | \
+; RUN:     FileCheck %s -check-prefix=HOT
+
+; The path to the trap ends in unreachable, so %ok is the hot successor of
+; %entry.  By default the blocks stay in source order and the hot path takes
+; the branch; with -enable-hot-fallthroughs %ok falls through.
+
+; CHECK: check:
+; CHECK: jl .LBB0_2
+; CHECK-NEXT: # BB#1: # %fail
+; CHECK-NEXT: ud2
+; CHECK-NEXT: .LBB0_2: # %ok
+
+; HOT: check:
+; HOT: jge .LBB0_1
+; HOT-NEXT: # BB#2: # %ok
+; HOT: ret
+; HOT-NEXT: .LBB0_1: # %fail
+; HOT-NEXT: ud2
+
+define i32 @check(i32 %x) nounwind {
+entry:
+  %bad = icmp sgt i32 %x, 100
+  br i1 %bad, label %fail, label %ok
+
+fail:
+  tail call void @llvm.trap()
+  unreachable
+
+ok:
+  %r = add i32 %x, 1
+  ret i32 %r
+}
+
+declare void @llvm.trap() nounwind
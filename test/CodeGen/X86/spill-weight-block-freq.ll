@@ -0,0 +1,65 @@
+; RUN: llc < %s -mtriple=x86_64-linux-gnu | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-linux-gnu -spill-weight-block-freq | \
+; RUN:     FileCheck %s -check-prefix=FREQ
+
+; More values are live across the calls than there are callee-saved
+; registers.  %h has the most uses, but most of them are in %rare, which the
+; null pointer heuristic makes the unlikely side of the branch.  By loop
+; depth every use counts the same, so %f is spilled instead of %h.  By
+; block frequency the uses in %rare count for less, and %h is spilled.
+
+; CHECK: imull $10, {{%[a-z0-9]+}}, {{%[a-z0-9]+}}
+; CHECK-NEXT: leal (,{{%[a-z0-9]+}},8), [[F:%[a-z0-9]+]]
+; CHECK-NEXT: movl [[F]], {{[0-9]+}}(%rsp) {{.*}}Spill
+
+; FREQ: imull $10, {{%[a-z0-9]+}}, [[H:%[a-z0-9]+]]
+; FREQ-NEXT: movl [[H]], {{[0-9]+}}(%rsp) {{.*}}Spill
+; FREQ-NEXT: leal (,{{%[a-z0-9]+}},8), {{%[a-z0-9]+}}
+
+declare void @g()
+declare void @use(i32)
+
+define void @f(i32* %q, i32 %x) nounwind {
+entry:
+  %a = mul i32 %x, 3
+  %b = mul i32 %x, 4
+  %c = mul i32 %x, 5
+  %d = mul i32 %x, 6
+  %e = mul i32 %x, 7
+  %f = mul i32 %x, 8
+  %g = mul i32 %x, 9
+  %h = mul i32 %x, 10
+  call void @g()
+  %isnull = icmp eq i32* %q, null
+  br i1 %isnull, label %rare, label %common
+
+common:
+  call void @use(i32 %a)
+  call void @use(i32 %a)
+  call void @use(i32 %b)
+  br label %join
+
+rare:
+  call void @use(i32 %h)
+  call void @use(i32 %h)
+  call void @use(i32 %h)
+  call void @use(i32 %g)
+  br label %join
+
+join:
+  call void @use(i32 %a)
+  call void @use(i32 %b)
+  call void @use(i32 %c)
+  call void @use(i32 %d)
+  call void @use(i32 %d)
+  call void @use(i32 %d)
+  call void @use(i32 %e)
+  call void @use(i32 %e)
+  call void @use(i32 %e)
+  call void @use(i32 %f)
+  call void @use(i32 %f)
+  call void @use(i32 %f)
+  call void @use(i32 %g)
+  call void @use(i32 %h)
+  ret void
+}
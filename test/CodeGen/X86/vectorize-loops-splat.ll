@@ -0,0 +1,30 @@
+; RUN: llc < %s -march=x86-64 -mcpu=core2 -vectorize-loops | FileCheck %s
+
+; The load from the loop-invariant address is repeated in the vector loop, so
+; its splat must follow it there rather than go to the preheader.
+
+define void @invariant_load(i32* noalias nocapture %a, i32* noalias %q,
+                            i64 %n) nounwind {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %p = getelementptr inbounds i32* %a, i64 %i
+  %v = load i32* %p, align 4
+  %w = load i32* %q, align 4
+  %s = add i32 %v, %w
+  store i32 %s, i32* %p, align 4
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; CHECK: invariant_load:
+; CHECK: movd (%rsi), [[W:%xmm[0-9]+]]
+; CHECK-NEXT: pshufd $0, [[W]], [[W]]
+; CHECK: paddd
+; CHECK: movdqu
@@ -0,0 +1,59 @@
+; RUN: llc -mtriple=x86_64-unknown-linux-gnu -dwarf-string-pool < %s | FileCheck %s
+; RUN: llc -mtriple=x86_64-unknown-linux-gnu -dwarf-string-pool -filetype=obj %s -o - \
+; RUN:   | elf-dump --dump-section-data | FileCheck %s -check-prefix=OBJ
+
+; With -dwarf-string-pool, DIE strings are DW_FORM_strp references into
+; .debug_str.  The producer, directory and type name are the same in both
+; units and are emitted only once, each with its terminating null byte.
+
+; CHECK: DW_TAG_compile_unit
+; CHECK-NEXT: .long [[PRODUCER:.Lstring[0-9]+]] # DW_AT_producer
+; CHECK: .long [[DIR:.Lstring[0-9]+]] # DW_AT_comp_dir
+; CHECK: DW_TAG_base_type
+; CHECK-NEXT: DW_AT_encoding
+; CHECK-NEXT: .long [[INT:.Lstring[0-9]+]] # DW_AT_name
+; CHECK: DW_TAG_compile_unit
+; CHECK-NEXT: .long [[PRODUCER]] # DW_AT_producer
+; CHECK: .long [[DIR]] # DW_AT_comp_dir
+; CHECK: DW_TAG_base_type
+; CHECK-NEXT: DW_AT_encoding
+; CHECK-NEXT: .long [[INT]] # DW_AT_name
+
+; CHECK: DW_TAG_compile_unit
+; CHECK-NEXT: DW_CHILDREN_yes
+; CHECK-NEXT: DW_AT_producer
+; CHECK-NEXT: DW_FORM_strp
+
+; CHECK: .section .debug_str
+; CHECK-NEXT: .Lstring0:
+; CHECK-NEXT: .asciz "clang"
+; CHECK-NEXT: .Lstring1:
+; CHECK-NEXT: .asciz "a.c"
+; CHECK-NEXT: .Lstring2:
+; CHECK-NEXT: .asciz "/tmp"
+; CHECK-NEXT: .Lstring3:
+; CHECK-NEXT: .asciz "b.c"
+; CHECK-NEXT: .Lstring4:
+; CHECK-NEXT: .asciz "i"
+; CHECK-NEXT: .Lstring5:
+; CHECK-NEXT: .asciz "int"
+; CHECK-NEXT: .Lstring6:
+; CHECK-NEXT: .asciz "j"
+
+; OBJ: '.debug_str'
+; OBJ: ('sh_size', 27)
+; OBJ: ('_section_data', '636c616e 6700612e 63002f74 6d700062 2e630069 00696e74 006a00')
+
+@i = global i32 1
+@j = global i32 2
+
+!llvm.dbg.gv = !{!0, !4}
+
+!0 = metadata !{i32 524340, i32 0, metadata !1, metadata !"i", metadata !"i", metadata !"", metadata !1, i32 1, metadata !3, i1 false, i1 true, i32* @i} ; [ DW_TAG_variable ]
+!1 = metadata !{i32 524329, metadata !"a.c", metadata !"/tmp", metadata !2} ; [ DW_TAG_file_type ]
+!2 = metadata !{i32 524305, i32 0, i32 1, metadata !"a.c", metadata !"/tmp", metadata !"clang", i1 true, i1 false, metadata !"", i32 0} ; [ DW_TAG_compile_unit ]
+!3 = metadata !{i32 524324, metadata !1, metadata !"int", metadata !1, i32 0, i64 32, i64 32, i64 0, i32 0, i32 5} ; [ DW_TAG_base_type ]
+!4 = metadata !{i32 524340, i32 0, metadata !5, metadata !"j", metadata !"j", metadata !"", metadata !5, i32 1, metadata !7, i1 false, i1 true, i32* @j} ; [ DW_TAG_variable ]
+!5 = metadata !{i32 524329, metadata !"b.c", metadata !"/tmp", metadata !6} ; [ DW_TAG_file_type ]
+!6 = metadata !{i32 524305, i32 0, i32 1, metadata !"b.c", metadata !"/tmp", metadata !"clang", i1 false, i1 false, metadata !"", i32 0} ; [ DW_TAG_compile_unit ]
+!7 = metadata !{i32 524324, metadata !5, metadata !"int", metadata !5, i32 0, i64 32, i64 32, i64 0, i32 0, i32 5} ; [ DW_TAG_base_type ]
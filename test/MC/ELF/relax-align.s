@@ -0,0 +1,61 @@
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu %s -o - | elf-dump | FileCheck %s
+
+// Relaxing a branch can make an earlier branch that jumps over it need
+// relaxation too, unless alignment padding absorbs the growth.
+
+// The jmp to cascade_far must be relaxed, which pushes cascade_end out of
+// range of the short jne before it.
+	.section	.text.cascade,"ax",@progbits
+	jne	cascade_end
+	.fill	120, 1, 0x90
+	jmp	cascade_far
+	.fill	5, 1, 0x90
+cascade_end:
+	.fill	200, 1, 0x90
+cascade_far:
+	ret
+
+// The padding before absorbed_end shrinks by as much as the jmp grows, so the
+// jne stays short.
+	.section	.text.absorbed,"ax",@progbits
+	jne	absorbed_end
+	.fill	118, 1, 0x90
+	jmp	absorbed_far
+	.align	8, 0x90
+absorbed_end:
+	.fill	200, 1, 0x90
+absorbed_far:
+	ret
+
+// The jmp grows past the next alignment boundary, so crossed_end moves by a
+// whole alignment unit and the jne has to be relaxed after all.
+	.section	.text.crossed,"ax",@progbits
+	jne	crossed_end
+	.fill	120, 1, 0x90
+	jmp	crossed_far
+	.align	4, 0x90
+	.fill	2, 1, 0x90
+crossed_end:
+	.fill	200, 1, 0x90
+crossed_far:
+	ret
+
+// CHECK: # '.text.cascade'
+// CHECK: ('sh_size', 337)
+// CHECK: # '.text.absorbed'
+// CHECK: ('sh_size', 329)
+// CHECK: # '.text.crossed'
+// CHECK: ('sh_size', 335)
+
+// CHECK: # 'absorbed_end'
+// CHECK: ('st_value', 128)
+// CHECK: # 'absorbed_far'
+// CHECK: ('st_value', 328)
+// CHECK: # 'cascade_end'
+// CHECK: ('st_value', 136)
+// CHECK: # 'cascade_far'
+// CHECK: ('st_value', 336)
+// CHECK: # 'crossed_end'
+// CHECK: ('st_value', 134)
+// CHECK: # 'crossed_far'
+// CHECK: ('st_value', 334)
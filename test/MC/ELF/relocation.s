@@ -1,6 +1,7 @@
 // RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu %s -o - | elf-dump  --dump-section-data | FileCheck  %s
 
-// Test that we produce a R_X86_64_32S or R_X86_64_32.
+// Test that we produce the correct relocation types for all 64-bit
+// fixups.
 
 bar:
         movl	$bar, %edx        // R_X86_64_32
@@ -9,6 +10,13 @@ bar:
         movl	bar, %edx         // R_X86_64_32S
         movq	bar, %rdx         // R_X86_64_32S
 .long bar                         // R_X86_64_32
+        leaq	foo@GOTTPOFF(%rip), %rax // R_X86_64_GOTTPOFF
+        leaq	foo@TLSGD(%rip), %rax    // R_X86_64_TLSGD
+        leaq	foo@TPOFF(%rax), %rax    // R_X86_64_TPOFF32
+        .quad	foo@GOTOFF               // R_X86_64_GOTOFF64
+        .quad	foo - .                  // R_X86_64_PC64
+        .word	foo - .                  // R_X86_64_PC16
+        .byte	foo - .                  // R_X86_64_PC8
 
 // CHECK:  # Section 1
 // CHECK: (('sh_name', 1) # '.text'
@@ -20,6 +28,9 @@ bar:
 // CHECK:  ('st_other', 0)
 // CHECK:  ('st_shndx', 1)
 
+// CHECK:   # Symbol 6
+// CHECK-NEXT: (('st_name', {{[0-9]+}}) # 'foo'
+
 // CHECK: # Relocation 0
 // CHECK-NEXT:  (('r_offset', 1)
 // CHECK-NEXT:   ('r_sym', 2)
@@ -55,3 +66,45 @@ bar:
 // CHECK-NEXT:   ('r_sym', 2)
 // CHECK-NEXT:   ('r_type', 10)
 // CHECK-NEXT:   ('r_addend',
+
+// CHECK: # Relocation 6
+// CHECK-NEXT:  (('r_offset', 45)
+// CHECK-NEXT:   ('r_sym', 6)
+// CHECK-NEXT:   ('r_type', 22)
+// CHECK-NEXT:   ('r_addend', -4)
+
+// CHECK: # Relocation 7
+// CHECK-NEXT:  (('r_offset', 52)
+// CHECK-NEXT:   ('r_sym', 6)
+// CHECK-NEXT:   ('r_type', 19)
+// CHECK-NEXT:   ('r_addend', -4)
+
+// CHECK: # Relocation 8
+// CHECK-NEXT:  (('r_offset', 59)
+// CHECK-NEXT:   ('r_sym', 6)
+// CHECK-NEXT:   ('r_type', 23)
+// CHECK-NEXT:   ('r_addend', 0)
+
+// CHECK: # Relocation 9
+// CHECK-NEXT:  (('r_offset', 63)
+// CHECK-NEXT:   ('r_sym', 6)
+// CHECK-NEXT:   ('r_type', 25)
+// CHECK-NEXT:   ('r_addend', 0)
+
+// CHECK: # Relocation 10
+// CHECK-NEXT:  (('r_offset', 71)
+// CHECK-NEXT:   ('r_sym', 6)
+// CHECK-NEXT:   ('r_type', 24)
+// CHECK-NEXT:   ('r_addend', 0)
+
+// CHECK: # Relocation 11
+// CHECK-NEXT:  (('r_offset', 79)
+// CHECK-NEXT:   ('r_sym', 6)
+// CHECK-NEXT:   ('r_type', 13)
+// CHECK-NEXT:   ('r_addend', 0)
+
+// CHECK: # Relocation 12
+// CHECK-NEXT:  (('r_offset', 81)
+// CHECK-NEXT:   ('r_sym', 6)
+// CHECK-NEXT:   ('r_type', 15)
+// CHECK-NEXT:   ('r_addend', 0)
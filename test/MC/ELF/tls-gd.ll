@@ -0,0 +1,32 @@
+; RUN: llc -filetype=obj -mtriple x86_64-pc-linux-gnu -relocation-model=pic \
+; RUN:     %s -o - | elf-dump --dump-section-data | FileCheck %s
+
+; The general dynamic sequence keeps the padding prefixes the linker expects
+; and gets its R_X86_64_TLSGD and R_X86_64_PLT32 relocations.
+
+@i = thread_local global i32 15
+
+define i32 @f() nounwind {
+  %t = load i32* @i
+  ret i32 %t
+}
+
+; CHECK: '.text'
+; CHECK: '_section_data', '4883ec08 66488d3d 00000000 666648e8 00000000 8b004883 c408c3'
+
+; CHECK: # Symbol 8
+; CHECK-NEXT: (('st_name', {{[0-9]+}}) # 'i'
+; CHECK: # Symbol 10
+; CHECK-NEXT: (('st_name', {{[0-9]+}}) # '__tls_get_addr'
+
+; CHECK: '.rela.text'
+; CHECK: # Relocation 0
+; CHECK-NEXT: (('r_offset', 8)
+; CHECK-NEXT:  ('r_sym', 8)
+; CHECK-NEXT:  ('r_type', 19)
+; CHECK-NEXT:  ('r_addend', -4)
+; CHECK: # Relocation 1
+; CHECK-NEXT: (('r_offset', 16)
+; CHECK-NEXT:  ('r_sym', 10)
+; CHECK-NEXT:  ('r_type', 4)
+; CHECK-NEXT:  ('r_addend', -4)
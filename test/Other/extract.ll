@@ -1,5 +1,6 @@
 ; RUN: llvm-extract -func foo -S < %s | FileCheck %s
 ; RUN: llvm-extract -delete -func foo -S < %s | FileCheck --check-prefix=DELETE %s
+; RUN: llvm-extract -func foo -S %s | FileCheck %s
 ; RUN: llvm-as < %s > %t
 ; RUN: llvm-extract -func foo -S %t | FileCheck %s
 ; RUN: llvm-extract -delete -func foo -S %t | FileCheck --check-prefix=DELETE %s
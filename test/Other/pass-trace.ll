@@ -0,0 +1,19 @@
+; RUN: opt < %s -instcombine -pass-trace=%t -disable-output
+; RUN: FileCheck < %t %s
+
+; CHECK: {"traceEvents":[
+; CHECK: {"name":"Combine redundant instructions","cat":"function","ph":"X"
+; CHECK: "function":"foo","instructions":-1,
+; CHECK: "function":"café","instructions":-1,
+; CHECK: ]}
+
+define i32 @foo(i32 %x) {
+  %a = add i32 %x, 0
+  ret i32 %a
+}
+
+; Names are UTF-8 and are written out as is.
+define i32 @"caf\C3\A9"(i32 %x) {
+  %a = add i32 %x, 0
+  ret i32 %a
+}
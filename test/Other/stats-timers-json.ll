@@ -0,0 +1,21 @@
+; With both -stats-json and -timers-json, each report is one JSON object on a
+; line of its own.
+; RUN: opt < %s -instcombine -stats -stats-json -time-passes -timers-json \
+; RUN:     -disable-output |& FileCheck %s
+; CHECK: {{^}}{"statistics": [{"name": "instcombine", "desc": "Number of insts combined", "value": 1}]}{{$}}
+; CHECK-NEXT: {{^}}{"timers": {"group": "... Pass execution timing report ...", "entries": [
+; CHECK: {"name": "Combine redundant instructions", "wall": {{[0-9.]+}}, "user": {{[0-9.]+}}, "system": {{[0-9.]+}}, "mem": 0}
+; CHECK: ], "total": {"wall": {{[0-9.]+}}, "user": {{[0-9.]+}}, "system": {{[0-9.]+}}, "mem": 0}}}{{$}}
+
+; Without the JSON options the reports are still printed as tables.
+; RUN: opt < %s -instcombine -stats -time-passes -disable-output |& \
+; RUN:     FileCheck %s -check-prefix=TEXT
+; TEXT: ... Statistics Collected ...
+; TEXT: 1 instcombine - Number of insts combined
+; TEXT: ... Pass execution timing report ...
+; TEXT: Combine redundant instructions
+
+define i32 @foo(i32 %x) {
+  %a = add i32 %x, 0
+  ret i32 %a
+}
@@ -0,0 +1,47 @@
+; Edge profile for the module below: @callee's entry runs 11 times, @caller's
+; entry once, and its loop body 10 times.
+; RUN: printf {\\004\\000\\000\\000\\005\\000\\000\\000\\013\\000\\000\\000\\001\\000\\000\\000\\001\\000\\000\\000\\001\\000\\000\\000\\011\\000\\000\\000} > %t.prof
+
+; Without -inline-profile both calls are too expensive for the threshold.
+; RUN: opt < %s -profile-loader -profile-info-file=%t.prof -inline \
+; RUN:     -inline-threshold=1 -S | FileCheck %s -check-prefix=NOPROF
+; NOPROF: %cold = call i32 @callee
+; NOPROF: %hot = call i32 @callee
+
+; With it, the call in the loop gets the hot threshold and the call outside it
+; is considered cold and left alone.
+; RUN: opt < %s -profile-loader -profile-info-file=%t.prof -inline-profile \
+; RUN:     -inline -inline-threshold=1 -inline-hot-fraction=2 \
+; RUN:     -inline-cold-fraction=5 -S | FileCheck %s
+; CHECK: define i32 @caller
+; CHECK: %cold = call i32 @callee
+; CHECK-NOT: %hot = call
+; CHECK: ret i32
+
+define i32 @callee(i32 %x) {
+entry:
+  %a = add i32 %x, 1
+  %b = mul i32 %a, %a
+  %c = add i32 %b, %x
+  %d = mul i32 %c, %c
+  %e = add i32 %d, %a
+  ret i32 %e
+}
+
+define i32 @caller(i32 %n) {
+entry:
+  %cold = call i32 @callee(i32 %n)
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ %cold, %entry ], [ %s.next, %loop ]
+  %hot = call i32 @callee(i32 %i)
+  %s.next = add i32 %s, %hot
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 %s.next
+}
@@ -0,0 +1,64 @@
+; RUN: opt < %s -loopsimplify -loop-vectorize -force-vector-width=8 -S | \
+; RUN:     FileCheck %s
+; RUN: opt < %s -loopsimplify -loop-vectorize -force-vector-width=6 -S | \
+; RUN:     FileCheck %s -check-prefix=ROUND
+
+; A forced width is rounded down to a power of two, and never goes past the
+; widest vector that a dependence distance allows.
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+
+define void @independent(i32* noalias nocapture %a, i32* noalias nocapture %b,
+                         i64 %n) nounwind {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %p = getelementptr inbounds i32* %b, i64 %i
+  %v = load i32* %p, align 4
+  %m = mul i32 %v, 3
+  %q = getelementptr inbounds i32* %a, i64 %i
+  store i32 %m, i32* %q, align 4
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; CHECK: @independent
+; CHECK: vector.body:
+; CHECK: mul <8 x i32>
+; ROUND: @independent
+; ROUND: vector.body:
+; ROUND: mul <4 x i32>
+
+; The store is three elements ahead of the load, so at most two lanes.
+define void @two_lanes(i32* nocapture %a, i64 %n) nounwind {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %p = getelementptr inbounds i32* %a, i64 %i
+  %v = load i32* %p, align 4
+  %m = mul i32 %v, 3
+  %i3 = add i64 %i, 3
+  %q = getelementptr inbounds i32* %a, i64 %i3
+  store i32 %m, i32* %q, align 4
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; CHECK: @two_lanes
+; CHECK: vector.body:
+; CHECK: mul <2 x i32>
+; ROUND: @two_lanes
+; ROUND: vector.body:
+; ROUND: mul <2 x i32>
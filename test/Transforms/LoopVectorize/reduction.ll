@@ -0,0 +1,63 @@
+; RUN: opt < %s -loopsimplify -loop-vectorize -S | FileCheck %s
+
+; Integer reductions keep one partial result per lane and combine them after
+; the vector loop.
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+
+define i32 @sum(i32* nocapture %a, i64 %n) nounwind readonly {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 7, %entry ], [ %s.next, %loop ]
+  %p = getelementptr inbounds i32* %a, i64 %i
+  %v = load i32* %p, align 4
+  %s.next = add i32 %s, %v
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 %s.next
+}
+
+; CHECK: @sum
+; CHECK: vector.body:
+; CHECK: %s.vec = phi <4 x i32> [ <i32 7, i32 0, i32 0, i32 0>, %entry ]
+; CHECK: load <4 x i32>*
+; CHECK: add <4 x i32> %s.vec
+; CHECK: middle.block:
+; CHECK: extractelement <4 x i32> {{.*}}, i32 3
+; CHECK: scalar.ph:
+; CHECK: %s.resume = phi i32 [ 7, %entry ]
+; CHECK: ret i32 %s.next
+
+; The partial sums of a reduction that is also used inside the loop mean
+; nothing lane by lane, so the loop is left alone.
+
+define void @prefix_sum(i32* noalias nocapture %a, i32* noalias nocapture %b,
+                        i64 %n) nounwind {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  %p = getelementptr inbounds i32* %a, i64 %i
+  %v = load i32* %p, align 4
+  %s.next = add i32 %s, %v
+  %q = getelementptr inbounds i32* %b, i64 %i
+  store i32 %s.next, i32* %q, align 4
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; CHECK: @prefix_sum
+; CHECK-NOT: vector.body
+; CHECK: ret void
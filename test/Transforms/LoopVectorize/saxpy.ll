@@ -0,0 +1,45 @@
+; RUN: opt < %s -loopsimplify -loop-vectorize -S | FileCheck %s
+
+; y[i] = a * x[i] + y[i].  x and y may overlap, so the vector loop is guarded
+; by a run-time check.
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+
+define void @saxpy(i64 %n, float %a, float* %x, float* %y) nounwind {
+entry:
+  %cmp = icmp sgt i64 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %px = getelementptr inbounds float* %x, i64 %i
+  %vx = load float* %px, align 4
+  %mul = fmul float %vx, %a
+  %py = getelementptr inbounds float* %y, i64 %i
+  %vy = load float* %py, align 4
+  %add = fadd float %mul, %vy
+  store float %add, float* %py, align 4
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; CHECK: @saxpy
+; CHECK: %overlap = and i1
+; CHECK: br i1 {{.*}}, label %scalar.ph, label %vector.body
+; CHECK: vector.body:
+; CHECK: %index = phi i64 [ 0, %{{.*}} ], [ %index.next, %vector.body ]
+; CHECK: load <4 x float>* {{.*}}, align 4
+; CHECK: fmul <4 x float> {{.*}}, %a.splat
+; CHECK: load <4 x float>* {{.*}}, align 4
+; CHECK: fadd <4 x float>
+; CHECK: store <4 x float> {{.*}}, align 4
+; CHECK: %index.next = add i64 %index, 4
+; CHECK: middle.block:
+; CHECK: scalar.ph:
+; CHECK: %i.resume = phi i64
+; CHECK: loop:
+; CHECK: %i = phi i64 {{.*}}[ %i.resume, %scalar.ph ]
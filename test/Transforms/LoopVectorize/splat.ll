@@ -0,0 +1,63 @@
+; RUN: opt < %s -basicaa -loopsimplify -loop-vectorize -force-vector-width=4 \
+; RUN:     -S | FileCheck %s
+
+; Values the vector loop computes itself are splatted in the vector loop, after
+; their definition; only values from outside the loop go to the preheader.
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+
+; An induction variable used as data.
+define void @induction(i32* noalias nocapture %a, i64 %n) nounwind {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %t = trunc i64 %i to i32
+  %p = getelementptr inbounds i32* %a, i64 %i
+  store i32 %t, i32* %p, align 4
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; CHECK: @induction
+; CHECK: vector.body:
+; CHECK: %index = phi
+; CHECK: %i.lane0 = add i64 0,
+; CHECK: insertelement <4 x i64> undef, i64 %i.lane0, i32 0
+; CHECK: add <4 x i64> %i.lane0.splat, <i64 0, i64 1, i64 2, i64 3>
+; CHECK: trunc <4 x i64>
+; CHECK: store <4 x i32>
+
+; A load from a loop-invariant address.
+define void @invariant_load(i32* noalias nocapture %a, i32* noalias %q,
+                            i64 %n) nounwind {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %p = getelementptr inbounds i32* %a, i64 %i
+  %v = load i32* %p, align 4
+  %w = load i32* %q, align 4
+  %s = add i32 %v, %w
+  store i32 %s, i32* %p, align 4
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; CHECK: @invariant_load
+; CHECK: vector.body:
+; CHECK: [[W:%w[0-9]*]] = load i32* %q, align 4
+; CHECK: insertelement <4 x i32> undef, i32 [[W]], i32 0
+; CHECK: [[W]].splat = shufflevector
+; CHECK: add <4 x i32> %v{{[0-9]*}}, [[W]].splat
+; CHECK: store <4 x i32>
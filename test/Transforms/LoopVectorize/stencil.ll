@@ -0,0 +1,43 @@
+; RUN: opt < %s -loopsimplify -loop-vectorize -S | FileCheck %s
+
+; b[i] = a[i] + a[i+1] + a[i+2] on doubles.  The arrays are noalias, so no
+; run-time check is needed, and the vectors hold two lanes.
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+
+define void @stencil(double* noalias nocapture %a, double* noalias nocapture %b,
+                     i64 %n) nounwind {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %i1 = add i64 %i, 1
+  %i2 = add i64 %i, 2
+  %p0 = getelementptr inbounds double* %a, i64 %i
+  %p1 = getelementptr inbounds double* %a, i64 %i1
+  %p2 = getelementptr inbounds double* %a, i64 %i2
+  %v0 = load double* %p0, align 8
+  %v1 = load double* %p1, align 8
+  %v2 = load double* %p2, align 8
+  %s0 = fadd double %v0, %v1
+  %s1 = fadd double %s0, %v2
+  %q = getelementptr inbounds double* %b, i64 %i
+  store double %s1, double* %q, align 8
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; CHECK: @stencil
+; CHECK-NOT: overlap
+; CHECK: vector.body:
+; CHECK: load <2 x double>* {{.*}}, align 8
+; CHECK: load <2 x double>* {{.*}}, align 8
+; CHECK: load <2 x double>* {{.*}}, align 8
+; CHECK: fadd <2 x double>
+; CHECK: fadd <2 x double>
+; CHECK: store <2 x double>
@@ -0,0 +1,69 @@
+; RUN: opt < %s -basicaa -slp-vectorize -S | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+
+; a[0] = b[0] + 1; a[1] = b[1] + 1; with a and b possibly overlapping.  The
+; load of b[1] would have to move above the store to a[0].
+
+define void @overlap(i32* %a, i32* %b) nounwind {
+entry:
+  %b0 = load i32* %b, align 4
+  %s0 = add i32 %b0, 1
+  store i32 %s0, i32* %a, align 4
+  %pb1 = getelementptr inbounds i32* %b, i64 1
+  %pa1 = getelementptr inbounds i32* %a, i64 1
+  %b1 = load i32* %pb1, align 4
+  %s1 = add i32 %b1, 1
+  store i32 %s1, i32* %pa1, align 4
+  ret void
+}
+
+; CHECK: @overlap
+; CHECK-NOT: <2 x i32>
+; CHECK: ret void
+
+; Both elements are read before either is written, so this is vectorized.
+
+define void @invert(i64* noalias %a, i64* noalias %b) nounwind {
+entry:
+  %pb1 = getelementptr inbounds i64* %b, i64 1
+  %pa1 = getelementptr inbounds i64* %a, i64 1
+  %b0 = load i64* %b, align 8
+  %b1 = load i64* %pb1, align 8
+  %x0 = xor i64 %b0, -1
+  %x1 = xor i64 %b1, -1
+  store i64 %x0, i64* %a, align 8
+  store i64 %x1, i64* %pa1, align 8
+  ret void
+}
+
+; CHECK: @invert
+; CHECK: load <2 x i64>
+; CHECK: xor <2 x i64> {{.*}}, <i64 -1, i64 -1>
+; CHECK: store <2 x i64>
+; CHECK: ret void
+
+; The last store of the group is the insertion point.  The call after it may
+; write a, but nothing moves past it.
+
+declare void @clobber()
+
+define void @last_is_insert_point(i64* %a, i64* noalias %b) nounwind {
+entry:
+  %pb1 = getelementptr inbounds i64* %b, i64 1
+  %pa1 = getelementptr inbounds i64* %a, i64 1
+  %b0 = load i64* %b, align 8
+  %b1 = load i64* %pb1, align 8
+  %x0 = xor i64 %b0, -1
+  %x1 = xor i64 %b1, -1
+  store i64 %x0, i64* %a, align 8
+  store i64 %x1, i64* %pa1, align 8
+  call void @clobber()
+  ret void
+}
+
+; CHECK: @last_is_insert_point
+; CHECK: load <2 x i64>
+; CHECK: store <2 x i64>
+; CHECK: call void @clobber()
+; CHECK: ret void
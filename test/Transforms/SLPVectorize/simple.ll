@@ -0,0 +1,65 @@
+; RUN: opt < %s -basicaa -slp-vectorize -S | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+
+; a[0..3] = b[0..3] + c[0..3], with noalias arguments.
+
+define void @add4(i32* noalias %a, i32* noalias %b, i32* noalias %c) nounwind {
+entry:
+  %b0 = load i32* %b, align 4
+  %c0 = load i32* %c, align 4
+  %s0 = add i32 %b0, %c0
+  store i32 %s0, i32* %a, align 4
+  %pb1 = getelementptr inbounds i32* %b, i64 1
+  %pc1 = getelementptr inbounds i32* %c, i64 1
+  %pa1 = getelementptr inbounds i32* %a, i64 1
+  %b1 = load i32* %pb1, align 4
+  %c1 = load i32* %pc1, align 4
+  %s1 = add i32 %c1, %b1
+  store i32 %s1, i32* %pa1, align 4
+  %pb2 = getelementptr inbounds i32* %b, i64 2
+  %pc2 = getelementptr inbounds i32* %c, i64 2
+  %pa2 = getelementptr inbounds i32* %a, i64 2
+  %b2 = load i32* %pb2, align 4
+  %c2 = load i32* %pc2, align 4
+  %s2 = add i32 %b2, %c2
+  store i32 %s2, i32* %pa2, align 4
+  %pb3 = getelementptr inbounds i32* %b, i64 3
+  %pc3 = getelementptr inbounds i32* %c, i64 3
+  %pa3 = getelementptr inbounds i32* %a, i64 3
+  %b3 = load i32* %pb3, align 4
+  %c3 = load i32* %pc3, align 4
+  %s3 = add i32 %b3, %c3
+  store i32 %s3, i32* %pa3, align 4
+  ret void
+}
+
+; CHECK: @add4
+; CHECK: load <4 x i32>* {{.*}}, align 4
+; CHECK: load <4 x i32>* {{.*}}, align 4
+; CHECK: add <4 x i32>
+; CHECK: store <4 x i32> {{.*}}, align 4
+; CHECK-NOT: store i32
+; CHECK: ret void
+
+; Two doubles scaled by a constant; the constants form a vector constant and
+; a scalar that is used again is extracted.
+
+define double @scale2(double* noalias %a, double* noalias %b) nounwind {
+entry:
+  %b0 = load double* %b, align 8
+  %m0 = fmul double %b0, 2.000000e+00
+  store double %m0, double* %a, align 8
+  %pb1 = getelementptr inbounds double* %b, i64 1
+  %pa1 = getelementptr inbounds double* %a, i64 1
+  %b1 = load double* %pb1, align 8
+  %m1 = fmul double %b1, 3.000000e+00
+  store double %m1, double* %pa1, align 8
+  ret double %m1
+}
+
+; CHECK: @scale2
+; CHECK: [[V:%[a-z0-9.]+]] = fmul <2 x double> {{.*}}, <double 2.000000e+00, double 3.000000e+00>
+; CHECK: store <2 x double> [[V]]
+; CHECK: [[E:%[0-9]+]] = extractelement <2 x double> [[V]], i32 1
+; CHECK: ret double [[E]]
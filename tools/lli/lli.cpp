@@ -127,7 +127,9 @@ int main(int argc, char **argv, char * const *envp) {
   // Load the bitcode...
   std::string ErrorMsg;
   Module *Mod = NULL;
-  if (MemoryBuffer *Buffer = MemoryBuffer::getFileOrSTDIN(InputFile,&ErrorMsg)){
+  if (MemoryBuffer *Buffer =
+        MemoryBuffer::getFileOrSTDIN(InputFile, &ErrorMsg, -1, 0,
+                                     /*RequiresNullTerminator=*/false)) {
     Mod = getLazyBitcodeModule(Buffer, Context, &ErrorMsg);
     if (!Mod) delete Buffer;
   }
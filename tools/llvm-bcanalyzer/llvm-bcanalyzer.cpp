@@ -100,6 +100,7 @@ static const char *GetBlockName(unsigned BlockID,
   case bitc::VALUE_SYMTAB_BLOCK_ID:  return "VALUE_SYMTAB";
   case bitc::METADATA_BLOCK_ID:      return "METADATA_BLOCK";
   case bitc::METADATA_ATTACHMENT_ID: return "METADATA_ATTACHMENT_BLOCK";
+  case bitc::FUNCTION_INDEX_BLOCK_ID: return "FUNCTION_INDEX_BLOCK";
   }
 }
 
@@ -147,6 +148,7 @@ static const char *GetCodeName(unsigned CodeID, unsigned BlockID,
     case bitc::MODULE_CODE_ALIAS:       return "ALIAS";
     case bitc::MODULE_CODE_PURGEVALS:   return "PURGEVALS";
     case bitc::MODULE_CODE_GCNAME:      return "GCNAME";
+    case bitc::MODULE_CODE_FNINDEX:     return "FNINDEX";
     }
   case bitc::PARAMATTR_BLOCK_ID:
     switch (CodeID) {
@@ -250,6 +252,11 @@ static const char *GetCodeName(unsigned CodeID, unsigned BlockID,
     case bitc::VST_CODE_ENTRY: return "ENTRY";
     case bitc::VST_CODE_BBENTRY: return "BBENTRY";
     }
+  case bitc::FUNCTION_INDEX_BLOCK_ID:
+    switch (CodeID) {
+    default: return 0;
+    case bitc::FNINDEX_CODE_ENTRY: return "ENTRY";
+    }
   case bitc::METADATA_ATTACHMENT_ID:
     switch(CodeID) {
     default:return 0;
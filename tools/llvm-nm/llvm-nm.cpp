@@ -69,8 +69,20 @@ namespace {
   std::string ToolName;
 }
 
+/// isUndefined - Return true if GV has no definition in its module.  Function
+/// bodies are read lazily, so a function that is still materializable counts
+/// as a definition even though its body is empty.
+static bool isUndefined(const GlobalValue &GV) {
+  const GlobalValue *Def = &GV;
+  if (const GlobalAlias *GA = dyn_cast<GlobalAlias>(Def)) {
+    Def = GA->getAliasedGlobal();
+    if (!Def) return false;
+  }
+  return Def->isDeclaration() && !Def->isMaterializable();
+}
+
 static char TypeCharForSymbol(GlobalValue &GV) {
-  if (GV.isDeclaration())                                  return 'U';
+  if (isUndefined(GV))                                     return 'U';
   if (GV.hasLinkOnceLinkage())                             return 'C';
   if (GV.hasCommonLinkage())                               return 'C';
   if (GV.hasWeakLinkage())                                 return 'W';
@@ -143,11 +155,16 @@ static void DumpSymbolNamesFromFile(std::string &Filename) {
   sys::Path aPath(Filename);
   // Note: Currently we do not support reading an archive from stdin.
   if (Filename == "-" || aPath.isBitcodeFile()) {
-    std::auto_ptr<MemoryBuffer> Buffer(
-                   MemoryBuffer::getFileOrSTDIN(Filename, &ErrorMessage));
+    // Only the module-level symbol table is needed, so map the file in and
+    // leave the function bodies unread.
+    MemoryBuffer *Buffer =
+      MemoryBuffer::getFileOrSTDIN(Filename, &ErrorMessage, -1, 0,
+                                   /*RequiresNullTerminator=*/false);
     Module *Result = 0;
-    if (Buffer.get())
-      Result = ParseBitcodeFile(Buffer.get(), Context, &ErrorMessage);
+    if (Buffer) {
+      Result = getLazyBitcodeModule(Buffer, Context, &ErrorMessage);
+      if (!Result) delete Buffer;
+    }
 
     if (Result) {
       DumpSymbolNamesFromModule(Result);
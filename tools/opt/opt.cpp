@@ -118,6 +118,11 @@ static cl::opt<bool>
 DisableSimplifyLibCalls("disable-simplify-libcalls",
                         cl::desc("Disable simplify-libcalls"));
 
+static cl::opt<bool>
+Vectorize("vectorize",
+          cl::desc("Run the SLP vectorizer after loop unrolling in the "
+                   "standard pipelines"));
+
 static cl::opt<bool>
 Quiet("q", cl::desc("Obsolete option"), cl::Hidden);
 
@@ -333,7 +338,8 @@ void AddOptimizationPasses(PassManagerBase &MPM, PassManagerBase &FPM,
                              /*UnrollLoops=*/ OptLevel > 1,
                              !DisableSimplifyLibCalls,
                              /*HaveExceptions=*/ true,
-                             InliningPass);
+                             InliningPass,
+                             Vectorize);
 }
 
 void AddStandardCompilePasses(PassManagerBase &PM) {
@@ -356,7 +362,8 @@ void AddStandardCompilePasses(PassManagerBase &PM) {
                              /*UnrollLoops=*/ true,
                              /*SimplifyLibCalls=*/ true,
                              /*HaveExceptions=*/ true,
-                             InliningPass);
+                             InliningPass,
+                             Vectorize);
 }
 
 void AddStandardLinkPasses(PassManagerBase &PM) {
@@ -0,0 +1,214 @@
+//===- LiveIntervalUnionTest.cpp - LiveIntervalUnion unit tests -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../../lib/CodeGen/LiveIntervalUnion.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Function.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Module.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/CodeGen/LiveInterval.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/CodeGen/SlotIndexes.h"
+#include "llvm/System/Host.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetRegistry.h"
+#include "llvm/Target/TargetSelect.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+const unsigned NumBlocks = 64;
+
+/// LiveIntervalUnionTest - Number a machine function of empty blocks, so that
+/// the tests have real SlotIndexes to build live ranges from.  Idx(i) is the
+/// start of block i, and Idx(NumBlocks) the end of the last block.
+class LiveIntervalUnionTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    InitializeNativeTarget();
+    std::string Error;
+    const Target *T = TargetRegistry::lookupTarget(sys::getHostTriple(),
+                                                   Error);
+    if (!T)
+      return;
+    TM.reset(T->createTargetMachine(sys::getHostTriple(), ""));
+    if (!TM)
+      return;
+
+    M.reset(new Module("<main>", Context));
+    const FunctionType *FTy =
+      FunctionType::get(Type::getVoidTy(Context), false);
+    Function *F = Function::Create(FTy, Function::ExternalLinkage, "f",
+                                   M.get());
+    MMI.reset(new MachineModuleInfo(*TM->getMCAsmInfo()));
+    MF.reset(new MachineFunction(F, *TM, 0, *MMI));
+    for (unsigned i = 0; i != NumBlocks; ++i)
+      MF->push_back(MF->CreateMachineBasicBlock());
+
+    Indexes.reset(new SlotIndexes());
+    Indexes->runOnMachineFunction(*MF);
+  }
+
+  virtual void TearDown() {
+    if (Indexes)
+      Indexes->releaseMemory();
+    Indexes.reset();
+    MF.reset();
+    MMI.reset();
+    M.reset();
+    TM.reset();
+  }
+
+  SlotIndex Idx(unsigned i) const {
+    if (i == NumBlocks)
+      return Indexes->getMBBEndIdx(&MF->back());
+    MachineFunction::const_iterator I = MF->begin();
+    std::advance(I, i);
+    return Indexes->getMBBStartIdx(&*I);
+  }
+
+  /// addRange - Add [Idx(Start), Idx(End)) to LI.
+  void addRange(LiveInterval &LI, unsigned Start, unsigned End) {
+    VNInfo *VNI = LI.getNextValue(Idx(Start), 0, VNIAllocator);
+    LI.addRange(LiveRange(Idx(Start), Idx(End), VNI));
+  }
+
+  LLVMContext Context;
+  OwningPtr<TargetMachine> TM;
+  OwningPtr<Module> M;
+  OwningPtr<MachineModuleInfo> MMI;
+  OwningPtr<MachineFunction> MF;
+  OwningPtr<SlotIndexes> Indexes;
+  VNInfo::Allocator VNIAllocator;
+};
+
+TEST_F(LiveIntervalUnionTest, Empty) {
+  if (!TM) return;
+  LiveIntervalUnion U;
+  LiveInterval LI(1, 0);
+  addRange(LI, 0, NumBlocks);
+  EXPECT_TRUE(U.empty());
+  EXPECT_FALSE(U.overlaps(LI));
+  EXPECT_FALSE(U.overlaps(Idx(0), Idx(NumBlocks)));
+
+  // Adding an empty interval leaves the union empty.
+  U.unify(LiveInterval(2, 0));
+  EXPECT_TRUE(U.empty());
+}
+
+TEST_F(LiveIntervalUnionTest, UnifyCoalesces) {
+  if (!TM) return;
+  LiveInterval A(1, 0), B(2, 0);
+  addRange(A, 0, 2);
+  addRange(A, 6, 8);
+  addRange(A, 20, 22);
+  addRange(B, 1, 4);   // Overlaps [0,2).
+  addRange(B, 4, 5);   // Adjacent to [1,4) but a different value.
+  addRange(B, 8, 10);  // Adjacent to [6,8).
+  addRange(B, 12, 14); // Disjoint from everything.
+
+  LiveIntervalUnion U;
+  U.unify(A);
+  EXPECT_EQ(3u, U.size());
+  U.unify(B);
+  ASSERT_EQ(4u, U.size());
+
+  LiveIntervalUnion::const_iterator I = U.begin();
+  EXPECT_TRUE(I->start == Idx(0) && I->end == Idx(5));
+  ++I;
+  EXPECT_TRUE(I->start == Idx(6) && I->end == Idx(10));
+  ++I;
+  EXPECT_TRUE(I->start == Idx(12) && I->end == Idx(14));
+  ++I;
+  EXPECT_TRUE(I->start == Idx(20) && I->end == Idx(22));
+
+  // Adding the same ranges again changes nothing.
+  U.unify(A);
+  EXPECT_EQ(4u, U.size());
+
+  U.clear();
+  EXPECT_TRUE(U.empty());
+}
+
+TEST_F(LiveIntervalUnionTest, Overlaps) {
+  if (!TM) return;
+  LiveInterval A(1, 0);
+  addRange(A, 4, 8);
+  addRange(A, 16, 20);
+  LiveIntervalUnion U;
+  U.unify(A);
+
+  // Ranges are half-open, so touching either end is not an overlap.
+  LiveInterval Touching(2, 0);
+  addRange(Touching, 0, 4);
+  addRange(Touching, 8, 16);
+  addRange(Touching, 20, 24);
+  EXPECT_FALSE(U.overlaps(Touching));
+  EXPECT_FALSE(U.overlaps(Idx(8), Idx(16)));
+
+  // One slot into a segment is.
+  EXPECT_TRUE(U.overlaps(Idx(0), Idx(4).getUseIndex()));
+  EXPECT_TRUE(U.overlaps(Idx(7).getStoreIndex(), Idx(12)));
+  EXPECT_TRUE(U.overlaps(Idx(0), Idx(NumBlocks)));
+
+  // An interval whose only overlap is its last range.
+  LiveInterval Late(3, 0);
+  addRange(Late, 0, 2);
+  addRange(Late, 9, 10);
+  addRange(Late, 19, 30);
+  EXPECT_TRUE(U.overlaps(Late));
+
+  // An interval whose range surrounds a whole segment.
+  LiveInterval Around(4, 0);
+  addRange(Around, 10, 24);
+  EXPECT_TRUE(U.overlaps(Around));
+}
+
+// Check the galloping search against a brute-force answer on a union with
+// many segments, for queries both near and far from the start.
+TEST_F(LiveIntervalUnionTest, ManySegments) {
+  if (!TM) return;
+  // Every third block: [0,1), [3,4), [6,7), ...
+  LiveInterval Fixed(1, 0);
+  for (unsigned i = 0; i + 1 <= NumBlocks; i += 3)
+    addRange(Fixed, i, i + 1);
+  LiveIntervalUnion U;
+  U.unify(Fixed);
+  EXPECT_EQ((NumBlocks + 2) / 3, U.size());
+
+  for (unsigned Start = 0; Start != NumBlocks; ++Start)
+    for (unsigned End = Start + 1; End <= NumBlocks; ++End) {
+      bool Expected = false;
+      for (unsigned i = Start; i != End; ++i)
+        Expected |= i % 3 == 0;
+      EXPECT_EQ(Expected, U.overlaps(Idx(Start), Idx(End)))
+        << "[" << Start << "," << End << ")";
+    }
+
+  // An interval living in the gaps only: [1,3), [4,6), ... never overlaps,
+  // however far it is from the start of the union.
+  LiveInterval Gaps(2, 0);
+  for (unsigned i = 1; i + 2 <= NumBlocks; i += 3)
+    addRange(Gaps, i, i + 2);
+  EXPECT_FALSE(U.overlaps(Gaps));
+
+  // Extending its last range over the next segment makes it overlap.
+  LiveInterval LastOverlaps(3, 0);
+  for (unsigned i = 1; i + 5 <= NumBlocks; i += 3)
+    addRange(LastOverlaps, i, i + 2);
+  addRange(LastOverlaps, NumBlocks - 3, NumBlocks);
+  EXPECT_TRUE(U.overlaps(LastOverlaps));
+}
+
+}
@@ -0,0 +1,192 @@
+//===- JITCodeCacheTest.cpp - Unit tests for the JIT's on-disk code cache -===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/Assembly/Parser.h"
+#include "llvm/ExecutionEngine/JIT.h"
+#include "llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/System/Path.h"
+#include "llvm/Target/TargetSelect.h"
+#include <set>
+
+using namespace llvm;
+
+namespace {
+
+/// CountingJITEventListener - Count the functions that went through codegen
+/// and the ones that were loaded from the code cache, which have no
+/// MachineFunction.
+struct CountingJITEventListener : public JITEventListener {
+  unsigned NumCompiled, NumLoaded;
+
+  CountingJITEventListener() : NumCompiled(0), NumLoaded(0) {}
+
+  virtual void NotifyFunctionEmitted(const Function &F,
+                                     void *Code, size_t Size,
+                                     const EmittedFunctionDetails &Details) {
+    if (Details.MF)
+      ++NumCompiled;
+    else
+      ++NumLoaded;
+  }
+};
+
+// @get_sum reads a global and calls another function, so reloading it has to
+// relocate both references to their addresses in the new JIT.
+const char *const SumAssembly =
+  "@addend = global i32 7 "
+  "define i32 @add(i32 %a, i32 %b) { "
+  "  %r = add i32 %a, %b "
+  "  ret i32 %r "
+  "} "
+  "define i32 @get_sum(i32 %x) { "
+  "  %g = load i32* @addend "
+  "  %r = call i32 @add(i32 %x, i32 %g) "
+  "  ret i32 %r "
+  "} ";
+
+class JITCodeCacheTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    InitializeNativeTarget();
+    std::string Error;
+    CacheDir = sys::Path::GetTemporaryDirectory(&Error);
+    ASSERT_TRUE(Error.empty()) << Error;
+  }
+
+  virtual void TearDown() {
+    CacheDir.eraseFromDisk(/*destroy_contents=*/true);
+  }
+
+  /// runGetSum - Create a JIT for Assembly with the code cache in CacheDir,
+  /// and return @get_sum(Arg).  Listener sees every function the JIT emits.
+  int32_t runGetSum(const char *Assembly, int32_t Arg,
+                    CountingJITEventListener &Listener) {
+    LLVMContext Context;
+    Module *M = new Module("<main>", Context);
+    SMDiagnostic Error;
+    if (!ParseAssemblyString(Assembly, M, Error, Context)) {
+      std::string ErrMsg;
+      raw_string_ostream OS(ErrMsg);
+      Error.Print("", OS);
+      ADD_FAILURE() << OS.str();
+      delete M;
+      return 0;
+    }
+    std::string ErrMsg;
+    OwningPtr<ExecutionEngine> EE(EngineBuilder(M)
+                                  .setEngineKind(EngineKind::JIT)
+                                  .setErrorStr(&ErrMsg)
+                                  .create());
+    if (!EE) {
+      ADD_FAILURE() << ErrMsg;
+      return 0;
+    }
+    EXPECT_TRUE(EE->setCodeCacheDirectory(CacheDir.str()));
+    EE->RegisterJITEventListener(&Listener);
+    typedef int32_t (*SumFn)(int32_t);
+    SumFn GetSum = reinterpret_cast<SumFn>(
+      (intptr_t)EE->getPointerToFunction(M->getFunction("get_sum")));
+    int32_t Result = GetSum(Arg);
+    EE->UnregisterJITEventListener(&Listener);
+    return Result;
+  }
+
+  /// getCacheFiles - Return the files currently in the code cache.
+  std::set<sys::Path> getCacheFiles() {
+    std::set<sys::Path> Files;
+    CacheDir.getDirectoryContents(Files, 0);
+    return Files;
+  }
+
+  sys::Path CacheDir;
+};
+
+TEST_F(JITCodeCacheTest, MissThenHit) {
+  CountingJITEventListener First;
+  EXPECT_EQ(10, runGetSum(SumAssembly, 3, First));
+  EXPECT_EQ(2u, First.NumCompiled);
+  EXPECT_EQ(0u, First.NumLoaded);
+  EXPECT_EQ(2u, getCacheFiles().size());
+
+  // A new JIT in a new context loads both functions instead of compiling
+  // them, and the code still works.
+  CountingJITEventListener Second;
+  EXPECT_EQ(12, runGetSum(SumAssembly, 5, Second));
+  EXPECT_EQ(0u, Second.NumCompiled);
+  EXPECT_EQ(2u, Second.NumLoaded);
+}
+
+TEST_F(JITCodeCacheTest, ChangedIRIsRecompiled) {
+  CountingJITEventListener First;
+  EXPECT_EQ(10, runGetSum(SumAssembly, 3, First));
+  EXPECT_EQ(2u, First.NumCompiled);
+
+  // Changing the body of @add changes its key, so it is compiled again.
+  // @get_sum only depends on @add's signature and is still reused.
+  std::string Changed(SumAssembly);
+  Changed.replace(Changed.find("add i32 %a, %b"), 3, "sub");
+  CountingJITEventListener Second;
+  EXPECT_EQ(-4, runGetSum(Changed.c_str(), 3, Second));
+  EXPECT_EQ(1u, Second.NumCompiled);
+  EXPECT_EQ(1u, Second.NumLoaded);
+
+  // Changing the initializer of @addend changes the key of @get_sum.
+  std::string NewAddend(SumAssembly);
+  NewAddend.replace(NewAddend.find("global i32 7"), 12, "global i32 9");
+  CountingJITEventListener Third;
+  EXPECT_EQ(12, runGetSum(NewAddend.c_str(), 3, Third));
+  EXPECT_EQ(1u, Third.NumCompiled);
+  EXPECT_EQ(1u, Third.NumLoaded);
+}
+
+TEST_F(JITCodeCacheTest, CorruptFilesAreMisses) {
+  CountingJITEventListener First;
+  EXPECT_EQ(10, runGetSum(SumAssembly, 3, First));
+  std::set<sys::Path> Files = getCacheFiles();
+  ASSERT_EQ(2u, Files.size());
+
+  // Truncate one entry and overwrite the other with garbage of the same size.
+  std::set<sys::Path>::iterator I = Files.begin();
+  const sys::Path &Truncated = *I++;
+  const sys::Path &Garbage = *I;
+  for (unsigned i = 0; i != 2; ++i) {
+    const sys::Path &P = i == 0 ? Truncated : Garbage;
+    OwningPtr<MemoryBuffer> Buffer(MemoryBuffer::getFile(P.str()));
+    ASSERT_TRUE(Buffer);
+    std::string Contents = Buffer->getBuffer();
+    if (i == 0)
+      Contents.resize(Contents.size() / 2);
+    else
+      Contents.assign(Contents.size(), '\x5a');
+    std::string ErrMsg;
+    raw_fd_ostream OS(P.c_str(), ErrMsg, raw_fd_ostream::F_Binary);
+    ASSERT_TRUE(ErrMsg.empty()) << ErrMsg;
+    OS << Contents;
+  }
+
+  // Both functions are compiled again, and their entries are rewritten.
+  CountingJITEventListener Second;
+  EXPECT_EQ(10, runGetSum(SumAssembly, 3, Second));
+  EXPECT_EQ(2u, Second.NumCompiled);
+  EXPECT_EQ(0u, Second.NumLoaded);
+
+  CountingJITEventListener Third;
+  EXPECT_EQ(10, runGetSum(SumAssembly, 3, Third));
+  EXPECT_EQ(0u, Third.NumCompiled);
+  EXPECT_EQ(2u, Third.NumLoaded);
+}
+
+}
@@ -276,4 +276,48 @@ TEST(JITMemoryManagerTest, TestManyStubs) {
   EXPECT_EQ(3U, MemMgr->GetNumStubSlabs());
 }
 
+// Allocate functions alternately in and out of the hot code region, and check
+// that the hot ones are packed together.
+TEST(JITMemoryManagerTest, TestHotCodeAllocation) {
+  OwningPtr<JITMemoryManager> MemMgr(
+      JITMemoryManager::CreateDefaultMemManager());
+  uintptr_t size;
+  std::string Error;
+
+  OwningPtr<Function> F1(makeFakeFunction());
+  MemMgr->setAllocateHotCode(true);
+  size = 0;
+  uint8_t *HotBody1 = MemMgr->startFunctionBody(F1.get(), size);
+  EXPECT_LE(1024U, size);
+  memset(HotBody1, 0xFF, 1024);
+  MemMgr->endFunctionBody(F1.get(), HotBody1, HotBody1 + 1024);
+  MemMgr->setAllocateHotCode(false);
+
+  OwningPtr<Function> F2(makeFakeFunction());
+  size = 1024;
+  uint8_t *ColdBody = MemMgr->startFunctionBody(F2.get(), size);
+  memset(ColdBody, 0xFF, 1024);
+  MemMgr->endFunctionBody(F2.get(), ColdBody, ColdBody + 1024);
+  EXPECT_TRUE(MemMgr->CheckInvariants(Error)) << Error;
+
+  OwningPtr<Function> F3(makeFakeFunction());
+  MemMgr->setAllocateHotCode(true);
+  size = 0;
+  uint8_t *HotBody2 = MemMgr->startFunctionBody(F3.get(), size);
+  EXPECT_EQ(HotBody1 + 1024, HotBody2);
+
+  // Giving back the last hot block lets the next one start in its place.
+  MemMgr->endFunctionBody(F3.get(), HotBody2, HotBody2 + size);
+  MemMgr->deallocateFunctionBody(HotBody2);
+  size = 0;
+  uint8_t *HotBody3 = MemMgr->startFunctionBody(F3.get(), size);
+  EXPECT_EQ(HotBody2, HotBody3);
+  memset(HotBody3, 0xFF, 512);
+  MemMgr->endFunctionBody(F3.get(), HotBody3, HotBody3 + 512);
+  MemMgr->setAllocateHotCode(false);
+
+  MemMgr->deallocateFunctionBody(ColdBody);
+  EXPECT_TRUE(MemMgr->CheckInvariants(Error)) << Error;
+}
+
 }
@@ -572,6 +572,62 @@ TEST_F(JITTest, FunctionIsRecompiledAndRelinked) {
   EXPECT_EQ(2, OrigFPtr())
     << "The old pointer's target should now jump to the new version";
 }
+
+/// countCallCounterInstructions - Count the instructions in F that the JIT
+/// added to count calls.
+unsigned countCallCounterInstructions(Function *F) {
+  unsigned Kind = F->getContext().getMDKindID("jit.callcount");
+  unsigned Count = 0;
+  for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+    for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE; ++I)
+      if (I->getMetadata(Kind))
+        ++Count;
+  return Count;
+}
+
+TEST_F(JITTest, HotFunctionIsRelaidOut) {
+  Function *Hot = Function::Create(TypeBuilder<int(int), false>::get(Context),
+                                   GlobalValue::ExternalLinkage, "hot", M);
+  IRBuilder<> Builder(BasicBlock::Create(Context, "entry", Hot));
+  Value *One = ConstantInt::get(TypeBuilder<int, false>::get(Context), 1);
+  Builder.CreateRet(Builder.CreateAdd(Hot->arg_begin(), One));
+
+  Function *Cold = Function::Create(TypeBuilder<int(int), false>::get(Context),
+                                    GlobalValue::ExternalLinkage, "cold", M);
+  Builder.SetInsertPoint(BasicBlock::Create(Context, "entry", Cold));
+  Builder.CreateRet(Builder.CreateSub(Cold->arg_begin(), One));
+
+  TheJIT->DisableLazyCompilation(true);
+  TheJIT->EnableCallProfiling();
+  int (*OrigHotPtr)(int) = reinterpret_cast<int(*)(int)>(
+    (intptr_t)TheJIT->getPointerToFunction(Hot));
+  int (*ColdPtr)(int) = reinterpret_cast<int(*)(int)>(
+    (intptr_t)TheJIT->getPointerToFunction(Cold));
+  int Result = 0;
+  for (int i = 0; i != 10; ++i)
+    Result = OrigHotPtr(Result);
+  EXPECT_EQ(10, Result);
+  EXPECT_EQ(9, ColdPtr(10));
+  EXPECT_EQ(3U, countCallCounterInstructions(Hot));
+
+  EXPECT_EQ(1U, TheJIT->relayoutHotFunctions(1));
+  EXPECT_EQ(0U, countCallCounterInstructions(Hot))
+    << "Moving the function should take its counter out of the IR";
+  EXPECT_EQ(2U, Hot->getEntryBlock().size());
+  EXPECT_EQ(3U, countCallCounterInstructions(Cold));
+  int (*NewHotPtr)(int) = reinterpret_cast<int(*)(int)>(
+    (intptr_t)TheJIT->getPointerToFunction(Hot));
+  EXPECT_NE((intptr_t)OrigHotPtr, (intptr_t)NewHotPtr);
+  EXPECT_EQ((intptr_t)ColdPtr, (intptr_t)TheJIT->getPointerToFunction(Cold));
+  EXPECT_EQ(2, NewHotPtr(1));
+  EXPECT_EQ(2, OrigHotPtr(1))
+    << "The old pointer's target should now jump to the new version";
+
+  // The moved function is no longer counted, so only the cold one moves now.
+  EXPECT_EQ(1U, TheJIT->relayoutHotFunctions(2));
+  EXPECT_EQ((intptr_t)NewHotPtr, (intptr_t)TheJIT->getPointerToFunction(Hot));
+  EXPECT_EQ(9, ColdPtr(10));
+}
 #endif  // !defined(__arm__)
 
 }  // anonymous namespace
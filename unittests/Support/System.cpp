@@ -1,5 +1,6 @@
 //===- llvm/unittest/Support/System.cpp - System tests --===//
 #include "gtest/gtest.h"
+#include "llvm/System/Memory.h"
 #include "llvm/System/TimeValue.h"
 #include <time.h>
 
@@ -13,4 +14,21 @@ TEST_F(SystemTest, TimeValue) {
   time_t now_t = time(NULL);
   EXPECT_TRUE(abs(static_cast<long>(now_t - now.toEpochTime())) < 2);
 }
+
+TEST_F(SystemTest, AllocateHugeRWX) {
+  sys::MemoryBlock B = sys::Memory::AllocateHugeRWX(4096);
+  ASSERT_TRUE(B.base() != 0);
+  EXPECT_LE(4096U, B.size());
+
+  // The block must be aligned to and a multiple of the huge page size.
+  if (size_t HugePageSize = sys::Memory::getHugePageSize()) {
+    EXPECT_EQ(0U, (uintptr_t)B.base() % HugePageSize);
+    EXPECT_EQ(0U, B.size() % HugePageSize);
+  }
+
+  // The whole block must be usable.
+  static_cast<char*>(B.base())[0] = 1;
+  static_cast<char*>(B.base())[B.size() - 1] = 1;
+  EXPECT_FALSE(sys::Memory::ReleaseRWX(B));
+}
 }
@@ -0,0 +1,82 @@
+#!/usr/bin/env python
+
+"""
+Measure how the time llc takes to compile a single basic block grows with the
+size of the block.
+
+For each size, this writes a function whose entry block holds that many
+instructions of loads, arithmetic and stores, compiles it with llc, and
+prints the wall time.  Compile time that grows linearly with the block size
+gives a constant time per instruction in the last column.
+
+Usage: huge-block-bench.py [--llc PATH] [--sizes 1000,10000,...] [-- ARGS]
+
+Any arguments after -- are passed to llc, e.g. -- -time-passes.
+"""
+
+import optparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+def write_function(f, size):
+    """Write a module with one function whose entry block has about size
+    instructions.  Values are reused from a sliding window so that the DAG is
+    wide, and stores are interleaved so that the chain is long."""
+    f.write('define void @huge(i32* %p, i32 %x) nounwind {\n')
+    f.write('entry:\n')
+    values = ['%x']
+    count = 0
+    i = 0
+    while count < size:
+        a = values[-1]
+        b = values[-1 - (i * 7) % len(values)]
+        f.write('  %%g%d = getelementptr i32* %%p, i32 %d\n' % (i, i % 4096))
+        f.write('  %%l%d = load i32* %%g%d\n' % (i, i))
+        f.write('  %%a%d = add i32 %s, %%l%d\n' % (i, a, i))
+        f.write('  %%m%d = mul i32 %%a%d, %s\n' % (i, i, b))
+        f.write('  %%x%d = xor i32 %%m%d, %d\n' % (i, i, i * 2654435761 % 65536))
+        f.write('  store i32 %%x%d, i32* %%g%d\n' % (i, i))
+        values.append('%%x%d' % i)
+        if len(values) > 64:
+            values.pop(0)
+        count += 6
+        i += 1
+    f.write('  ret void\n')
+    f.write('}\n')
+
+def main():
+    parser = optparse.OptionParser(usage=__doc__.strip())
+    parser.add_option('--llc', dest='llc', default='llc',
+                      help='llc binary to run [%default]')
+    parser.add_option('--sizes', dest='sizes',
+                      default='1000,3000,10000,30000,100000',
+                      help='comma-separated block sizes [%default]')
+    opts, args = parser.parse_args()
+
+    print('%10s %12s %16s' % ('insts', 'seconds', 'usec/inst'))
+    for size in [int(s) for s in opts.sizes.split(',')]:
+        fd, path = tempfile.mkstemp(suffix='.ll')
+        try:
+            f = os.fdopen(fd, 'w')
+            write_function(f, size)
+            f.close()
+
+            start = time.time()
+            status = subprocess.call([opts.llc, path, '-o', os.devnull] + args)
+            elapsed = time.time() - start
+        finally:
+            os.remove(path)
+
+        if status != 0:
+            sys.stderr.write('error: llc failed on a block of %d '
+                             'instructions\n' % size)
+            return 1
+        print('%10d %12.3f %16.2f' % (size, elapsed, elapsed * 1e6 / size))
+        sys.stdout.flush()
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
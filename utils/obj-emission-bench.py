@@ -0,0 +1,97 @@
+#!/usr/bin/env python
+
+"""
+Compare writing object files directly from llc with going through textual
+assembly and an external assembler.
+
+For each input, this runs
+
+  direct:     llc -filetype=obj input -o input.o
+  roundtrip:  llc -filetype=asm input -o input.s && as input.s -o input.o
+
+and prints the wall time and the peak resident memory of each path, summed
+over the inputs.  The peak memory of the round trip is the larger of llc's
+and the assembler's.
+
+Usage: obj-emission-bench.py [options] input.ll|input.bc... [-- LLC-ARGS]
+
+Any arguments after -- are passed to both llc runs, e.g. -- -O2.
+"""
+
+import optparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+def run(args):
+    """Run a command and return (status, seconds, peak RSS in KB)."""
+    start = time.time()
+    proc = subprocess.Popen(args)
+    _, status, usage = os.wait4(proc.pid, 0)
+    elapsed = time.time() - start
+    # Tell the Popen object it has been reaped.
+    proc.returncode = status
+    return status, elapsed, usage.ru_maxrss
+
+def main():
+    parser = optparse.OptionParser(usage=__doc__.strip())
+    parser.add_option('--llc', dest='llc', default='llc',
+                      help='llc binary to run [%default]')
+    parser.add_option('--as', dest='assembler', default='as',
+                      help='assembler to run on the .s files [%default]')
+    parser.add_option('--repeat', dest='repeat', type='int', default=1,
+                      help='times to compile each input [%default]')
+    argv = sys.argv[1:]
+    llc_args = []
+    if '--' in argv:
+        llc_args = argv[argv.index('--') + 1:]
+        argv = argv[:argv.index('--')]
+    opts, args = parser.parse_args(argv)
+    if not args:
+        parser.error('no inputs')
+
+    tmpdir = tempfile.mkdtemp()
+    totals = {'direct': [0.0, 0], 'roundtrip': [0.0, 0]}
+    try:
+        for input in args:
+            base = os.path.join(tmpdir, os.path.basename(input))
+            for _ in range(opts.repeat):
+                status, secs, rss = run([opts.llc, '-filetype=obj', input,
+                                         '-o', base + '.o'] + llc_args)
+                if status != 0:
+                    sys.stderr.write('error: llc -filetype=obj failed on '
+                                     '%s\n' % input)
+                    return 1
+                totals['direct'][0] += secs
+                totals['direct'][1] = max(totals['direct'][1], rss)
+
+                status, secs, rss = run([opts.llc, '-filetype=asm', input,
+                                         '-o', base + '.s'] + llc_args)
+                if status == 0:
+                    status, as_secs, as_rss = run([opts.assembler, base + '.s',
+                                                   '-o', base + '.as.o'])
+                    secs += as_secs
+                    rss = max(rss, as_rss)
+                if status != 0:
+                    sys.stderr.write('error: assembly round trip failed on '
+                                     '%s\n' % input)
+                    return 1
+                totals['roundtrip'][0] += secs
+                totals['roundtrip'][1] = max(totals['roundtrip'][1], rss)
+    finally:
+        shutil.rmtree(tmpdir)
+
+    print('%-10s %10s %14s' % ('path', 'seconds', 'peak RSS (KB)'))
+    for path in ('direct', 'roundtrip'):
+        print('%-10s %10.3f %14d' % (path, totals[path][0], totals[path][1]))
+    if totals['roundtrip'][0]:
+        saved = 1 - totals['direct'][0] / totals['roundtrip'][0]
+        print('direct emission saves %.1f%% of the round trip time' %
+              (saved * 100))
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())